@@ -0,0 +1,32 @@
+/*
+ * (C) Copyright 2025 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __ASM_ARM_CRC32_H
+#define __ASM_ARM_CRC32_H
+
+#include <linux/types.h>
+
+#define ID_AA64ISAR0_CRC32_SHIFT	16
+
+/*
+ * The CRC32 instructions are optional before ARMv8.1. The ID register is
+ * cheap to read, so it is checked on every call instead of being cached,
+ * which also works before relocation.
+ */
+static inline bool arm64_has_crc32(void)
+{
+	u64 isar0;
+
+	asm volatile("mrs %0, id_aa64isar0_el1" : "=r" (isar0));
+
+	return (isar0 >> ID_AA64ISAR0_CRC32_SHIFT) & 0xf;
+}
+
+/* No ones complement, like crc32_no_comp() */
+u32 crc32_le_arm64(u32 crc, const u8 *p, size_t len);
+u32 crc32c_le_arm64(u32 crc, const u8 *p, size_t len);
+
+#endif /* __ASM_ARM_CRC32_H */
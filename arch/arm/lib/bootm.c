@@ -87,9 +87,14 @@ static void announce_and_cleanup(bootm_headers_t *images, int fake)
 #ifdef CONFIG_BOOTSTAGE_FDT
 	bootstage_fdt_add_report();
 #endif
+#ifdef CONFIG_BOOTSTAGE_CHOSEN
+	if (images->ft_len)
+		bootstage_fdt_add_chosen(images->ft_addr);
+#endif
 #ifdef CONFIG_BOOTSTAGE_REPORT
 	bootstage_report();
 #endif
+	dm_report_deferred();
 
 #ifdef CONFIG_USB_DEVICE
 	udc_disconnect();
@@ -12,6 +12,7 @@
 #include <android_bootloader.h>
 #include <android_image.h>
 #include <bidram.h>
+#include <bootm.h>
 #include <boot_rkimg.h>
 #include <cli.h>
 #include <clk.h>
@@ -35,6 +36,7 @@
 #include <video_rockchip.h>
 #include <xbc.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 #include <asm/gpio.h>
 #include <android_avb/rk_avb_ops_user.h>
 #include <dm/uclass-internal.h>
@@ -503,8 +505,11 @@ int board_late_init(void)
 
 #ifdef CONFIG_DRM_ROCKCHIP
 	if ((rockchip_get_boot_mode() != BOOT_MODE_QUIESCENT) &&
-	     !smp_event1(SEVT_3, STID_16))
+	     !smp_event1(SEVT_3, STID_16)) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_LCD, "display");
 		rockchip_show_logo();
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_LCD);
+	}
 #endif
 
 #ifdef CONFIG_ROCKCHIP_EINK_DISPLAY
@@ -722,6 +727,46 @@ int board_initr_caches_fixup(void)
 }
 #endif
 
+#ifdef CONFIG_ARM64
+/* Where an arm64 kernel loaded at @ep runs, see arch_preboot_os() */
+static ulong rk_kernel_ep(ulong ep, const u8 *data)
+{
+	if (data[10] == 0x00)
+		return round_down(ep, SZ_2M);
+	if (IS_ALIGNED(ep, SZ_2M))
+		return ep + 0x80000;
+
+	return ep;
+}
+
+/*
+ * Decompress the kernel straight to where arch_preboot_os() would move
+ * it, unless it would land on top of the image it is decompressed from.
+ */
+void arch_preload_os(bootm_headers_t *images, const void *head, ulong size)
+{
+	image_info_t *os = &images->os;
+	ulong ep, image_size;
+
+	if (size < 64 || get_unaligned_le32(head + 56) != 0x644d5241)
+		return;
+	if (images->ep != os->load)
+		return;
+
+	ep = rk_kernel_ep(os->load, head);
+	image_size = get_unaligned_le64(head + 16);
+	if (!image_size)
+		return;
+	if (ep != os->load && ep < os->end && os->start < ep + image_size)
+		return;
+
+	debug("Kernel load address 0x%08lx -> 0x%08lx\n", os->load, ep);
+	os->load = ep;
+	images->ep = ep;
+	images->preload_ep = ep;
+}
+#endif
+
 void arch_preboot_os(uint32_t bootm_state, bootm_headers_t *images)
 {
 	if (!(bootm_state & BOOTM_STATE_OS_PREP))
@@ -746,17 +791,15 @@ void arch_preboot_os(uint32_t bootm_state, bootm_headers_t *images)
 	 *
 	 * But relocation is in board_quiesce_devices() until all decompress
 	 * done, mainly for saving boot time.
+	 *
+	 * Kernels that arch_preload_os() already put in place are not moved,
+	 * data[] may not be decompressed yet at this point.
 	 */
 
 	orig_images_ep = images->ep;
 
-	if (data[10] == 0x00) {
-		if (round_down(images->ep, SZ_2M) != images->ep)
-			images->ep = round_down(images->ep, SZ_2M);
-	} else {
-		if (IS_ALIGNED(images->ep, SZ_2M))
-			images->ep += 0x80000;
-	}
+	if (images->preload_ep != images->ep)
+		images->ep = rk_kernel_ep(images->ep, data);
 #endif
 	hotkey_run(HK_CLI_OS_PRE);
 }
@@ -249,11 +249,13 @@ struct blk_desc *rockchip_get_bootdev(void)
 	if (dev_desc)
 		return dev_desc;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_STORAGE, "storage");
 	boot_devtype_init();
 	dev_type = get_bootdev_type();
 	devnum = env_get_ulong("devnum", 10, 0);
 
 	dev_desc = blk_get_devnum_by_type(dev_type, devnum);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_STORAGE);
 	if (!dev_desc) {
 		printf("%s: Can't find dev_desc!\n", __func__);
 		return NULL;
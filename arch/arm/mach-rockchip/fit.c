@@ -5,11 +5,13 @@
  */
 #include <common.h>
 #include <boot_rkimg.h>
+#include <crypto.h>
 #include <image.h>
 #include <malloc.h>
 #include <sysmem.h>
 #include <asm/arch/fit.h>
 #include <asm/arch/resource_img.h>
+#include <u-boot/sha256.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -20,6 +22,9 @@ DECLARE_GLOBAL_DATA_PTR;
  */
 #define FIT_FDT_MAX_SIZE		SZ_4K
 
+/* Granularity of the read/hash pipeline of fit_image_load_hashed() */
+#define FIT_HASH_CHUNK_SIZE		SZ_1M
+
 static int fit_is_ext_type(const void *fit)
 {
 	return fdt_totalsize(fit) < FIT_FDT_MAX_SIZE;
@@ -158,6 +163,21 @@ static void *fit_get_blob(struct blk_desc *dev_desc,
 
 	*out_part = part;
 	blk_num = DIV_ROUND_UP(sizeof(struct fdt_header), dev_desc->blksz);
+
+	/* A memory-backed device holds the blob already, use it in place */
+	fdt = blk_dmap(dev_desc, part.start, blk_num);
+	if (fdt) {
+		if (fdt_check_header(fdt) || !fit_is_ext_type(fdt))
+			return NULL;
+
+		blk_num = DIV_ROUND_UP(fdt_totalsize(fdt), dev_desc->blksz);
+		fit = blk_dmap(dev_desc, part.start, blk_num);
+		if (!fit)
+			return NULL;
+
+		goto loaded;
+	}
+
 	fdt = memalign(ARCH_DMA_MINALIGN, blk_num * dev_desc->blksz);
 	if (!fdt)
 		return NULL;
@@ -189,14 +209,20 @@ static void *fit_get_blob(struct blk_desc *dev_desc,
 		debug("Failed to read fit blob\n");
 		goto fail;
 	}
+	free(fdt);
 
+loaded:
 #ifdef CONFIG_FIT_SIGNATURE
 	if (!verify)
 		return fit;
 
 	conf_noffset = fit_conf_get_node(fit, NULL); /* NULL for default conf */
-	if (conf_noffset < 0)
-		goto fail;
+	if (conf_noffset < 0) {
+		/* Nothing was allocated for a blob used in place */
+		if (fit != blk_dmap(dev_desc, part.start, 1))
+			free(fit);
+		return NULL;
+	}
 
 	printf("%s: ", fdt_get_name(fit, conf_noffset, NULL));
 	if (fit_config_verify(fit, conf_noffset)) {
@@ -351,6 +377,137 @@ static int fit_image_get_subnode(const void *fit, int noffset, const char *name)
 	return -ENOENT;
 }
 
+#if CONFIG_IS_ENABLED(FIT_HW_CRYPTO)
+static u32 fit_hash_algo_to_cap(const char *algo, int *value_len)
+{
+	if (IMAGE_ENABLE_SHA1 && !strcmp(algo, "sha1")) {
+		*value_len = 20;
+		return CRYPTO_SHA1;
+	} else if (IMAGE_ENABLE_SHA256 && !strcmp(algo, "sha256")) {
+		*value_len = SHA256_SUM_LEN;
+		return CRYPTO_SHA256;
+	} else if (IMAGE_ENABLE_MD5 && !strcmp(algo, "md5")) {
+		*value_len = 16;
+		return CRYPTO_MD5;
+	}
+
+	return 0;
+}
+
+static int fit_read_start(struct blk_desc *dev_desc, struct blk_req *req,
+			  lbaint_t start, lbaint_t blkcnt, void *buf)
+{
+#ifdef CONFIG_BLK_ASYNC
+	return blk_dread_submit(dev_desc, req, start, blkcnt, buf);
+#else
+	return blk_dread(dev_desc, start, blkcnt, buf) == blkcnt ? 0 : -EIO;
+#endif
+}
+
+static int fit_read_end(struct blk_desc *dev_desc, struct blk_req *req,
+			lbaint_t blkcnt)
+{
+#ifdef CONFIG_BLK_ASYNC
+	return blk_req_wait(dev_desc, req) == blkcnt ? 0 : -EIO;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Read an image and feed it to the crypto engine chunk by chunk. The next
+ * chunk is already on its way from storage while the current one is being
+ * hashed, so the check is hidden behind the read and the cpu never walks
+ * the image.
+ *
+ * Return -ENOSYS if the hash node can't be handled here, the caller then
+ * falls back to reading the whole image and fit_image_check_hash().
+ */
+static int fit_image_load_hashed(const void *fit, int hash_noffset,
+				 struct blk_desc *dev_desc, lbaint_t start,
+				 void *data, int size)
+{
+	lbaint_t chunk = FIT_HASH_CHUNK_SIZE / dev_desc->blksz;
+	lbaint_t blkcnt = DIV_ROUND_UP(size, dev_desc->blksz);
+	lbaint_t blk, n, next_n = 0;
+	u8 value[FIT_MAX_HASH_LEN];
+	struct blk_req req;
+	struct udevice *dev;
+	sha_context ctx;
+	u8 *fit_value;
+	int fit_value_len, value_len;
+	char *algo;
+	u32 len;
+	int ret;
+
+	if (fit_image_hash_get_algo(fit, hash_noffset, &algo) ||
+	    fit_image_hash_get_value(fit, hash_noffset, &fit_value,
+				     &fit_value_len))
+		return -ENOSYS;
+
+	/* Leave "hash-ignore" to fit_image_check_hash() */
+	if (IMAGE_ENABLE_IGNORE && fdt_getprop(fit, hash_noffset,
+					       FIT_IGNORE_PROP, NULL))
+		return -ENOSYS;
+
+	ctx.algo = fit_hash_algo_to_cap(algo, &value_len);
+	ctx.length = size;
+	if (!ctx.algo || value_len != fit_value_len)
+		return -ENOSYS;
+
+	dev = crypto_get_device(ctx.algo);
+	if (!dev)
+		return -ENOSYS;
+
+	printf("%s", algo);
+	ret = crypto_sha_init(dev, &ctx);
+	if (ret)
+		return ret;
+
+	n = min(chunk, blkcnt);
+	ret = fit_read_start(dev_desc, &req, start, n, data);
+	for (blk = 0; !ret && blk < blkcnt; blk += n, n = next_n) {
+		ret = fit_read_end(dev_desc, &req, n);
+		if (ret)
+			break;
+
+		if (blk + n < blkcnt) {
+			next_n = min(chunk, blkcnt - blk - n);
+			ret = fit_read_start(dev_desc, &req, start + blk + n,
+					     next_n,
+					     data + (blk + n) * dev_desc->blksz);
+			if (ret)
+				break;
+		}
+
+		len = min_t(u32, size - blk * dev_desc->blksz,
+			    n * dev_desc->blksz);
+		ret = crypto_sha_update(dev,
+					(u32 *)(data + blk * dev_desc->blksz),
+					len);
+	}
+
+	if (ret) {
+#ifdef CONFIG_BLK_ASYNC
+		blk_req_drain(dev_desc);
+#endif
+		printf(" error!\nFailed to read and hash image, ret=%d\n", ret);
+		return ret;
+	}
+
+	ret = crypto_sha_final(dev, &ctx, value);
+	if (ret)
+		return ret;
+
+	if (memcmp(value, fit_value, value_len)) {
+		printf(" error!\nBad hash value\n");
+		return -EBADMSG;
+	}
+
+	return 0;
+}
+#endif
+
 static int fit_image_load_one(const void *fit, struct blk_desc *dev_desc,
 			      disk_partition_t *part, char *prop_name,
 			      void *data, int check_hash)
@@ -358,20 +515,14 @@ static int fit_image_load_one(const void *fit, struct blk_desc *dev_desc,
 	u32 blk_num, blk_off;
 	int offset, size;
 	int noffset, ret;
+	int hash_noffset = -ENOENT;
 	char *msg = "";
 
 	ret = fdt_image_get_offset_size(fit, prop_name, &offset, &size);
 	if (ret)
 		return ret;
 
-	blk_off = (FIT_ALIGN(fdt_totalsize(fit)) + offset) / dev_desc->blksz;
-	blk_num = DIV_ROUND_UP(size, dev_desc->blksz);
-	if (blk_dread(dev_desc, part->start + blk_off, blk_num, data) != blk_num)
-		return -EIO;
-
 	if (check_hash) {
-		int hash_noffset;
-
 		noffset = fit_default_conf_get_node(fit, prop_name);
 		if (noffset < 0)
 			return noffset;
@@ -382,6 +533,27 @@ static int fit_image_load_one(const void *fit, struct blk_desc *dev_desc,
 			return hash_noffset;
 
 		printf("%s: ", fdt_get_name(fit, noffset, NULL));
+	}
+
+	blk_off = (FIT_ALIGN(fdt_totalsize(fit)) + offset) / dev_desc->blksz;
+	blk_num = DIV_ROUND_UP(size, dev_desc->blksz);
+
+#if CONFIG_IS_ENABLED(FIT_HW_CRYPTO)
+	if (check_hash) {
+		ret = fit_image_load_hashed(fit, hash_noffset, dev_desc,
+					    part->start + blk_off, data, size);
+		if (ret != -ENOSYS) {
+			if (!ret)
+				puts("+\n");
+			return ret;
+		}
+	}
+#endif
+
+	if (blk_dread(dev_desc, part->start + blk_off, blk_num, data) != blk_num)
+		return -EIO;
+
+	if (check_hash) {
 		ret = fit_image_check_hash(fit, hash_noffset, data, size, &msg);
 		if (ret)
 			return ret;
@@ -443,14 +615,28 @@ void *fit_image_load_bootables(ulong *size)
 	}
 
 	blk_num = DIV_ROUND_UP(*size, dev_desc->blksz);
+
+	/*
+	 * On a memory-backed device the images are used in place, as for
+	 * a FIT that is already in RAM ('boot_fit <addr>'), unless that
+	 * memory can't be reserved; they are copied out then.
+	 */
+	fit = blk_dmap(dev_desc, part.start, blk_num);
+	if (fit && sysmem_alloc_base(MEM_FIT, (phys_addr_t)fit,
+				     blk_num * dev_desc->blksz))
+		return fit;
+
 	fit = sysmem_alloc(MEM_FIT, blk_num * dev_desc->blksz);
 	if (!fit)
 		return NULL;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_IMAGE_LOAD, "image_load");
 	if (blk_dread(dev_desc, part.start, blk_num, fit) != blk_num) {
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_IMAGE_LOAD);
 		FIT_I("Failed to load bootable images\n");
 		return NULL;
 	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_IMAGE_LOAD);
 
 	return fit;
 }
@@ -463,6 +649,14 @@ static void fit_msg(const void *fit)
 }
 
 #ifdef CONFIG_ROCKCHIP_RESOURCE_IMAGE
+static void fit_put_blob(struct blk_desc *dev_desc, disk_partition_t *part,
+			 void *fit)
+{
+	/* Nothing was allocated for a blob used in place */
+	if (fit != blk_dmap(dev_desc, part->start, 1))
+		free(fit);
+}
+
 ulong fit_image_init_resource(struct blk_desc *dev_desc)
 {
 	disk_partition_t part;
@@ -494,12 +688,12 @@ ulong fit_image_init_resource(struct blk_desc *dev_desc)
 	ret = resource_setup_ram_list(dev_desc, buf);
 	if (ret) {
 		FIT_I("Failed to setup resource ram list, ret=%d\n", ret);
-		free(fit);
+		fit_put_blob(dev_desc, &part, fit);
 		return ret;
 	}
 
 	fit_msg(fit);
-	free(fit);
+	fit_put_blob(dev_desc, &part, fit);
 
 	return 0;
 }
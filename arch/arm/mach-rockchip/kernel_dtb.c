@@ -379,6 +379,11 @@ dtb_okay:
 	gd->flags |= GD_FLG_KDTB_READY;
 	gd->of_root_f = gd->of_root;
 	of_live_build((void *)gd->fdt_blob, (struct device_node **)&gd->of_root);
+	/*
+	 * With V2, kernel nodes that describe a U-Boot device which is used
+	 * first anyway are matched to it instead of being bound again, see
+	 * device_match_kernel_node().
+	 */
 	dm_scan_fdt((void *)gd->fdt_blob, false);
 
 #ifdef CONFIG_USING_KERNEL_DTB_V2
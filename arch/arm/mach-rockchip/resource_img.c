@@ -262,6 +262,27 @@ int resource_setup_ram_list(struct blk_desc *desc, void *hdr)
 }
 
 #ifdef CONFIG_ANDROID_BOOT_IMAGE
+/* Number of blocks from the header to the end of the last file */
+static ulong resource_blk_size(struct blk_desc *desc,
+			       struct resource_img_hdr *hdr)
+{
+	struct resource_entry *et;
+	ulong blks, end = hdr->c_offset + hdr->e_blks * hdr->e_nums;
+	u32 i;
+
+	for (i = 0; i < hdr->e_nums; i++) {
+		et = (void *)hdr + (hdr->c_offset + i * hdr->e_blks) *
+				   desc->blksz;
+		if (memcmp(et->tag, ENTRY_TAG, ENTRY_TAG_SIZE))
+			continue;
+
+		blks = et->blk_offset + DIV_ROUND_UP(et->size, desc->blksz);
+		end = max(end, blks);
+	}
+
+	return end;
+}
+
 static int resource_setup_blk_list(struct blk_desc *desc, ulong blk_start)
 {
 	struct resource_img_hdr *hdr;
@@ -269,6 +290,14 @@ static int resource_setup_blk_list(struct blk_desc *desc, ulong blk_start)
 	int ret = 0;
 	void *buf;
 
+	/* A memory-backed device holds the image already, use it in place */
+	hdr = blk_dmap(desc, blk_start, 1);
+	if (hdr && !resource_check_header(hdr) &&
+	    blk_dmap(desc, blk_start,
+		     hdr->c_offset + hdr->e_blks * hdr->e_nums) &&
+	    blk_dmap(desc, blk_start, resource_blk_size(desc, hdr)))
+		return resource_setup_ram_list(desc, hdr);
+
 	hdr = memalign(ARCH_DMA_MINALIGN, desc->blksz);
 	if (!hdr)
 		return -ENOMEM;
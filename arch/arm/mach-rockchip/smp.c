@@ -0,0 +1,746 @@
+/*
+ * (C) Copyright 2025 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:     GPL-2.0+
+ */
+
+#include <common.h>
+#include <console.h>
+#include <fdtdec.h>
+#include <hash.h>
+#include <image.h>
+#include <malloc.h>
+#include <video_rockchip.h>
+#include <asm/io.h>
+#include <asm/system.h>
+#include <asm/arch/hotkey.h>
+#include <asm/arch/rockchip_smccc.h>
+#include <asm/psci.h>
+#include <power/regulator.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define SMP_CPUS_MAX		8
+#define SMP_QUEUE_SIZE		32
+#define SMP_ONLINE_TIMEOUT_MS	10
+#define SMP_OFFLINE_TIMEOUT_MS	100
+
+enum smp_cpu_state {
+	SMP_CPU_OFF = 0,
+	SMP_CPU_ON_PENDING,
+	SMP_CPU_ONLINE,
+	SMP_CPU_PARKED,
+	SMP_CPU_LOST,		/* powered on but missed the online timeout */
+};
+
+struct smp_cpu {
+	ulong mpidr;
+	void *stack;
+	volatile u32 state;
+	ulong jobs;
+	ulong busy_us;
+};
+
+/* Read by smp_secondary_entry() with MMU off, keep in sync with it */
+struct smp_boot {
+	ulong gd;
+	ulong sp;
+	ulong idx;
+	ulong ttbr;
+	ulong tcr;
+	ulong mair;
+	ulong sctlr;
+	ulong vbar;
+} __aligned(ARCH_DMA_MINALIGN);
+
+struct smp_boot smp_boot;
+
+static struct {
+	uspinlock_t lock;
+	struct smp_job *queue[SMP_QUEUE_SIZE];
+	u32 head;
+	u32 tail;
+	volatile u32 exit;
+	int num_cpus;
+	bool lost;		/* a cpu is lost, smp_boot must stay as it is */
+	struct smp_cpu cpu[SMP_CPUS_MAX];
+} smp;
+
+void smp_secondary_entry(void);
+
+#define read_el_sysreg(el, reg, val)				\
+do {								\
+	if ((el) == 1)						\
+		asm volatile("mrs %0, " #reg "_el1" : "=r" (val));	\
+	else if ((el) == 2)					\
+		asm volatile("mrs %0, " #reg "_el2" : "=r" (val));	\
+	else							\
+		asm volatile("mrs %0, " #reg "_el3" : "=r" (val));	\
+} while (0)
+
+static void smp_boot_setup(int idx, void *stack_top)
+{
+	int el = current_el();
+
+	smp_boot.gd = (ulong)gd;
+	smp_boot.sp = (ulong)stack_top;
+	smp_boot.idx = idx;
+	read_el_sysreg(el, ttbr0, smp_boot.ttbr);
+	read_el_sysreg(el, tcr, smp_boot.tcr);
+	read_el_sysreg(el, mair, smp_boot.mair);
+	read_el_sysreg(el, sctlr, smp_boot.sctlr);
+	read_el_sysreg(el, vbar, smp_boot.vbar);
+
+	/* Secondary cpu reads it with MMU off */
+	flush_dcache_range((ulong)&smp_boot, (ulong)(&smp_boot + 1));
+}
+
+static struct smp_job *smp_dequeue(void)
+{
+	struct smp_job *job = NULL;
+
+	u_spin_lock(&smp.lock);
+	if (smp.head != smp.tail) {
+		job = smp.queue[smp.tail % SMP_QUEUE_SIZE];
+		smp.tail++;
+		job->state = SMP_JOB_RUNNING;
+	}
+	u_spin_unlock(&smp.lock);
+
+	return job;
+}
+
+static int smp_enqueue(struct smp_job *job)
+{
+	int ret = -ENOSPC;
+
+	u_spin_lock(&smp.lock);
+	if (smp.head - smp.tail < SMP_QUEUE_SIZE) {
+		job->state = SMP_JOB_QUEUED;
+		smp.queue[smp.head % SMP_QUEUE_SIZE] = job;
+		smp.head++;
+		ret = 0;
+	}
+	u_spin_unlock(&smp.lock);
+
+	if (!ret) {
+		dsb();
+		asm volatile("sev");
+	}
+
+	return ret;
+}
+
+static void smp_run_job(struct smp_job *job, int idx)
+{
+	ulong start = timer_get_us();
+
+	job->cpu = idx;
+	job->ret = job->fn(&job->td);
+	job->us = timer_get_us() - start;
+
+	smp.cpu[idx].jobs++;
+	smp.cpu[idx].busy_us += job->us;
+
+	/* Publish the result before the state */
+	dmb();
+	job->state = SMP_JOB_DONE;
+	dsb();
+	asm volatile("sev");
+}
+
+void smp_secondary_main(ulong idx)
+{
+	struct smp_cpu *cpu = &smp.cpu[idx];
+	struct smp_job *job;
+	bool lost;
+
+	u_spin_lock(&smp.lock);
+	lost = cpu->state == SMP_CPU_LOST;
+	if (!lost)
+		cpu->state = SMP_CPU_ONLINE;
+	u_spin_unlock(&smp.lock);
+
+	/* Given up on by smp_cpu_up(), which left the stack to us */
+	if (lost) {
+		psci_cpu_off(0);
+		while (1)
+			asm volatile("wfe");
+	}
+
+	dsb();
+	asm volatile("sev");
+
+	while (!smp.exit) {
+		job = smp_dequeue();
+		if (job)
+			smp_run_job(job, idx);
+		else
+			asm volatile("wfe");
+	}
+
+	cpu->state = SMP_CPU_PARKED;
+	dsb();
+	psci_cpu_off(0);
+
+	while (1)
+		asm volatile("wfe");
+}
+
+static int smp_cpu_up(int idx)
+{
+	struct smp_cpu *cpu = &smp.cpu[idx];
+	ulong start;
+	int ret;
+
+	cpu->stack = memalign(16, CONFIG_SMP_STACK_SIZE);
+	if (!cpu->stack)
+		return -ENOMEM;
+
+	smp_boot_setup(idx, cpu->stack + CONFIG_SMP_STACK_SIZE);
+	cpu->state = SMP_CPU_ON_PENDING;
+
+	ret = psci_cpu_on(cpu->mpidr, (ulong)smp_secondary_entry);
+	if (ret) {
+		debug("SMP: cpu 0x%lx on failed, ret=%d\n", cpu->mpidr, ret);
+		goto fail;
+	}
+
+	start = get_timer(0);
+	while (cpu->state != SMP_CPU_ONLINE) {
+		if (get_timer(start) > SMP_ONLINE_TIMEOUT_MS)
+			goto lost;
+		asm volatile("wfe");
+	}
+
+	return 0;
+
+lost:
+	/*
+	 * The cpu may still come up later, so its stack is never freed and
+	 * it powers itself off again once it sees it was given up on.
+	 */
+	u_spin_lock(&smp.lock);
+	if (cpu->state != SMP_CPU_ONLINE)
+		cpu->state = SMP_CPU_LOST;
+	u_spin_unlock(&smp.lock);
+	if (cpu->state == SMP_CPU_ONLINE)
+		return 0;
+
+	printf("SMP: cpu 0x%lx online timeout\n", cpu->mpidr);
+
+	return -ETIMEDOUT;
+
+fail:
+	cpu->state = SMP_CPU_OFF;
+	free(cpu->stack);
+	cpu->stack = NULL;
+
+	return ret;
+}
+
+static int smp_get_cpus(const void *blob, ulong *mpidr, int max)
+{
+	ulong self = read_mpidr() & 0xffffff;
+	int cpus_offset, noffset;
+	const char *type;
+	ulong reg;
+	int num = 0;
+
+	cpus_offset = fdt_path_offset(blob, "/cpus");
+	if (cpus_offset < 0)
+		return 0;
+
+	fdt_for_each_subnode(noffset, blob, cpus_offset) {
+		type = fdt_getprop(blob, noffset, "device_type", NULL);
+		if (!type || strcmp(type, "cpu"))
+			continue;
+		if (!fdtdec_get_is_enabled(blob, noffset))
+			continue;
+
+		reg = (ulong)fdtdec_get_addr_size_auto_parent(blob, cpus_offset,
+						noffset, "reg", 0, NULL, false);
+		if (reg == (ulong)FDT_ADDR_T_NONE || reg == self)
+			continue;
+
+		mpidr[num++] = reg;
+		if (num >= max)
+			break;
+	}
+
+	return num;
+}
+
+int smp_init(void)
+{
+	ulong mpidr[SMP_CPUS_MAX - 1];
+	int i, num, ret;
+
+	if (smp.num_cpus || smp.lost)
+		return smp.num_cpus;
+
+	num = smp_get_cpus(gd->fdt_blob, mpidr,
+			   min(CONFIG_SMP_CPUS_MAX, SMP_CPUS_MAX) - 1);
+	if (!num)
+		return 0;
+
+	/* Lock malloc and friends before any secondary cpu runs */
+	gd->flags |= GD_FLG_SMP;
+	smp.exit = 0;
+
+	for (i = 0; i < num; i++) {
+		smp.cpu[smp.num_cpus + 1].mpidr = mpidr[i];
+		ret = smp_cpu_up(smp.num_cpus + 1);
+		if (ret == -ETIMEDOUT) {
+			/* A late cpu would still read smp_boot, leave it be */
+			smp.lost = true;
+			break;
+		}
+		if (!ret)
+			smp.num_cpus++;
+	}
+
+	if (!smp.num_cpus)
+		gd->flags &= ~GD_FLG_SMP;
+	else
+		debug("SMP: %d secondary cpus online\n", smp.num_cpus);
+
+	return smp.num_cpus;
+}
+
+int smp_online_cpus(void)
+{
+	return smp.num_cpus;
+}
+
+int smp_job_submit(struct smp_job *job, smp_fn_t fn, struct taskdata *td)
+{
+	if (!fn)
+		return -EINVAL;
+
+	job->fn = fn;
+	if (td)
+		job->td = *td;
+	else
+		memset(&job->td, 0, sizeof(job->td));
+	job->ret = 0;
+	job->cpu = 0;
+	job->us = 0;
+
+	if (!smp.num_cpus || smp.exit || smp_enqueue(job)) {
+		job->state = SMP_JOB_RUNNING;
+		smp_run_job(job, 0);
+	}
+
+	return 0;
+}
+
+bool smp_job_done(struct smp_job *job)
+{
+	return job->state == SMP_JOB_DONE;
+}
+
+int smp_job_wait(struct smp_job *job)
+{
+	struct smp_job *other;
+
+	while (job->state != SMP_JOB_DONE) {
+		/* Help out rather than idle, this also keeps nesting safe */
+		other = smp_dequeue();
+		if (other)
+			smp_run_job(other, 0);
+		else if (job->state != SMP_JOB_DONE)
+			asm volatile("wfe");
+	}
+	dmb();
+
+	return job->ret;
+}
+
+void smp_exit(void)
+{
+	struct smp_job *job;
+	ulong start;
+	int i;
+
+	if (!smp.num_cpus)
+		return;
+
+	/* Run what is left in place, the workers finish what they hold */
+	while ((job = smp_dequeue()))
+		smp_run_job(job, 0);
+
+	smp.exit = 1;
+	dsb();
+	asm volatile("sev");
+
+	for (i = 1; i <= smp.num_cpus; i++) {
+		start = get_timer(0);
+		while (smp.cpu[i].state != SMP_CPU_PARKED) {
+			if (get_timer(start) > SMP_OFFLINE_TIMEOUT_MS) {
+				printf("SMP: cpu 0x%lx park timeout\n",
+				       smp.cpu[i].mpidr);
+				break;
+			}
+		}
+		debug("SMP: cpu%d ran %ld jobs in %ld us\n",
+		      i, smp.cpu[i].jobs, smp.cpu[i].busy_us);
+	}
+
+	/* Give PSCI time to power down after the last store */
+	udelay(100);
+
+	gd->flags &= ~GD_FLG_SMP;
+	smp.num_cpus = 0;
+}
+
+static int smp_memset_fn(struct taskdata *td)
+{
+	memset((void *)td->arg0, (int)td->arg1, td->arg2);
+
+	return 0;
+}
+
+int smp_memset(struct smp_job *job, void *s, int c, size_t n)
+{
+	struct taskdata td = {
+		.arg0 = (ulong)s,
+		.arg1 = (ulong)c,
+		.arg2 = n,
+	};
+
+	return smp_job_submit(job, smp_memset_fn, &td);
+}
+
+static int smp_memcpy_fn(struct taskdata *td)
+{
+	memcpy((void *)td->arg0, (const void *)td->arg1, td->arg2);
+
+	return 0;
+}
+
+int smp_memcpy(struct smp_job *job, void *dst, const void *src, size_t n)
+{
+	struct taskdata td = {
+		.arg0 = (ulong)dst,
+		.arg1 = (ulong)src,
+		.arg2 = n,
+	};
+
+	return smp_job_submit(job, smp_memcpy_fn, &td);
+}
+
+static int smp_hash_fn(struct taskdata *td)
+{
+	struct hash_algo *algo = (struct hash_algo *)td->arg0;
+
+	algo->hash_func_ws((const uchar *)td->arg1, td->arg2,
+			   (uchar *)td->arg3, algo->chunk_size);
+
+	return 0;
+}
+
+int smp_hash(struct smp_job *job, const char *algo_name,
+	     const void *data, size_t len, u8 *output)
+{
+	struct hash_algo *algo;
+	struct taskdata td;
+	int ret;
+
+	ret = hash_lookup_algo(algo_name, &algo);
+	if (ret)
+		return ret;
+
+	td.arg0 = (ulong)algo;
+	td.arg1 = (ulong)data;
+	td.arg2 = len;
+	td.arg3 = (ulong)output;
+
+	return smp_job_submit(job, smp_hash_fn, &td);
+}
+
+/*
+ * Fixed tasks behind smp_event1()/smp_event2() used by the boot flow.
+ */
+struct smp_task {
+	int tid;
+	const char *name;
+	bool enabled;
+	bool query_after_submit;
+	bool fatal;
+	int (*prepare)(struct taskdata *td);	/* run on the boot cpu */
+	smp_fn_t fn;
+	struct smp_job job;
+};
+
+#ifdef CONFIG_SMP_TASK_DISPLAY
+static int smp_task_display_prepare(struct taskdata *td)
+{
+	return console_init_r();
+}
+
+static int smp_task_display(struct taskdata *td)
+{
+	return rockchip_show_logo();
+}
+#endif
+
+#ifdef CONFIG_SMP_TASK_FIT_VERIFY
+#define FIT_VERIFY_HASHES	16
+
+/*
+ * The hashes the fit-verify task checks. They are collected on the boot
+ * cpu, so that the task only runs software hashes over image data: the
+ * FIT structure is fixed up meanwhile, and neither driver model nor the
+ * crypto uclass may be used by two cpus at once.
+ */
+struct fit_verify_hash {
+	struct hash_algo *algo;
+	const void *data;
+	size_t size;
+	u8 value[FIT_MAX_HASH_LEN];
+};
+
+static struct fit_verify_hash fit_hashes[FIT_VERIFY_HASHES];
+static int fit_hash_count;
+
+/* Image signatures required by the control FDT are checked in place */
+static bool fit_verify_sigs_required(void)
+{
+	const void *blob = gd_fdt_blob();
+	const char *required;
+	int sig_node, noffset;
+
+	sig_node = fdt_subnode_offset(blob, 0, FIT_SIG_NODENAME);
+	if (sig_node < 0)
+		return false;
+
+	fdt_for_each_subnode(noffset, blob, sig_node) {
+		required = fdt_getprop(blob, noffset, "required", NULL);
+		if (required && !strcmp(required, "image"))
+			return true;
+	}
+
+	return false;
+}
+
+static int fit_verify_add_hash(const void *fit, int noffset,
+			       const void *data, size_t size)
+{
+	struct fit_verify_hash *h = &fit_hashes[fit_hash_count];
+	char *algo_name;
+	u8 *value;
+	int len;
+
+	if (fit_hash_count == FIT_VERIFY_HASHES)
+		return -ENOSPC;
+	if (fit_image_hash_get_algo(fit, noffset, &algo_name) ||
+	    fit_image_hash_get_value(fit, noffset, &value, &len))
+		return -EINVAL;
+	if (hash_lookup_algo(algo_name, &h->algo) ||
+	    len != h->algo->digest_size)
+		return -EINVAL;
+
+	memcpy(h->value, value, len);
+	h->data = data;
+	h->size = size;
+	fit_hash_count++;
+
+	return 0;
+}
+
+/*
+ * Anything this can't hand over, e.g. image signatures or data embedded
+ * in the FIT structure, fails it and fit_image_select() verifies the
+ * images on the boot cpu as before.
+ */
+static int smp_task_fit_prepare(struct taskdata *td)
+{
+	const void *fit = (const void *)td->arg0;
+	int images, image, noffset, ret;
+	const char *name;
+	const void *data;
+	size_t size;
+
+	if (IMAGE_ENABLE_VERIFY && fit_verify_sigs_required())
+		return -ENOTSUPP;
+
+	images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	if (images < 0)
+		return images;
+
+	fit_hash_count = 0;
+	fdt_for_each_subnode(image, fit, images) {
+		if (fdt_getprop(fit, image, FIT_DATA_PROP, NULL))
+			return -ENOTSUPP;
+		if (fit_image_get_data(fit, image, &data, &size))
+			return -ENOENT;
+
+		fdt_for_each_subnode(noffset, fit, image) {
+			name = fit_get_name(fit, noffset, NULL);
+			if (!strncmp(name, FIT_SIG_NODENAME,
+				     strlen(FIT_SIG_NODENAME)))
+				return -ENOTSUPP;
+			if (strncmp(name, FIT_HASH_NODENAME,
+				    strlen(FIT_HASH_NODENAME)))
+				continue;
+
+			ret = fit_verify_add_hash(fit, noffset, data, size);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int smp_task_fit_verify(struct taskdata *td)
+{
+	u8 output[FIT_MAX_HASH_LEN];
+	struct fit_verify_hash *h;
+
+	for (h = fit_hashes; h < fit_hashes + fit_hash_count; h++) {
+		h->algo->hash_func_ws(h->data, h->size, output,
+				      h->algo->chunk_size);
+		if (memcmp(output, h->value, h->algo->digest_size))
+			return -EACCES;
+	}
+
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_SMP_TASK_REGULATOR
+static int smp_task_regulator(struct taskdata *td)
+{
+	return regulators_enable_boot_on(is_hotkey(HK_REGULATOR));
+}
+#endif
+
+static struct smp_task smp_tasks[] = {
+#ifdef CONFIG_SMP_TASK_DISPLAY
+	{
+		.tid = STID_16,
+		.name = "display",
+		.prepare = smp_task_display_prepare,
+		.fn = smp_task_display,
+	},
+#endif
+#ifdef CONFIG_SMP_TASK_FIT_VERIFY
+	{
+		.tid = STID_17,
+		.name = "fit-verify",
+		.query_after_submit = true,
+		.fatal = true,
+		.prepare = smp_task_fit_prepare,
+		.fn = smp_task_fit_verify,
+	},
+#endif
+#ifdef CONFIG_SMP_TASK_REGULATOR
+	{
+		.tid = STID_18,
+		.name = "regulator",
+		.fn = smp_task_regulator,
+	},
+#endif
+};
+
+static struct smp_task *smp_task_get(int tid)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(smp_tasks); i++) {
+		if (smp_tasks[i].tid == tid)
+			return &smp_tasks[i];
+	}
+
+	return NULL;
+}
+
+static int smp_task_submit(int tid, ulong arg)
+{
+	struct smp_task *task = smp_task_get(tid);
+	struct taskdata td = { .arg0 = arg };
+	int ret;
+
+	if (!task || !smp.num_cpus)
+		return -ENOSYS;
+
+	if (task->prepare) {
+		ret = task->prepare(&td);
+		if (ret)
+			return ret;
+	}
+
+	ret = smp_job_submit(&task->job, task->fn, &td);
+	if (!ret)
+		task->enabled = true;
+
+	return ret;
+}
+
+static int smp_task_wait(int tid)
+{
+	struct smp_task *task = smp_task_get(tid);
+
+	if (!task || !task->enabled)
+		return 0;
+
+	return smp_job_wait(&task->job);
+}
+
+static int smp_task_owned(int tid)
+{
+	struct smp_task *task = smp_task_get(tid);
+
+	if (!task || !smp.num_cpus)
+		return 0;
+
+	return task->query_after_submit ? task->enabled : 1;
+}
+
+static void smp_tasks_finish(void)
+{
+	struct smp_task *task;
+	int i, ret;
+
+	for (i = 0; i < ARRAY_SIZE(smp_tasks); i++) {
+		task = &smp_tasks[i];
+		if (!task->enabled)
+			continue;
+
+		ret = smp_job_wait(&task->job);
+		debug("SMP: task %s ret=%d on cpu%d, %ld us\n", task->name,
+		      ret, task->job.cpu, task->job.us);
+		if (ret && task->fatal)
+			panic("SMP: task %s failed, ret=%d\n", task->name, ret);
+		task->enabled = false;
+	}
+}
+
+int smp_event2(int evt, ulong arg0, ulong arg1)
+{
+	switch (evt) {
+	case SEVT_0:
+		if (arg0 == (ulong)-1) {
+			smp_tasks_finish();
+			smp_exit();
+		} else {
+			smp_init();
+		}
+		return 0;
+	case SEVT_1:
+		return smp_task_submit(arg0, arg1);
+	case SEVT_2:
+		return smp_task_wait(arg0);
+	case SEVT_3:
+		return smp_task_owned(arg0);
+	default:
+		return -EINVAL;
+	}
+}
+
+int smp_event1(int evt, ulong arg0)
+{
+	return smp_event2(evt, arg0, 0);
+}
@@ -90,6 +90,18 @@ static void print_mmcinfo(struct mmc *mmc)
 			}
 		}
 	}
+
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	if (mmc->cmdq_depth) {
+		struct mmc_cqe_stats *st = &mmc->cqe_stats;
+
+		printf("Command Queue: depth %d%s\n", mmc->cmdq_depth,
+		       mmc->cfg->host_caps & MMC_MODE_CQE ? "" : " (no host CQE)");
+		printf("  batches %lu, fallbacks %lu, tasks %lu, depth avg %lu max %u\n",
+		       st->batches, st->fallbacks, st->tasks,
+		       st->tasks ? st->depth_sum / st->tasks : 0, st->max_depth);
+	}
+#endif
 }
 static struct mmc *init_mmc_device(int dev, bool force_init)
 {
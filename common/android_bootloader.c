@@ -662,6 +662,7 @@ int android_image_verify_resource(const char *boot_part, ulong *resc_buf)
 	}
 
 retry_verify:
+	bootstage_start(BOOTSTAGE_ID_ACCUM_AVB, "avb_verify");
 	verify_result =
 	avb_slot_verify(ops,
 			requested_partitions,
@@ -669,6 +670,7 @@ retry_verify:
 			flags,
 			AVB_HASHTREE_ERROR_MODE_RESTART,
 			&slot_data);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_AVB);
 	if (verify_result != AVB_SLOT_VERIFY_RESULT_OK &&
 	    verify_result != AVB_SLOT_VERIFY_RESULT_ERROR_PUBLIC_KEY_REJECTED) {
 		if (retry_no_vbmeta_partition && strcmp(boot_part, ANDROID_PARTITION_RECOVERY) == 0) {
@@ -852,6 +854,7 @@ static AvbSlotVerifyResult android_slot_verify(char *boot_partname,
 	}
 
 retry_verify:
+	bootstage_start(BOOTSTAGE_ID_ACCUM_AVB, "avb_verify");
 	verify_result =
 	avb_slot_verify(ops,
 			requested_partitions,
@@ -859,6 +862,7 @@ retry_verify:
 			flags,
 			AVB_HASHTREE_ERROR_MODE_RESTART,
 			&slot_data);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_AVB);
 	if (verify_result != AVB_SLOT_VERIFY_RESULT_OK &&
 	    verify_result != AVB_SLOT_VERIFY_RESULT_ERROR_PUBLIC_KEY_REJECTED) {
 		if (retry_no_vbmeta_partition && strcmp(boot_partname, ANDROID_PARTITION_RECOVERY) == 0) {
@@ -11,6 +11,7 @@
 #include <cli.h>
 #include <console.h>
 #include <fdtdec.h>
+#include <dm/root.h>
 #include <menu.h>
 #include <post.h>
 #include <u-boot/sha256.h>
@@ -245,7 +246,9 @@ static int __abortboot(int bootdelay)
 # endif
 				break;
 			}
-			udelay(10000);
+			/* Probe deferred devices while waiting anyway */
+			if (!dm_probe_deferred(1))
+				udelay(10000);
 		} while (!abort && get_timer(ts) < 1000);
 
 		printf("\b\b\b%2d ", bootdelay);
@@ -421,6 +421,7 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 	 * this, image_len will be set to the number of uncompressed bytes
 	 * loaded, ret will be non-zero on error.
 	 */
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decompress");
 	switch (comp) {
 	case IH_COMP_NONE:
 		if (load == image_start)
@@ -481,9 +482,11 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 	}
 #endif /* CONFIG_LZ4 */
 	default:
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
 		printf("Unimplemented compression type %d\n", comp);
 		return BOOTM_ERR_UNIMPLEMENTED;
 	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
 
 	if (ret)
 		return handle_decomp_error(comp, image_len, unc_len, ret);
@@ -498,6 +501,64 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 }
 
 #ifndef USE_HOSTCC
+#ifdef CONFIG_ARM64
+/* Size of an arm64 Image header */
+#define BOOTM_OS_HEAD_SIZE	64
+
+/*
+ * Let the arch see the header of a Linux kernel before it is loaded, so
+ * that it can choose to decompress it straight to where it is going to run.
+ */
+static void bootm_preload_os(bootm_headers_t *images)
+{
+	image_info_t *os = &images->os;
+	void *image_buf = map_sysmem(os->image_start, os->image_len);
+	u8 buf[BOOTM_OS_HEAD_SIZE];
+	void *head = buf;
+	int len = -ENOSYS;
+
+	images->preload_ep = 0;
+	if (os->os != IH_OS_LINUX || os->type != IH_TYPE_KERNEL)
+		return;
+
+	switch (os->comp) {
+	case IH_COMP_NONE:
+		/* Loaded in place, moving it costs as much as later */
+		if (os->load == os->image_start)
+			return;
+		head = image_buf;
+		len = os->image_len;
+		break;
+#ifdef CONFIG_GZIP
+	case IH_COMP_GZIP:
+		len = gunzip_head(buf, sizeof(buf), image_buf, os->image_len);
+		break;
+#endif
+#ifdef CONFIG_LZ4
+	case IH_COMP_LZ4:
+		/*
+		 * LZ4 needs room to decode past what is asked for, use the
+		 * load buffer unless the image itself is in there.
+		 */
+		if (os->image_start < os->load + CONFIG_SYS_BOOTM_LEN &&
+		    os->load < os->image_start + os->image_len)
+			return;
+		head = map_sysmem(os->load, CONFIG_SYS_BOOTM_LEN);
+		len = ulz4fn_head(image_buf, os->image_len, head,
+				  CONFIG_SYS_BOOTM_LEN, BOOTM_OS_HEAD_SIZE);
+		break;
+#endif
+	}
+
+	if (len >= BOOTM_OS_HEAD_SIZE)
+		arch_preload_os(images, head, BOOTM_OS_HEAD_SIZE);
+}
+#else
+static inline void bootm_preload_os(bootm_headers_t *images)
+{
+}
+#endif
+
 static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 			 int boot_progress)
 {
@@ -715,6 +776,7 @@ int do_bootm_states(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		ulong load_end;
 
 		iflag = bootm_disable_interrupts();
+		bootm_preload_os(images);
 		ret = bootm_load_os(images, &load_end, 0);
 		if (ret == 0)
 			lmb_reserve(&images->lmb, images->os.load,
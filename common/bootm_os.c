@@ -474,6 +474,11 @@ __weak void arch_preboot_os(uint32_t bootm_state, bootm_headers_t *images)
 	/* please define platform specific arch_preboot_os() */
 }
 
+__weak void arch_preload_os(bootm_headers_t *images, const void *head,
+			    ulong size)
+{
+}
+
 int boot_selected_os(int argc, char * const argv[], int state,
 		     bootm_headers_t *images, boot_os_fn *boot_fn)
 {
@@ -11,8 +11,10 @@
  */
 
 #include <common.h>
+#include <fdt_support.h>
 #include <linux/libfdt.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <linux/compiler.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -303,6 +305,83 @@ int bootstage_fdt_add_report(void)
 
 	return 0;
 }
+
+#ifdef CONFIG_BOOTSTAGE_CHOSEN
+/* Longest name passed in /chosen, the rest is cut off */
+#define CHOSEN_NAME_LEN		31
+
+static int add_bootstages_chosen_stash(void *blob, int chosen)
+{
+#ifdef CONFIG_BOOTSTAGE_STASH
+	fdt64_t reg[2];
+	void *stash;
+	int ret;
+
+	stash = map_sysmem(CONFIG_BOOTSTAGE_STASH_ADDR,
+			   CONFIG_BOOTSTAGE_STASH_SIZE);
+	ret = bootstage_stash(stash, CONFIG_BOOTSTAGE_STASH_SIZE);
+	unmap_sysmem(stash);
+	if (ret)
+		return ret;
+
+	ret = fdt_add_mem_rsv(blob, CONFIG_BOOTSTAGE_STASH_ADDR,
+			      CONFIG_BOOTSTAGE_STASH_SIZE);
+	if (ret)
+		return -ENOSPC;
+
+	reg[0] = cpu_to_fdt64(CONFIG_BOOTSTAGE_STASH_ADDR);
+	reg[1] = cpu_to_fdt64(CONFIG_BOOTSTAGE_STASH_SIZE);
+	if (fdt_setprop(blob, chosen, "u-boot,bootstage-stash",
+			reg, sizeof(reg)))
+		return -ENOSPC;
+#endif
+	return 0;
+}
+
+int bootstage_fdt_add_chosen(void *blob)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec;
+	char buf[20], *list, *ptr, *end;
+	int chosen, len, ret, i;
+
+	chosen = fdt_find_or_add_subnode(blob, 0, "chosen");
+	if (chosen < 0)
+		return -EINVAL;
+
+	list = malloc(RECORD_COUNT * BOOTSTAGE_CHOSEN_ENTRY_LEN);
+	if (!list)
+		return -ENOMEM;
+
+	/* Marks and accumulators both sorted by time, as in the report */
+	qsort(data->record, data->rec_count, sizeof(*rec), h_compare_record);
+
+	ptr = list;
+	end = list + RECORD_COUNT * BOOTSTAGE_CHOSEN_ENTRY_LEN;
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (rec->id != BOOTSTAGE_ID_AWAKE && rec->time_us == 0)
+			continue;
+
+		len = snprintf(ptr, end - ptr, "%.*s %s%lu", CHOSEN_NAME_LEN,
+			       get_record_name(buf, sizeof(buf), rec),
+			       rec->start_us ? "+" : "", rec->time_us);
+		if (len >= end - ptr)
+			break;
+		ptr += len + 1;
+	}
+
+	ret = fdt_setprop(blob, chosen, "u-boot,bootstage", list, ptr - list);
+	free(list);
+	if (ret)
+		ret = -ENOSPC;
+	else
+		ret = add_bootstages_chosen_stash(blob, chosen);
+	if (ret)
+		printf("bootstage: Failed to add to /chosen: %d\n", ret);
+
+	return ret;
+}
+#endif
 #endif
 
 void bootstage_report(void)
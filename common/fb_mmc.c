@@ -109,6 +109,61 @@ static lbaint_t fb_mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+#if CONFIG_IS_ENABLED(BLK)
+static lbaint_t fb_mmc_sparse_write_zeroes(struct sparse_storage *info,
+		lbaint_t blk, lbaint_t blkcnt)
+{
+	struct fb_mmc_sparse *sparse = info->priv;
+	ulong blks;
+
+	timed_send_info(&timer, "writing");
+	blks = blk_dwrite_zeroes(sparse->dev_desc, blk, blkcnt);
+
+	/* Not supported by the device, the sparse writer falls back */
+	return IS_ERR_VALUE(blks) ? 0 : blks;
+}
+#else
+#define fb_mmc_sparse_write_zeroes	NULL
+#endif
+
+static void fb_mmc_sparse_init(struct sparse_storage *sparse,
+			       struct fb_mmc_sparse *sparse_priv,
+			       struct blk_desc *dev_desc,
+			       disk_partition_t *info)
+{
+	sparse_priv->dev_desc = dev_desc;
+
+	sparse->blksz = info->blksz;
+	sparse->start = info->start;
+	sparse->size = info->size;
+	sparse->write = fb_mmc_sparse_write;
+	sparse->reserve = fb_mmc_sparse_reserve;
+	sparse->write_zeroes = fb_mmc_sparse_write_zeroes;
+	sparse->priv = sparse_priv;
+}
+
+static struct blk_desc *fb_mmc_get_dev(char *response)
+{
+	struct blk_desc *dev_desc;
+
+#ifdef CONFIG_RKIMG_BOOTLOADER
+	dev_desc = rockchip_get_bootdev();
+	if (!dev_desc) {
+		printf("%s: dev_desc is NULL!\n", __func__);
+		return NULL;
+	}
+#else
+	dev_desc = blk_get_dev("mmc", CONFIG_FASTBOOT_FLASH_MMC_DEV);
+#endif
+	if (!dev_desc || dev_desc->type == DEV_TYPE_UNKNOWN) {
+		pr_err("invalid mmc device\n");
+		fastboot_fail("invalid mmc device", response);
+		return NULL;
+	}
+
+	return dev_desc;
+}
+
 static void write_raw_image(struct blk_desc *dev_desc, disk_partition_t *info,
 		const char *part_name, void *buffer,
 		unsigned int download_bytes, char *response)
@@ -308,20 +363,9 @@ void fb_mmc_flash_write(const char *cmd, void *download_buffer,
 	u64 disksize = 0;
 	char reason[128] = {0};
 #endif
-#ifdef CONFIG_RKIMG_BOOTLOADER
-	dev_desc = rockchip_get_bootdev();
-	if (!dev_desc) {
-		printf("%s: dev_desc is NULL!\n", __func__);
-		return;
-	}
-#else
-	dev_desc = blk_get_dev("mmc", CONFIG_FASTBOOT_FLASH_MMC_DEV);
-#endif
-	if (!dev_desc || dev_desc->type == DEV_TYPE_UNKNOWN) {
-		pr_err("invalid mmc device\n");
-		fastboot_fail("invalid mmc device", response);
+	dev_desc = fb_mmc_get_dev(response);
+	if (!dev_desc)
 		return;
-	}
 
 #if CONFIG_IS_ENABLED(EFI_PARTITION)
 	if (strcmp(cmd, CONFIG_FASTBOOT_GPT_NAME) == 0) {
@@ -398,18 +442,11 @@ download:
 		struct fb_mmc_sparse sparse_priv;
 		struct sparse_storage sparse;
 
-		sparse_priv.dev_desc = dev_desc;
-
-		sparse.blksz = info.blksz;
-		sparse.start = info.start;
-		sparse.size = info.size;
-		sparse.write = fb_mmc_sparse_write;
-		sparse.reserve = fb_mmc_sparse_reserve;
+		fb_mmc_sparse_init(&sparse, &sparse_priv, dev_desc, &info);
 
 		printf("Flashing sparse image at offset " LBAFU "\n",
 		       sparse.start);
 
-		sparse.priv = &sparse_priv;
 		write_sparse_image(&sparse, cmd, download_buffer,
 				   download_bytes, response);
 	} else {
@@ -418,6 +455,79 @@ download:
 	}
 }
 
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+static struct {
+	struct fb_mmc_sparse priv;
+	struct sparse_storage storage;
+	struct sparse_stream stream;
+	char part_name[32];
+} fb_mmc_stream;
+
+int fb_mmc_stream_start(const char *cmd, u64 size, char *response)
+{
+	struct blk_desc *dev_desc;
+	disk_partition_t info;
+
+	dev_desc = fb_mmc_get_dev(response);
+	if (!dev_desc)
+		return -ENODEV;
+
+	/* These are parsed as a whole, not written as they come in */
+	if (!strcmp(cmd, CONFIG_FASTBOOT_GPT_NAME) ||
+	    !strcmp(cmd, CONFIG_FASTBOOT_MBR_NAME) ||
+	    !strncasecmp(cmd, "zimage", 6)) {
+		fastboot_fail("cannot stream this image", response);
+		return -EINVAL;
+	}
+
+	if (strcmp(cmd, CONFIG_FASTBOOT_IDBLOCK_NAME) == 0) {
+		info.blksz = CONFIG_FASTBOOT_MMC_BLOCK_SIZE;
+		info.start = CONFIG_FASTBOOT_IDBLOCK_SECTOR;
+		info.size = CONFIG_FASTBOOT_IDBLOCK_SECTOR_SIZE;
+	} else if (part_get_info_by_name_or_alias(dev_desc, cmd, &info) < 0) {
+		pr_err("cannot find partition: '%s'\n", cmd);
+		fastboot_fail("cannot find partition", response);
+		return -ENOENT;
+	}
+
+	fb_mmc_sparse_init(&fb_mmc_stream.storage, &fb_mmc_stream.priv,
+			   dev_desc, &info);
+	strlcpy(fb_mmc_stream.part_name, cmd,
+		sizeof(fb_mmc_stream.part_name));
+
+	printf("Streaming image to offset " LBAFU "\n", info.start);
+
+	/* The download buffer is free as nothing is kept in it */
+	sparse_stream_init(&fb_mmc_stream.stream, &fb_mmc_stream.storage,
+			   (void *)CONFIG_FASTBOOT_BUF_ADDR,
+			   min(CONFIG_FASTBOOT_STREAM_BUF_SIZE,
+			       CONFIG_FASTBOOT_BUF_SIZE), size);
+
+	return 0;
+}
+
+void fb_mmc_stream_next(void)
+{
+	/* Each piece of a split image is a whole sparse image, never raw */
+	printf("Streaming next piece to '%s'\n", fb_mmc_stream.part_name);
+	sparse_stream_init(&fb_mmc_stream.stream, &fb_mmc_stream.storage,
+			   (void *)CONFIG_FASTBOOT_BUF_ADDR,
+			   min(CONFIG_FASTBOOT_STREAM_BUF_SIZE,
+			       CONFIG_FASTBOOT_BUF_SIZE), 0);
+}
+
+int fb_mmc_stream_write(const void *data, unsigned int len)
+{
+	return sparse_stream_write(&fb_mmc_stream.stream, data, len);
+}
+
+void fb_mmc_stream_finish(char *response)
+{
+	sparse_stream_finish(&fb_mmc_stream.stream, fb_mmc_stream.part_name,
+			     response);
+}
+#endif
+
 void fb_mmc_erase(const char *cmd, char *response)
 {
 	int ret;
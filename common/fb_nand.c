@@ -176,6 +176,7 @@ void fb_nand_flash_write(const char *cmd, void *download_buffer,
 		sparse.size = part->size / sparse.blksz;
 		sparse.write = fb_nand_sparse_write;
 		sparse.reserve = fb_nand_sparse_reserve;
+		sparse.write_zeroes = NULL;
 
 		printf("Flashing sparse image at offset " LBAFU "\n",
 		       sparse.start);
@@ -11,6 +11,8 @@
 #include <android_image.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <misc.h>
+#include <mmc.h>
 #include <errno.h>
 #include <boot_rkimg.h>
 #include <sysmem.h>
@@ -33,6 +35,7 @@ DECLARE_GLOBAL_DATA_PTR;
 
 static char andr_tmp_str[ANDR_BOOT_ARGS_SIZE + 1];
 static u32 android_kernel_comp_type = IH_COMP_NONE;
+static ulong android_kernel_unc_len;	/* decompressed while loading */
 
 static int android_version_init(void)
 {
@@ -160,8 +163,9 @@ static ulong android_image_get_kernel_addr(const struct andr_img_hdr *hdr)
 	 * If kernel is compressed, kernel_addr is set as decompressed address
 	 * after compressed being loaded to ram, so let's use it.
 	 */
-	if (android_kernel_comp_type != IH_COMP_NONE &&
-	    android_kernel_comp_type != IH_COMP_ZIMAGE)
+	if (android_kernel_unc_len ||
+	    (android_kernel_comp_type != IH_COMP_NONE &&
+	     android_kernel_comp_type != IH_COMP_ZIMAGE))
 		return hdr->kernel_addr;
 
 	/*
@@ -253,6 +257,15 @@ int android_image_get_kernel(const struct andr_img_hdr *hdr, int verify,
 
 	env_set("bootargs", newbootargs);
 
+	/* Decompressed by image_load(), bootm takes it in place */
+	if (android_kernel_unc_len) {
+		if (os_data)
+			*os_data = kernel_addr;
+		if (os_len)
+			*os_len = android_kernel_unc_len;
+		return 0;
+	}
+
 	if (os_data) {
 		*os_data = (ulong)hdr;
 		*os_data += hdr->page_size;
@@ -417,6 +430,126 @@ typedef enum {
 static sha1_context sha1_ctx;
 #endif
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+/*
+ * Between image_reads_begin() and image_reads_end() the reads of
+ * image_load() are gathered and then queued to the eMMC together, so the
+ * card works on the kernel and ramdisks at once.
+ */
+static struct mmc_cqe_req image_reqs[IMG_MAX];
+static int image_nreqs = -1;	/* -1 when reads are not gathered */
+
+static int image_reads_flush(struct blk_desc *desc)
+{
+	struct mmc *mmc;
+	int count = image_nreqs;
+
+	if (count <= 0)
+		return 0;
+
+	image_nreqs = 0;
+	mmc = find_mmc_device(desc->devnum);
+	if (!mmc)
+		return -ENODEV;
+
+	return mmc_cqe_read(mmc, image_reqs, count);
+}
+#endif
+
+static void image_reads_begin(void)
+{
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	if (rockchip_get_bootdev()->if_type == IF_TYPE_MMC)
+		image_nreqs = 0;
+#endif
+}
+
+/* Completes the gathered reads, or drops them on @discard */
+static int image_reads_end(bool discard)
+{
+	int ret = 0;
+
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	if (!discard)
+		ret = image_reads_flush(rockchip_get_bootdev());
+	image_nreqs = -1;
+	if (ret)
+		printf("Failed to read images, ret=%d\n", ret);
+#endif
+	return ret;
+}
+
+/*
+ * Reads now, or later in image_reads_end() if reads are gathered and
+ * nothing needs the data before then.
+ */
+static int image_read(struct blk_desc *desc, ulong blk, ulong blkcnt,
+		      void *buffer, bool now)
+{
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	if (image_nreqs >= 0) {
+		if (!now && image_nreqs < ARRAY_SIZE(image_reqs)) {
+			image_reqs[image_nreqs].start = blk;
+			image_reqs[image_nreqs].blkcnt = blkcnt;
+			image_reqs[image_nreqs].dst = buffer;
+			image_nreqs++;
+			return blkcnt;
+		}
+		/* Keep the order of writes to memory */
+		if (image_reads_flush(desc))
+			return -EIO;
+	}
+#endif
+	return blk_dread(desc, blk, blkcnt, buffer);
+}
+
+#if CONFIG_IS_ENABLED(MISC_DECOMPRESS) && defined(CONFIG_BLK)
+/*
+ * Read an lz4 kernel and decompress it meanwhile to where bootm would put
+ * it. The compressed copy is still left at @buffer for the hash, and is
+ * read again as usual if this fails so bootm can decompress it then.
+ */
+static int image_load_kernel_decomp(struct blk_desc *desc,
+				    struct andr_img_hdr *hdr,
+				    ulong blkstart, void *buffer)
+{
+	ulong pgblks = hdr->page_size / desc->blksz;
+	ulong src = (ulong)buffer + hdr->page_size;
+	ulong dst = env_get_ulong("kernel_addr_r", 16, 0);
+	u64 dst_max = CONFIG_SYS_BOOTM_LEN;
+	u64 size;
+	int ret;
+
+	if (!dst || !IS_ALIGNED(hdr->page_size, desc->blksz))
+		return -EINVAL;
+
+	/* The kernel must not be decompressed over its own source */
+	if (dst < src)
+		dst_max = min_t(u64, dst_max, (ulong)buffer - dst);
+	else if (dst < src + hdr->kernel_size)
+		return -EINVAL;
+
+	/* The header page, and the first kernel block to see the format */
+	if (blk_dread(desc, blkstart, pgblks + 1, buffer) != pgblks + 1)
+		return -EIO;
+	if (bootm_parse_comp((void *)src) != IH_COMP_LZ4)
+		return -ENOTSUPP;
+
+	ret = misc_decompress_blk(desc, blkstart + pgblks, src,
+				  hdr->kernel_size, dst, dst_max, DECOM_LZ4,
+				  &size);
+	if (ret) {
+		printf("Failed to decompress kernel while loading, ret=%d\n",
+		       ret);
+		return ret;
+	}
+
+	android_kernel_unc_len = size;
+
+	return 0;
+}
+#endif
+
 static int image_load(img_t img, struct andr_img_hdr *hdr,
 		      ulong blkstart, void *ram_base)
 {
@@ -434,6 +567,8 @@ static int image_load(img_t img, struct andr_img_hdr *hdr,
 	ulong length;
 	void *buffer;
 	void *tmp = NULL;
+	void *inplace = NULL;
+	bool hash_only = false;
 	int ret = 0;
 
 	switch (img) {
@@ -582,7 +717,7 @@ static int image_load(img_t img, struct andr_img_hdr *hdr,
 			 ALIGN(hdr->ramdisk_size, pgsz);
 		length = hdr->second_size;
 		blkcnt = DIV_ROUND_UP(hdr->second_size, blksz);
-		buffer = tmp = malloc(blkcnt * blksz);
+		hash_only = true;
 		typesz = sizeof(hdr->second_size);
 		break;
 	case IMG_RECOVERY_DTBO:
@@ -592,7 +727,7 @@ static int image_load(img_t img, struct andr_img_hdr *hdr,
 			 ALIGN(hdr->second_size, pgsz);
 		length = hdr->recovery_dtbo_size;
 		blkcnt = DIV_ROUND_UP(hdr->recovery_dtbo_size, blksz);
-		buffer = tmp = malloc(blkcnt * blksz);
+		hash_only = true;
 		typesz = sizeof(hdr->recovery_dtbo_size);
 		break;
 	case IMG_DTB:
@@ -603,7 +738,7 @@ static int image_load(img_t img, struct andr_img_hdr *hdr,
 			 ALIGN(hdr->recovery_dtbo_size, pgsz);
 		length = hdr->dtb_size;
 		blkcnt = DIV_ROUND_UP(hdr->dtb_size, blksz);
-		buffer = tmp = malloc(blkcnt * blksz);
+		hash_only = true;
 		typesz = sizeof(hdr->dtb_size);
 		break;
 	case IMG_RK_DTB:
@@ -618,12 +753,26 @@ static int image_load(img_t img, struct andr_img_hdr *hdr,
 		return -EINVAL;
 	}
 
+	/*
+	 * Images that are only hashed are used in place when the boot image
+	 * is in RAM or on a memory-backed block device, otherwise they are
+	 * read into a temporary buffer.
+	 */
+	if (hash_only) {
+		if (ram_base)
+			inplace = (char *)((ulong)ram_base + bsoffs);
+		else if (blksz)
+			inplace = blk_dmap(desc, blkstart +
+					   DIV_ROUND_UP(bsoffs, blksz), blkcnt);
+		buffer = inplace ? inplace : (tmp = malloc(blkcnt * blksz));
+	}
+
 	if (!buffer) {
 		printf("No memory for image(%d)\n", img);
 		return -ENOMEM;
 	}
 
-	if (!blksz || !length)
+	if (!blksz || !length || inplace)
 		goto crypto_calc;
 
 	/* load */
@@ -631,7 +780,13 @@ static int image_load(img_t img, struct andr_img_hdr *hdr,
 		memcpy(buffer, (char *)((ulong)ram_base + bsoffs), length);
 	} else {
 		blkoff = DIV_ROUND_UP(bsoffs, blksz);
-		ret = blk_dread(desc, blkstart + blkoff, blkcnt, buffer);
+#if CONFIG_IS_ENABLED(MISC_DECOMPRESS) && defined(CONFIG_BLK)
+		if (img == IMG_KERNEL &&
+		    !image_load_kernel_decomp(desc, hdr, blkstart, buffer))
+			goto crypto_calc;
+#endif
+		ret = image_read(desc, blkstart + blkoff, blkcnt, buffer,
+				 memmove_dst || tmp);
 		if (ret != blkcnt) {
 			printf("Failed to read img(%d), ret=%d\n", img, ret);
 			return -EIO;
@@ -784,13 +939,16 @@ static int android_image_separate_v34(struct andr_img_hdr *hdr,
 	 */
 	if (image_load(IMG_RK_DTB,  hdr, bstart, ram_base))
 		return -1;
-	if (image_load(IMG_KERNEL,  hdr, bstart, ram_base))
-		return -1;
-	if (image_load(IMG_VENDOR_RAMDISK, hdr, bstart, ram_base))
-		return -1;
-	if (image_load(IMG_RAMDISK, hdr, bstart, ram_base))
+
+	image_reads_begin();
+	if (image_load(IMG_KERNEL,  hdr, bstart, ram_base) ||
+	    image_load(IMG_VENDOR_RAMDISK, hdr, bstart, ram_base) ||
+	    image_load(IMG_RAMDISK, hdr, bstart, ram_base) ||
+	    image_load(IMG_BOOTCONFIG, hdr, bstart, ram_base)) {
+		image_reads_end(true);
 		return -1;
-	if (image_load(IMG_BOOTCONFIG, hdr, bstart, ram_base))
+	}
+	if (image_reads_end(false))
 		return -1;
 	/*
 	 * Copy the populated hdr to load address after image_load(IMG_KERNEL)
@@ -897,6 +1055,7 @@ int android_image_memcpy_separate(struct andr_img_hdr *hdr, ulong *load_addr)
 	ulong comp_addr;
 	int comp;
 
+	android_kernel_unc_len = 0;
 	comp = bootm_parse_comp((void *)(ulong)hdr + hdr->page_size);
 	comp_addr = android_image_get_comp_addr(hdr, comp);
 
@@ -982,12 +1141,17 @@ long android_image_load(struct blk_desc *dev_desc,
 	else
 		load_address -= hdr->page_size;
 
+	android_kernel_unc_len = 0;
+	bootstage_start(BOOTSTAGE_ID_ACCUM_IMAGE_LOAD, "image_load");
 	ret = android_image_load_separate(hdr, part_info, (void *)load_address);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_IMAGE_LOAD);
 	if (ret) {
 		printf("Failed to load android image\n");
 		goto fail;
 	}
 	android_image_set_decomp((void *)load_address, comp);
+	if (android_kernel_unc_len)
+		android_image_set_comp((void *)load_address, IH_COMP_NONE);
 
 	debug("Loading Android Image to 0x%08lx\n", load_address);
 
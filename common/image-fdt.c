@@ -622,6 +622,7 @@ int image_setup_libfdt(bootm_headers_t *images, void *blob,
 	int ret = -EPERM;
 	int fdt_ret;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_FDT_FIXUP, "fdt_fixup");
 	if (arch_fixup_fdt(blob) < 0) {
 		printf("ERROR: arch-specific fdt fixup failed\n");
 		goto err;
@@ -662,7 +663,8 @@ int image_setup_libfdt(bootm_headers_t *images, void *blob,
 		lmb_free(lmb, (phys_addr_t)(u32)(uintptr_t)blob,
 			 (phys_size_t)fdt_totalsize(blob));
 
-	ret = fdt_shrink_to_minimum(blob, 0);
+	/* Leave room for the boot timing added just before the handoff */
+	ret = fdt_shrink_to_minimum(blob, BOOTSTAGE_CHOSEN_SIZE);
 	if (ret < 0)
 		goto err;
 	of_size = ret;
@@ -683,9 +685,11 @@ int image_setup_libfdt(bootm_headers_t *images, void *blob,
 	if (IMAGE_OF_BOARD_SETUP)
 		ft_board_setup_ex(blob, gd->bd);
 #endif
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 
 	return 0;
 err:
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 	printf(" - must RESET the board to recover.\n\n");
 
 	return ret;
@@ -43,46 +43,151 @@
 #include <sparse_format.h>
 #include <fastboot.h>
 
+#include <asm/unaligned.h>
 #include <linux/math64.h>
 
 #ifndef CONFIG_FASTBOOT_FLASH_FILLBUF_SIZE
 #define CONFIG_FASTBOOT_FLASH_FILLBUF_SIZE (1024 * 512)
 #endif
 
-void write_sparse_image(
-		struct sparse_storage *info, const char *part_name,
-		void *data, unsigned sz, char *response)
+enum {
+	SPARSE_STREAM_HEADER,	/* collecting the sparse header */
+	SPARSE_STREAM_CHUNK,	/* collecting a chunk header */
+	SPARSE_STREAM_RAW,	/* copying RAW chunk or raw image data */
+	SPARSE_STREAM_FILL,	/* collecting the FILL value */
+	SPARSE_STREAM_DONE,
+	SPARSE_STREAM_ERROR,
+};
+
+static void sparse_stream_fail(struct sparse_stream *s, const char *error)
 {
-	lbaint_t blk;
-	lbaint_t blkcnt;
+	printf("%s: %s\n", __func__, error);
+	s->error = error;
+	s->state = SPARSE_STREAM_ERROR;
+}
+
+/* Write @blkcnt blocks from @buf at the current position */
+static bool sparse_stream_write_blks(struct sparse_stream *s, const void *buf,
+				     lbaint_t blkcnt)
+{
+	struct sparse_storage *info = s->info;
 	lbaint_t blks;
-	uint64_t bytes_written = 0;
-	unsigned int chunk;
-	unsigned int offset;
-	uint64_t chunk_data_sz;
-	uint32_t *fill_buf = NULL;
-	uint32_t fill_val;
-	sparse_header_t *sparse_header;
-	chunk_header_t *chunk_header;
-	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
 
-	fill_buf_num_blks = CONFIG_FASTBOOT_FLASH_FILLBUF_SIZE / info->blksz;
+	blks = info->write(info, s->blk, blkcnt, buf);
+	/* blks might be > blkcnt (eg. NAND bad-blocks) */
+	if (blks < blkcnt) {
+		printf("%s: %s" LBAFU " [" LBAFU "]\n", __func__,
+		       "Write failed, block #", s->blk, blks);
+		sparse_stream_fail(s, "flash write failure");
+		return false;
+	}
+	s->blk += blks;
+
+	return true;
+}
+
+/* Write out the buffered data, a partial last block is zero padded */
+static bool sparse_stream_flush(struct sparse_stream *s)
+{
+	lbaint_t blksz = s->info->blksz;
+	lbaint_t blkcnt = DIV_ROUND_UP(s->buf_len, blksz);
+
+	if (!s->buf_len)
+		return true;
+
+	memset(s->buf + s->buf_len, 0, blkcnt * blksz - s->buf_len);
+	s->buf_len = 0;
+
+	return sparse_stream_write_blks(s, s->buf, blkcnt);
+}
+
+/* Block the next chunk starts at, including the buffered data */
+static lbaint_t sparse_stream_next_blk(struct sparse_stream *s)
+{
+	return s->blk + s->buf_len / s->info->blksz;
+}
+
+static bool sparse_stream_fits(struct sparse_stream *s, lbaint_t blkcnt)
+{
+	struct sparse_storage *info = s->info;
+
+	if (sparse_stream_next_blk(s) + blkcnt > info->start + info->size) {
+		sparse_stream_fail(s, "Request would exceed partition size!");
+		return false;
+	}
+
+	return true;
+}
+
+static void sparse_stream_next_chunk(struct sparse_stream *s)
+{
+	if (s->chunks < s->sparse.total_chunks) {
+		s->state = SPARSE_STREAM_CHUNK;
+		return;
+	}
+
+	if (sparse_stream_flush(s))
+		s->state = SPARSE_STREAM_DONE;
+}
 
-	/* Read and skip over sparse image header */
-	sparse_header = (sparse_header_t *)data;
+/* Collect @need bytes of a header, returns true once it is complete */
+static bool sparse_stream_collect(struct sparse_stream *s, const u8 **data,
+				  u32 *len, u32 need)
+{
+	u32 n = min(need - s->hdr_len, *len);
+
+	memcpy(s->hdr + s->hdr_len, *data, n);
+	s->hdr_len += n;
+	*data += n;
+	*len -= n;
+	if (s->hdr_len < need)
+		return false;
+
+	s->hdr_len = 0;
+	return true;
+}
+
+/* Not a sparse image: the data, starting with s->hdr, is written as is */
+static void sparse_stream_raw_image(struct sparse_stream *s, u32 hdr_len)
+{
+	struct sparse_storage *info = s->info;
+	lbaint_t blkcnt = DIV_ROUND_UP_ULL(s->raw_size, info->blksz);
+
+	if (blkcnt > info->size) {
+		sparse_stream_fail(s, "too large for partition");
+		return;
+	}
 
-	data += sparse_header->file_hdr_sz;
-	if (sparse_header->file_hdr_sz > sizeof(sparse_header_t)) {
-		/*
-		 * Skip the remaining bytes in a header that is longer than
-		 * we expected.
-		 */
-		data += (sparse_header->file_hdr_sz - sizeof(sparse_header_t));
+	puts("Flashing Raw Image\n");
+
+	s->sparse.total_chunks = 0;
+	s->sparse.total_blks = blkcnt;
+	s->total_blocks = blkcnt;
+	s->bytes_written = blkcnt * info->blksz;
+
+	memcpy(s->buf, s->hdr, hdr_len);
+	s->buf_len = hdr_len;
+	s->left = s->raw_size - hdr_len;
+	s->state = SPARSE_STREAM_RAW;
+	if (!s->left)
+		sparse_stream_next_chunk(s);
+}
+
+static void sparse_stream_header(struct sparse_stream *s)
+{
+	sparse_header_t *sparse_header = &s->sparse;
+	unsigned int offset;
+
+	if (!is_sparse_image(s->hdr)) {
+		if (s->raw_size)
+			sparse_stream_raw_image(s, sizeof(sparse_header_t));
+		else
+			sparse_stream_fail(s, "not a sparse image");
+		return;
 	}
 
+	memcpy(sparse_header, s->hdr, sizeof(*sparse_header));
+
 	debug("=== Sparse Image Header ===\n");
 	debug("magic: 0x%x\n", sparse_header->magic);
 	debug("major_version: 0x%x\n", sparse_header->major_version);
@@ -93,173 +198,291 @@ void write_sparse_image(
 	debug("total_blks: %d\n", sparse_header->total_blks);
 	debug("total_chunks: %d\n", sparse_header->total_chunks);
 
+	if (sparse_header->file_hdr_sz < sizeof(sparse_header_t) ||
+	    sparse_header->chunk_hdr_sz < sizeof(chunk_header_t)) {
+		sparse_stream_fail(s, "sparse image header size issue");
+		return;
+	}
+
 	/*
 	 * Verify that the sparse block size is a multiple of our
 	 * storage backend block size
 	 */
-	div_u64_rem(sparse_header->blk_sz, info->blksz, &offset);
-	if (offset) {
+	div_u64_rem(sparse_header->blk_sz, s->info->blksz, &offset);
+	if (!sparse_header->blk_sz || offset) {
 		printf("%s: Sparse image block size issue [%u]\n",
 		       __func__, sparse_header->blk_sz);
-		fastboot_fail("sparse image block size issue", response);
+		sparse_stream_fail(s, "sparse image block size issue");
 		return;
 	}
 
 	puts("Flashing Sparse Image\n");
 
-	/* Start processing chunks */
-	blk = info->start;
-	for (chunk = 0; chunk < sparse_header->total_chunks; chunk++) {
-		/* Read and skip over chunk header */
-		chunk_header = (chunk_header_t *)data;
-		data += sizeof(chunk_header_t);
-
-		if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
-			debug("=== Chunk Header ===\n");
-			debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
-			debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
-			debug("total_size: 0x%x\n", chunk_header->total_sz);
+	/*
+	 * Skip the remaining bytes in a header that is longer than
+	 * we expected.
+	 */
+	s->skip = sparse_header->file_hdr_sz - sizeof(sparse_header_t);
+	sparse_stream_next_chunk(s);
+}
+
+static void sparse_stream_chunk(struct sparse_stream *s)
+{
+	chunk_header_t *chunk_header = &s->chunk;
+	u64 chunk_data_sz;
+	lbaint_t blkcnt;
+	u32 data_sz;
+
+	memcpy(chunk_header, s->hdr, sizeof(*chunk_header));
+	s->chunks++;
+
+	if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
+		debug("=== Chunk Header ===\n");
+		debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
+		debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
+		debug("total_size: 0x%x\n", chunk_header->total_sz);
+	}
+
+	if (chunk_header->total_sz < s->sparse.chunk_hdr_sz) {
+		sparse_stream_fail(s, "Bogus chunk size");
+		return;
+	}
+	data_sz = chunk_header->total_sz - s->sparse.chunk_hdr_sz;
+
+	/*
+	 * Skip the remaining bytes in a header that is longer
+	 * than we expected.
+	 */
+	s->skip = s->sparse.chunk_hdr_sz - sizeof(chunk_header_t);
+
+	chunk_data_sz = ((u64)s->sparse.blk_sz) * chunk_header->chunk_sz;
+	blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, s->info->blksz);
+	switch (chunk_header->chunk_type) {
+	case CHUNK_TYPE_RAW:
+		if (data_sz != chunk_data_sz) {
+			sparse_stream_fail(s,
+					   "Bogus chunk size for chunk type Raw");
+			return;
 		}
 
-		if (sparse_header->chunk_hdr_sz > sizeof(chunk_header_t)) {
-			/*
-			 * Skip the remaining bytes in a header that is longer
-			 * than we expected.
-			 */
-			data += (sparse_header->chunk_hdr_sz -
-				 sizeof(chunk_header_t));
+		if (!sparse_stream_fits(s, blkcnt))
+			return;
+
+		s->bytes_written += ((u64)blkcnt) * s->info->blksz;
+		s->total_blocks += chunk_header->chunk_sz;
+		s->left = chunk_data_sz;
+		s->state = SPARSE_STREAM_RAW;
+		if (!s->left)
+			sparse_stream_next_chunk(s);
+		break;
+
+	case CHUNK_TYPE_FILL:
+		if (data_sz != sizeof(uint32_t)) {
+			sparse_stream_fail(s,
+					   "Bogus chunk size for chunk type FILL");
+			return;
 		}
 
-		chunk_data_sz = ((u64)sparse_header->blk_sz) * chunk_header->chunk_sz;
-		blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, info->blksz);
-		switch (chunk_header->chunk_type) {
-		case CHUNK_TYPE_RAW:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
-				fastboot_fail(
-					"Bogus chunk size for chunk type Raw", response);
-				return;
-			}
-
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				fastboot_fail(
-				    "Request would exceed partition size!", response);
-				return;
-			}
-
-			blks = info->write(info, blk, blkcnt, data);
-			/* blks might be > blkcnt (eg. NAND bad-blocks) */
-			if (blks < blkcnt) {
-				printf("%s: %s" LBAFU " [" LBAFU "]\n",
-				       __func__, "Write failed, block #",
-				       blk, blks);
-				fastboot_fail(
-					      "flash write failure", response);
-				return;
-			}
-			blk += blks;
-			bytes_written += ((u64)blkcnt) * info->blksz;
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
-			break;
+		if (!sparse_stream_fits(s, blkcnt))
+			return;
 
-		case CHUNK_TYPE_FILL:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
-				fastboot_fail(
-					"Bogus chunk size for chunk type FILL", response);
-				return;
-			}
-
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
-				fastboot_fail(
-					"Malloc failed for: CHUNK_TYPE_FILL", response);
-				return;
-			}
-
-			fill_val = *(uint32_t *)data;
-			data = (char *)data + sizeof(uint32_t);
-
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
-
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				fastboot_fail(
-				    "Request would exceed partition size!", response);
-				return;
-			}
-
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					fastboot_fail(
-						      "flash write failure", response);
-					free(fill_buf);
-					return;
-				}
-				blk += blks;
-				i += j;
-			}
-			bytes_written += ((u64)blkcnt) * info->blksz;
-			total_blocks += DIV_ROUND_UP_ULL(chunk_data_sz,
-							 sparse_header->blk_sz);
-			free(fill_buf);
-			break;
+		s->left = blkcnt;
+		s->state = SPARSE_STREAM_FILL;
+		break;
 
-		case CHUNK_TYPE_DONT_CARE:
-			blk += info->reserve(info, blk, blkcnt);
-			total_blocks += chunk_header->chunk_sz;
-			break;
+	case CHUNK_TYPE_DONT_CARE:
+		if (!sparse_stream_flush(s))
+			return;
 
-		case CHUNK_TYPE_CRC32:
-			if (chunk_header->total_sz !=
-			    sparse_header->chunk_hdr_sz) {
-				fastboot_fail(
-					"Bogus chunk size for chunk type Dont Care", response);
-				return;
-			}
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
-			break;
+		s->blk += s->info->reserve(s->info, s->blk, blkcnt);
+		s->total_blocks += chunk_header->chunk_sz;
+		s->skip += data_sz;
+		sparse_stream_next_chunk(s);
+		break;
+
+	case CHUNK_TYPE_CRC32:
+		s->total_blocks += chunk_header->chunk_sz;
+		s->skip += data_sz;
+		sparse_stream_next_chunk(s);
+		break;
 
-		default:
-			printf("%s: Unknown chunk type: %x\n", __func__,
-			       chunk_header->chunk_type);
-			fastboot_fail("Unknown chunk type", response);
+	default:
+		printf("%s: Unknown chunk type: %x\n", __func__,
+		       chunk_header->chunk_type);
+		sparse_stream_fail(s, "Unknown chunk type");
+	}
+}
+
+static void sparse_stream_fill(struct sparse_stream *s, u32 fill_val)
+{
+	struct sparse_storage *info = s->info;
+	lbaint_t blkcnt = s->left;
+	lbaint_t fill_blks = s->buf_size / info->blksz;
+	lbaint_t blks, i, j, n;
+	u32 *fill_buf;
+
+	if (!sparse_stream_flush(s))
+		return;
+
+	/* Zeroes need no data if the storage can write them by itself */
+	if (!fill_val && info->write_zeroes) {
+		blks = info->write_zeroes(info, s->blk, blkcnt);
+		if (blks >= blkcnt) {
+			s->blk += blks;
+			goto done;
+		}
+	}
+
+	fill_buf = (u32 *)s->buf;
+	n = min(fill_blks, blkcnt) * info->blksz / sizeof(fill_val);
+	for (i = 0; i < n; i++)
+		fill_buf[i] = fill_val;
+
+	for (i = 0; i < blkcnt; i += j) {
+		j = min(blkcnt - i, fill_blks);
+		if (!sparse_stream_write_blks(s, fill_buf, j))
 			return;
+	}
+
+done:
+	s->bytes_written += ((u64)blkcnt) * info->blksz;
+	s->total_blocks += s->chunk.chunk_sz;
+	sparse_stream_next_chunk(s);
+}
+
+static u32 sparse_stream_raw(struct sparse_stream *s, const u8 *data, u32 len)
+{
+	lbaint_t blksz = s->info->blksz;
+
+	if (len > s->left)
+		len = s->left;
+
+	/* Large pieces go to the storage directly if nothing is buffered */
+	if (!s->buf_len && len >= s->buf_size) {
+		len = rounddown(len, blksz);
+		if (!sparse_stream_write_blks(s, data, len / blksz))
+			return len;
+	} else {
+		len = min(len, s->buf_size - s->buf_len);
+		memcpy(s->buf + s->buf_len, data, len);
+		s->buf_len += len;
+		if (s->buf_len == s->buf_size && !sparse_stream_flush(s))
+			return len;
+	}
+
+	s->left -= len;
+	if (!s->left)
+		sparse_stream_next_chunk(s);
+
+	return len;
+}
+
+void sparse_stream_init(struct sparse_stream *s, struct sparse_storage *info,
+			void *buf, u32 buf_size, u64 raw_size)
+{
+	memset(s, 0, sizeof(*s));
+	s->info = info;
+	s->buf = buf;
+	s->buf_size = rounddown(buf_size, info->blksz);
+	s->raw_size = raw_size;
+	s->blk = info->start;
+	s->state = SPARSE_STREAM_HEADER;
+}
+
+int sparse_stream_write(struct sparse_stream *s, const void *data, u32 len)
+{
+	const u8 *p = data;
+	u32 n;
+
+	while (len && s->state != SPARSE_STREAM_DONE &&
+	       s->state != SPARSE_STREAM_ERROR) {
+		if (s->skip) {
+			n = min(s->skip, len);
+			s->skip -= n;
+			p += n;
+			len -= n;
+			continue;
+		}
+
+		switch (s->state) {
+		case SPARSE_STREAM_HEADER:
+			if (sparse_stream_collect(s, &p, &len,
+						  sizeof(sparse_header_t)))
+				sparse_stream_header(s);
+			break;
+		case SPARSE_STREAM_CHUNK:
+			if (sparse_stream_collect(s, &p, &len,
+						  sizeof(chunk_header_t)))
+				sparse_stream_chunk(s);
+			break;
+		case SPARSE_STREAM_FILL:
+			if (sparse_stream_collect(s, &p, &len,
+						  sizeof(uint32_t)))
+				sparse_stream_fill(s,
+						   get_unaligned((u32 *)s->hdr));
+			break;
+		case SPARSE_STREAM_RAW:
+			n = sparse_stream_raw(s, p, len);
+			p += n;
+			len -= n;
+			break;
 		}
 	}
 
+	return s->state == SPARSE_STREAM_ERROR ? -EIO : 0;
+}
+
+void sparse_stream_finish(struct sparse_stream *s, const char *part_name,
+			  char *response)
+{
+	/* A raw image shorter than a sparse header */
+	if (s->state == SPARSE_STREAM_HEADER && s->raw_size == s->hdr_len)
+		sparse_stream_raw_image(s, s->hdr_len);
+
+	if (s->state != SPARSE_STREAM_DONE &&
+	    s->state != SPARSE_STREAM_ERROR)
+		sparse_stream_fail(s, "sparse image is truncated");
+
+	if (s->state == SPARSE_STREAM_ERROR) {
+		fastboot_fail(s->error, response);
+		return;
+	}
+
 	debug("Wrote %d blocks, expected to write %d blocks\n",
-	      total_blocks, sparse_header->total_blks);
-	printf("........ wrote %llu bytes to '%s'\n", bytes_written, part_name);
+	      s->total_blocks, s->sparse.total_blks);
+	printf("........ wrote %llu bytes to '%s'\n", s->bytes_written,
+	       part_name);
 
-	if (total_blocks != sparse_header->total_blks)
+	if (s->total_blocks != s->sparse.total_blks)
 		fastboot_fail("sparse image write failure", response);
 	else
 		fastboot_okay("", response);
+}
+
+void write_sparse_image(
+		struct sparse_storage *info, const char *part_name,
+		void *data, unsigned sz, char *response)
+{
+	struct sparse_stream s;
+	int fill_buf_num_blks;
+	void *buf;
+
+	fill_buf_num_blks = CONFIG_FASTBOOT_FLASH_FILLBUF_SIZE / info->blksz;
+	buf = memalign(ARCH_DMA_MINALIGN,
+		       ROUNDUP(info->blksz * fill_buf_num_blks,
+			       ARCH_DMA_MINALIGN));
+	if (!buf) {
+		fastboot_fail("Malloc failed for sparse image", response);
+		return;
+	}
+
+	/*
+	 * RAW chunks larger than the buffer are written from @data, smaller
+	 * ones are gathered in the buffer, which also holds FILL patterns.
+	 */
+	sparse_stream_init(&s, info, buf, info->blksz * fill_buf_num_blks, 0);
+	sparse_stream_write(&s, data, sz);
+	sparse_stream_finish(&s, part_name, response);
 
-	return;
+	free(buf);
 }
@@ -937,6 +937,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	mpb_init_1(*info);
 #endif
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_FIT_LOAD, "spl_fit_load");
 	printf("Trying fit image at 0x%lx sector\n", sector_offs);
 	for (i = 0; i < CONFIG_SPL_FIT_IMAGE_MULTIPLE; i++) {
 		if (i > 0) {
@@ -963,6 +964,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 			break;
 		}
 	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FIT_LOAD);
 #ifdef CONFIG_SPL_AB
 	/* If boot fail in spl, spl must decrease 1 and do_reset. */
 	if (ret)
@@ -718,15 +718,21 @@ static int part_get_info_by_name_option(struct blk_desc *dev_desc,
 
 lookup:
 	debug("## Query partition(%d): %s\n", none_slot_try, full_name);
-	for (i = 1; i < part_drv->max_entries; i++) {
-		ret = part_drv->get_info(dev_desc, i, info);
-		if (ret != 0) {
-			/* no more entries in table */
-			break;
-		}
-		if (strcmp(full_name, (const char *)info->name) == 0) {
-			/* matched */
-			return i;
+	if (part_drv->get_info_by_name) {
+		ret = part_drv->get_info_by_name(dev_desc, full_name, info);
+		if (ret > 0)
+			return ret;
+	} else {
+		for (i = 1; i < part_drv->max_entries; i++) {
+			ret = part_drv->get_info(dev_desc, i, info);
+			if (ret != 0) {
+				/* no more entries in table */
+				break;
+			}
+			if (strcmp(full_name, (const char *)info->name) == 0) {
+				/* matched */
+				return i;
+			}
 		}
 	}
 
@@ -752,6 +758,32 @@ int part_get_info_by_name_strict(struct blk_desc *dev_desc, const char *name,
 	return part_get_info_by_name_option(dev_desc, name, info, true);
 }
 
+int part_get_info_by_uuid(struct blk_desc *dev_desc, const char *uuid,
+			  disk_partition_t *info)
+{
+	struct part_driver *part_drv;
+	__maybe_unused int ret, i;
+
+	part_drv = part_driver_lookup_type(dev_desc);
+	if (!part_drv)
+		return -1;
+
+	if (part_drv->get_info_by_uuid)
+		return part_drv->get_info_by_uuid(dev_desc, uuid, info);
+
+#if CONFIG_IS_ENABLED(PARTITION_UUIDS)
+	for (i = 1; i < part_drv->max_entries; i++) {
+		ret = part_drv->get_info(dev_desc, i, info);
+		if (ret != 0)
+			break;
+		if (!strcasecmp(uuid, info->uuid))
+			return i;
+	}
+#endif
+
+	return -1;
+}
+
 void part_set_generic_name(const struct blk_desc *dev_desc,
 	int part_num, char *name)
 {
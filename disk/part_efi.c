@@ -21,6 +21,8 @@
 #include <part_efi.h>
 #include <linux/compiler.h>
 #include <linux/ctype.h>
+#include <linux/list.h>
+#include <linux/log2.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -280,95 +282,300 @@ void part_print_efi(struct blk_desc *dev_desc)
 	return;
 }
 
-int part_get_info_efi(struct blk_desc *dev_desc, int part,
-		      disk_partition_t *info)
+/*
+ * Parsed GPT of each block device, with the partitions indexed by name and
+ * unique GUID. The boot flow looks the same partitions up many times, this
+ * saves reading and checking the table on every lookup. An entry is dropped
+ * when the device is initialized again or its GPT is written.
+ */
+struct gpt_cache {
+	struct list_head list;
+	int if_type;
+	int devnum;
+	lbaint_t rawlba;
+	gpt_header *head;
+	gpt_entry *pte;
+	u32 num;		/* number of partition entries */
+	u32 mask;		/* index slots - 1 */
+	u32 *name_idx;		/* partition number, 0 if the slot is free */
+	u32 *uuid_idx;
+};
+
+static LIST_HEAD(gpt_cache_list);
+
+static u32 gpt_hash(const void *key, int len)
 {
-	static gpt_entry *gpt_pte = NULL;
-	static gpt_header *gpt_head = NULL;
-	int sector, b_gpt_nsec = 0x22;
+	const u8 *p = key;
+	u32 hash = 2166136261u;
 
-	if (!dev_desc->rawblksz || !dev_desc->rawlba) {
-		dev_desc->rawblksz = dev_desc->blksz;
-		dev_desc->rawlba = dev_desc->lba;
+	while (len--)
+		hash = (hash ^ *p++) * 16777619u;
+
+	return hash;
+}
+
+/* Slot that holds @key, or the free slot it goes into */
+static u32 *gpt_index_slot(struct gpt_cache *cache, bool uuid, const void *key)
+{
+	u32 *idx = uuid ? cache->uuid_idx : cache->name_idx;
+	u32 i, *slot;
+	gpt_entry *pte;
+
+	i = uuid ? gpt_hash(key, sizeof(efi_guid_t)) :
+		   gpt_hash(key, strlen(key));
+	for (;; i++) {
+		slot = &idx[i & cache->mask];
+		if (!*slot)
+			return slot;
+
+		pte = &cache->pte[*slot - 1];
+		if (uuid ? !memcmp(&pte->unique_partition_guid, key,
+				   sizeof(efi_guid_t)) :
+			   !strcmp(print_efiname(pte), key))
+			return slot;
 	}
+}
 
-	if (dev_desc->rawblksz == 4096)
-		b_gpt_nsec = 6;
+static int gpt_cache_index(struct gpt_cache *cache)
+{
+	char name[PARTNAME_SZ + 1];
+	u32 slots, i, *slot;
+
+	/* At most half full, so probing always ends on a free slot */
+	slots = roundup_pow_of_two(2 * cache->num);
+	cache->name_idx = calloc(2 * slots, sizeof(u32));
+	if (!cache->name_idx)
+		return -ENOMEM;
+	cache->uuid_idx = cache->name_idx + slots;
+	cache->mask = slots - 1;
+
+	/* The first of several partitions with one name wins, as before */
+	for (i = 0; i < cache->num; i++) {
+		if (!is_pte_valid(&cache->pte[i]))
+			continue;
 
-	if (!gpt_head)
-		gpt_head = memalign(ARCH_DMA_MINALIGN, dev_desc->rawblksz);
+		strcpy(name, print_efiname(&cache->pte[i]));
+		slot = gpt_index_slot(cache, false, name);
+		if (!*slot)
+			*slot = i + 1;
 
-	/*
-	 * We suppose different dev have different size, eg. emmc vs sd
-	 * free the pte first if exist and then will malloc and init a new one.
-	 */
-	if (gpt_head && (gpt_head->last_usable_lba + b_gpt_nsec) != dev_desc->rawlba) {
-		if (dev_desc->rawblksz == 4096) {
-			/* realloc gpt header buffer */
-			free(gpt_head);
-			gpt_head = memalign(ARCH_DMA_MINALIGN, dev_desc->rawblksz);
-		}
-		if (gpt_pte)
-			free(gpt_pte);
-		gpt_pte = NULL;
+		slot = gpt_index_slot(cache, true,
+				      &cache->pte[i].unique_partition_guid);
+		if (!*slot)
+			*slot = i + 1;
 	}
 
-	/* "part" argument must be at least 1 */
-	if (part < 1) {
-		printf("%s: Invalid Argument(s)\n", __func__);
-		return -1;
+	return 0;
+}
+
+static void gpt_cache_free(struct gpt_cache *cache)
+{
+	list_del(&cache->list);
+	free(cache->name_idx);
+	free(cache->pte);
+	free(cache->head);
+	free(cache);
+}
+
+/*
+ * Before relocation the early malloc area goes away, so the table is only
+ * kept once U-Boot runs from its final location.
+ */
+static bool gpt_cache_keep(void)
+{
+	return IS_ENABLED(CONFIG_SPL_BUILD) || (gd->flags & GD_FLG_RELOC);
+}
+
+static struct gpt_cache *gpt_cache_get(struct blk_desc *dev_desc)
+{
+	struct gpt_cache *cache;
+
+	list_for_each_entry(cache, &gpt_cache_list, list) {
+		if (cache->if_type == dev_desc->if_type &&
+		    cache->devnum == dev_desc->devnum &&
+		    cache->rawlba == dev_desc->rawlba)
+			return cache;
 	}
 
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return NULL;
+	INIT_LIST_HEAD(&cache->list);
+	cache->if_type = dev_desc->if_type;
+	cache->devnum = dev_desc->devnum;
+	cache->rawlba = dev_desc->rawlba;
+	cache->head = memalign(ARCH_DMA_MINALIGN, dev_desc->rawblksz);
+	if (!cache->head)
+		goto err;
+
 	/* This function validates AND fills in the GPT header and PTE */
 	if (is_gpt_valid(dev_desc, GPT_PRIMARY_PARTITION_TABLE_LBA,
-			gpt_head, &gpt_pte) != 1) {
+			 cache->head, &cache->pte) != 1) {
 		printf("%s: *** ERROR: Invalid GPT ***\n", __func__);
 		if (is_gpt_valid(dev_desc, (dev_desc->rawlba - 1),
-				 gpt_head, &gpt_pte) != 1) {
+				 cache->head, &cache->pte) != 1) {
 			printf("%s: *** ERROR: Invalid Backup GPT ***\n",
 			       __func__);
-			return -1;
+			goto err;
 		} else {
 			printf("%s: ***        Using Backup GPT ***\n",
 			       __func__);
 		}
 	}
 
-	if (part > le32_to_cpu(gpt_head->num_partition_entries) ||
-	    !is_pte_valid(&gpt_pte[part - 1])) {
-		debug("%s: *** ERROR: Invalid partition number %d ***\n",
-			__func__, part);
-		return -1;
+	cache->num = le32_to_cpu(cache->head->num_partition_entries);
+	if (gpt_cache_index(cache))
+		goto err;
+
+	if (gpt_cache_keep())
+		list_add(&cache->list, &gpt_cache_list);
+
+	return cache;
+
+err:
+	gpt_cache_free(cache);
+	return NULL;
+}
+
+static void gpt_cache_put(struct gpt_cache *cache)
+{
+	if (list_empty(&cache->list))
+		gpt_cache_free(cache);
+}
+
+void gpt_cache_invalidate(struct blk_desc *dev_desc, lbaint_t start,
+			  lbaint_t blkcnt)
+{
+	struct gpt_cache *cache, *tmp;
+	lbaint_t first, last;
+	int sector;
+
+	list_for_each_entry_safe(cache, tmp, &gpt_cache_list, list) {
+		if (cache->if_type != dev_desc->if_type ||
+		    cache->devnum != dev_desc->devnum)
+			continue;
+
+		/* Only writes to the MBR or either GPT matter */
+		sector = dev_desc->rawblksz / dev_desc->blksz;
+		first = le64_to_cpu(cache->head->first_usable_lba) * sector;
+		last = (le64_to_cpu(cache->head->last_usable_lba) + 1) * sector;
+		if (!blkcnt || start < first || start + blkcnt > last)
+			gpt_cache_free(cache);
 	}
+}
+
+static void gpt_fill_info(struct blk_desc *dev_desc, gpt_entry *pte,
+			  disk_partition_t *info)
+{
+	int sector = dev_desc->rawblksz / dev_desc->blksz;
 
-	sector = dev_desc->rawblksz / dev_desc->blksz;
 	/* The 'lbaint_t' casting may limit the maximum disk size to 2 TB */
-	info->start = (lbaint_t)le64_to_cpu(gpt_pte[part - 1].starting_lba);
+	info->start = (lbaint_t)le64_to_cpu(pte->starting_lba);
 	/* The ending LBA is inclusive, to calculate size, add 1 to it */
-	info->size = (lbaint_t)le64_to_cpu(gpt_pte[part - 1].ending_lba) + 1
+	info->size = (lbaint_t)le64_to_cpu(pte->ending_lba) + 1
 		     - info->start;
 	info->start *= sector;
 	info->size *= sector;
 
 	info->blksz = dev_desc->blksz;
 
-	sprintf((char *)info->name, "%s",
-			print_efiname(&gpt_pte[part - 1]));
+	sprintf((char *)info->name, "%s", print_efiname(pte));
 	strcpy((char *)info->type, "U-Boot");
-	info->bootable = is_bootable(&gpt_pte[part - 1]);
+	info->bootable = is_bootable(pte);
 #if CONFIG_IS_ENABLED(PARTITION_UUIDS)
-	uuid_bin_to_str(gpt_pte[part - 1].unique_partition_guid.b, info->uuid,
+	uuid_bin_to_str(pte->unique_partition_guid.b, info->uuid,
 			UUID_STR_FORMAT_GUID);
 #endif
 #ifdef CONFIG_PARTITION_TYPE_GUID
-	uuid_bin_to_str(gpt_pte[part - 1].partition_type_guid.b,
+	uuid_bin_to_str(pte->partition_type_guid.b,
 			info->type_guid, UUID_STR_FORMAT_GUID);
 #endif
 
 	debug("%s: start 0x" LBAF ", size 0x" LBAF ", name %s\n", __func__,
 	      info->start, info->size, info->name);
+}
 
-	return 0;
+static void gpt_init_raw(struct blk_desc *dev_desc)
+{
+	if (!dev_desc->rawblksz || !dev_desc->rawlba) {
+		dev_desc->rawblksz = dev_desc->blksz;
+		dev_desc->rawlba = dev_desc->lba;
+	}
+}
+
+int part_get_info_efi(struct blk_desc *dev_desc, int part,
+		      disk_partition_t *info)
+{
+	struct gpt_cache *cache;
+	int ret = 0;
+
+	gpt_init_raw(dev_desc);
+
+	/* "part" argument must be at least 1 */
+	if (part < 1) {
+		printf("%s: Invalid Argument(s)\n", __func__);
+		return -1;
+	}
+
+	cache = gpt_cache_get(dev_desc);
+	if (!cache)
+		return -1;
+
+	if (part > cache->num || !is_pte_valid(&cache->pte[part - 1])) {
+		debug("%s: *** ERROR: Invalid partition number %d ***\n",
+			__func__, part);
+		ret = -1;
+	} else {
+		gpt_fill_info(dev_desc, &cache->pte[part - 1], info);
+	}
+	gpt_cache_put(cache);
+
+	return ret;
+}
+
+static int part_get_info_by_name_efi(struct blk_desc *dev_desc,
+				     const char *name, disk_partition_t *info)
+{
+	struct gpt_cache *cache;
+	int part = 0;
+
+	gpt_init_raw(dev_desc);
+
+	cache = gpt_cache_get(dev_desc);
+	if (!cache)
+		return -1;
+
+	if (strlen(name) <= PARTNAME_SZ)
+		part = *gpt_index_slot(cache, false, name);
+	if (part)
+		gpt_fill_info(dev_desc, &cache->pte[part - 1], info);
+	gpt_cache_put(cache);
+
+	return part ? part : -1;
+}
+
+static int part_get_info_by_uuid_efi(struct blk_desc *dev_desc,
+				     const char *uuid, disk_partition_t *info)
+{
+	struct gpt_cache *cache;
+	efi_guid_t guid;
+	int part;
+
+	if (uuid_str_to_bin((char *)uuid, guid.b, UUID_STR_FORMAT_GUID))
+		return -1;
+
+	gpt_init_raw(dev_desc);
+
+	cache = gpt_cache_get(dev_desc);
+	if (!cache)
+		return -1;
+
+	part = *gpt_index_slot(cache, true, &guid);
+	if (part)
+		gpt_fill_info(dev_desc, &cache->pte[part - 1], info);
+	gpt_cache_put(cache);
+
+	return part ? part : -1;
 }
 
 #ifdef CONFIG_RKIMG_BOOTLOADER
@@ -492,10 +699,9 @@ static int part_test_efi(struct blk_desc *dev_desc)
 {
 	int ret = 0;
 
-	if (!dev_desc->rawblksz || !dev_desc->rawlba) {
-		dev_desc->rawblksz = dev_desc->blksz;
-		dev_desc->rawlba = dev_desc->lba;
-	}
+	gpt_init_raw(dev_desc);
+	/* The device was (re)initialized, the medium may have changed */
+	gpt_cache_invalidate(dev_desc, 0, 0);
 
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(legacy_mbr, legacymbr, 1, dev_desc->rawblksz);
 
@@ -605,6 +811,7 @@ int write_gpt_table(struct blk_desc *dev_desc,
 	u32 calc_crc32, sector;
 
 	sector = dev_desc->rawblksz / dev_desc->blksz;
+	gpt_cache_invalidate(dev_desc, 0, 0);
 
 	debug("max lba: %x\n", (u32) dev_desc->rawlba);
 	/* Setup the Protective MBR */
@@ -1190,10 +1397,6 @@ static int is_gpt_valid(struct blk_desc *dev_desc, u64 lba,
 		return 0;
 	}
 
-	/* Re-use pte if it's not NULL */
-	if (*pgpt_pte)
-		return 1;
-
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(legacy_mbr, mbr, 1, dev_desc->rawblksz);
 
 	sector = dev_desc->rawblksz / dev_desc->blksz;
@@ -1335,6 +1538,8 @@ U_BOOT_PART_TYPE(a_efi) = {
 	.part_type	= PART_TYPE_EFI,
 	.max_entries	= GPT_ENTRY_NUMBERS,
 	.get_info	= part_get_info_ptr(part_get_info_efi),
+	.get_info_by_name = part_get_info_ptr(part_get_info_by_name_efi),
+	.get_info_by_uuid = part_get_info_ptr(part_get_info_by_uuid_efi),
 	.print		= part_print_ptr(part_print_efi),
 	.test		= part_test_efi,
 };
@@ -11,6 +11,8 @@
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
+#include <malloc.h>
+#include <memalign.h>
 
 static const char *if_typename_str[IF_TYPE_COUNT] = {
 	[IF_TYPE_IDE]		= "ide",
@@ -458,20 +460,190 @@ int blk_get_device(int if_type, int devnum, struct udevice **devp)
 	return device_probe(*devp);
 }
 
+#ifdef CONFIG_BLK_ASYNC
+/* Retire the queue head, called with blk_lock held */
+static void blk_req_complete(struct blk_desc *block_dev, long ret)
+{
+	struct blk_req *req = block_dev->req_head;
+
+	block_dev->req_head = req->next;
+	if (!block_dev->req_head)
+		block_dev->req_tail = NULL;
+
+	req->next = NULL;
+	req->ret = ret;
+	req->state = BLK_REQ_DONE;
+}
+
+/* Start the queue head unless it is in flight, called with blk_lock held */
+static void blk_req_start(struct blk_desc *block_dev)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	struct blk_req *req;
+	long ret;
+
+	while ((req = block_dev->req_head) && req->state == BLK_REQ_QUEUED) {
+		if (blkcache_read(block_dev->if_type, block_dev->devnum,
+				  req->start, req->blkcnt, block_dev->blksz,
+				  req->buffer)) {
+			blk_req_complete(block_dev, req->blkcnt);
+			continue;
+		}
+
+		ret = -ENOSYS;
+		if (ops->read_submit && ops->read_poll)
+			ret = ops->read_submit(dev, req->start, req->blkcnt,
+					       req->buffer);
+		if (!ret) {
+			req->state = BLK_REQ_ACTIVE;
+			return;
+		}
+
+		if (ret == -ENOSYS)
+			ret = ops->read(dev, req->start, req->blkcnt,
+					req->buffer);
+		if (ret == req->blkcnt)
+			blkcache_fill(block_dev->if_type, block_dev->devnum,
+				      req->start, req->blkcnt,
+				      block_dev->blksz, req->buffer);
+		blk_req_complete(block_dev, ret);
+	}
+}
+
+static void blk_req_advance(struct blk_desc *block_dev)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	struct blk_req *req;
+	long ret;
+
+	u_spin_lock(&block_dev->blk_lock);
+	req = block_dev->req_head;
+	if (req && req->state == BLK_REQ_ACTIVE) {
+		ret = ops->read_poll(dev);
+		if (ret != -EINPROGRESS) {
+			if (ret == req->blkcnt)
+				blkcache_fill(block_dev->if_type,
+					      block_dev->devnum, req->start,
+					      req->blkcnt, block_dev->blksz,
+					      req->buffer);
+			blk_req_complete(block_dev, ret);
+		}
+	}
+	blk_req_start(block_dev);
+	u_spin_unlock(&block_dev->blk_lock);
+}
+
+int blk_dread_submit(struct blk_desc *block_dev, struct blk_req *req,
+		     lbaint_t start, lbaint_t blkcnt, void *buffer)
+{
+	const struct blk_ops *ops = blk_get_ops(block_dev->bdev);
+
+	if (!ops->read)
+		return -ENOSYS;
+
+	req->next = NULL;
+	req->start = start;
+	req->blkcnt = blkcnt;
+	req->buffer = buffer;
+	req->ret = 0;
+	if (!blkcnt) {
+		req->state = BLK_REQ_DONE;
+		return 0;
+	}
+	req->state = BLK_REQ_QUEUED;
+
+	u_spin_lock(&block_dev->blk_lock);
+	if (block_dev->req_tail)
+		block_dev->req_tail->next = req;
+	else
+		block_dev->req_head = req;
+	block_dev->req_tail = req;
+	blk_req_start(block_dev);
+	u_spin_unlock(&block_dev->blk_lock);
+
+	return 0;
+}
+
+bool blk_req_poll(struct blk_desc *block_dev, struct blk_req *req)
+{
+	if (req->state != BLK_REQ_DONE)
+		blk_req_advance(block_dev);
+
+	return req->state == BLK_REQ_DONE;
+}
+
+long blk_req_wait(struct blk_desc *block_dev, struct blk_req *req)
+{
+	while (!blk_req_poll(block_dev, req))
+		;
+
+	return req->ret;
+}
+
+void blk_req_drain(struct blk_desc *block_dev)
+{
+	while (block_dev->req_head)
+		blk_req_advance(block_dev);
+}
+#endif
+
+/*
+ * Read a read-ahead window of @count blocks into the block cache and copy
+ * the @blkcnt requested ones out of it. Returns false if nothing was read.
+ */
+static bool blk_dread_ahead(struct blk_desc *block_dev, lbaint_t start,
+			    lbaint_t count, lbaint_t blkcnt, void *buffer)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong blks_read;
+	void *buf;
+
+	buf = malloc_cache_aligned(count * block_dev->blksz);
+	if (!buf)
+		return false;
+
+	u_spin_lock(&block_dev->blk_lock);
+	blks_read = ops->read(dev, start, count, buf);
+	u_spin_unlock(&block_dev->blk_lock);
+
+	if (blks_read == count) {
+		memcpy(buffer, buf, blkcnt * block_dev->blksz);
+		blkcache_fill(block_dev->if_type, block_dev->devnum,
+			      start, count, block_dev->blksz, buf);
+	}
+	free(buf);
+
+	return blks_read == count;
+}
+
 unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 			lbaint_t blkcnt, void *buffer)
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
+	lbaint_t count;
 	ulong blks_read;
 
 	if (!ops->read)
 		return -ENOSYS;
 
+#ifdef CONFIG_BLK_ASYNC
+	blk_req_drain(block_dev);
+#endif
+
 	if (blkcache_read(block_dev->if_type, block_dev->devnum,
 			  start, blkcnt, block_dev->blksz, buffer))
 		return blkcnt;
 
+	count = blkcache_readahead(block_dev->if_type, block_dev->devnum,
+				   start, blkcnt, block_dev->lba);
+	if (count > blkcnt &&
+	    blk_dread_ahead(block_dev, start, count, blkcnt, buffer))
+		return blkcnt;
+
 	u_spin_lock(&block_dev->blk_lock);
 	blks_read = ops->read(dev, start, blkcnt, buffer);
 	u_spin_unlock(&block_dev->blk_lock);
@@ -493,7 +665,13 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 	if (!ops->write)
 		return -ENOSYS;
 
-	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+#ifdef CONFIG_BLK_ASYNC
+	blk_req_drain(block_dev);
+#endif
+
+	blkcache_invalidate_range(block_dev->if_type, block_dev->devnum,
+				  start, blkcnt);
+	gpt_cache_invalidate(block_dev, start, blkcnt);
 
 	u_spin_lock(&block_dev->blk_lock);
 	ret = ops->write(dev, start, blkcnt, buffer);
@@ -512,7 +690,13 @@ unsigned long blk_dwrite_zeroes(struct blk_desc *block_dev, lbaint_t start,
 	if (!ops->write_zeroes)
 		return -ENOSYS;
 
-	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+#ifdef CONFIG_BLK_ASYNC
+	blk_req_drain(block_dev);
+#endif
+
+	blkcache_invalidate_range(block_dev->if_type, block_dev->devnum,
+				  start, blkcnt);
+	gpt_cache_invalidate(block_dev, start, blkcnt);
 
 	u_spin_lock(&block_dev->blk_lock);
 	ret = ops->write_zeroes(dev, start, blkcnt);
@@ -531,7 +715,13 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 	if (!ops->erase)
 		return -ENOSYS;
 
-	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+#ifdef CONFIG_BLK_ASYNC
+	blk_req_drain(block_dev);
+#endif
+
+	blkcache_invalidate_range(block_dev->if_type, block_dev->devnum,
+				  start, blkcnt);
+	gpt_cache_invalidate(block_dev, start, blkcnt);
 
 	u_spin_lock(&block_dev->blk_lock);
 	ret = ops->erase(dev, start, blkcnt);
@@ -540,6 +730,17 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 	return ret;
 }
 
+void *blk_dmap(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+
+	if (!ops->map)
+		return NULL;
+
+	return ops->map(dev, start, blkcnt);
+}
+
 int blk_prepare_device(struct udevice *dev)
 {
 	struct blk_desc *desc = dev_get_uclass_platdata(dev);
@@ -11,44 +11,111 @@
 #include <part.h>
 #include <linux/ctype.h>
 #include <linux/list.h>
+#include <linux/log2.h>
+
+/*
+ * Entries are kept in LRU order and hashed by device and by the granule
+ * their first block is in. A granule is at least as large as the largest
+ * entry, so an entry holding a block starts in the granule of that block
+ * or in the one before.
+ */
+#define BLKCACHE_HASH_BITS	6
+#define BLKCACHE_STREAMS	4
+
+#ifdef CONFIG_BLOCK_CACHE_READAHEAD
+#define BLKCACHE_RA_BLOCKS	CONFIG_BLOCK_CACHE_READAHEAD_BLOCKS
+#else
+#define BLKCACHE_RA_BLOCKS	0
+#endif
 
 struct block_cache_node {
 	struct list_head lh;
+	struct hlist_node hash;
 	int iftype;
 	int devnum;
 	lbaint_t start;
 	lbaint_t blkcnt;
 	unsigned long blksz;
+	lbaint_t bytes;		/* size of the cache buffer */
 	char *cache;
 };
 
+/* A sequential reader, see blkcache_readahead() */
+struct block_cache_stream {
+	int iftype;
+	int devnum;
+	lbaint_t next;		/* block the next sequential read starts at */
+	lbaint_t ra_start;	/* window handed out, 0 blocks if none */
+	lbaint_t ra_blkcnt;
+};
+
 static LIST_HEAD(block_cache);
+static struct hlist_head block_cache_hash[1 << BLKCACHE_HASH_BITS];
+static struct block_cache_stream streams[BLKCACHE_STREAMS];
+static int stream_next;
 
 static struct block_cache_stats _stats = {
-	.max_blocks_per_entry = 2,
-	.max_entries = 32
+	.max_blocks_per_entry = CONFIG_BLOCK_CACHE_BLOCKS,
+	.max_entries = CONFIG_BLOCK_CACHE_ENTRIES,
 };
 
+static int cache_granule_shift(void)
+{
+	unsigned long blocks = max(_stats.max_blocks_per_entry,
+				   (unsigned)BLKCACHE_RA_BLOCKS);
+
+	return blocks > 1 ? ilog2(roundup_pow_of_two(blocks)) : 0;
+}
+
+static struct hlist_head *cache_bucket(int iftype, int devnum,
+				       lbaint_t granule)
+{
+	u32 hash = (u32)granule ^ ((u64)granule >> 32);
+
+	hash ^= (iftype << 24) ^ (devnum << 16);
+	hash *= 0x9e3779b1;
+
+	return &block_cache_hash[hash >> (32 - BLKCACHE_HASH_BITS)];
+}
+
+static void cache_drop(struct block_cache_node *node)
+{
+	list_del(&node->lh);
+	hlist_del(&node->hash);
+	free(node->cache);
+	free(node);
+	_stats.entries--;
+}
+
 static struct block_cache_node *cache_find(int iftype, int devnum,
 					   lbaint_t start, lbaint_t blkcnt,
 					   unsigned long blksz)
 {
+	lbaint_t granule = start >> cache_granule_shift();
 	struct block_cache_node *node;
+	struct hlist_node *pos;
+	int i;
 
-	list_for_each_entry(node, &block_cache, lh)
-		if ((node->iftype == iftype) &&
-		    (node->devnum == devnum) &&
-		    (node->blksz == blksz) &&
-		    (node->start <= start) &&
-		    (node->start + node->blkcnt >= start + blkcnt)) {
-			if (block_cache.next != &node->lh) {
-				/* maintain MRU ordering */
-				list_del(&node->lh);
-				list_add(&node->lh, &block_cache);
+	for (i = 0; i < 2 && i <= granule; i++) {
+		hlist_for_each_entry(node, pos,
+				     cache_bucket(iftype, devnum, granule - i),
+				     hash) {
+			if ((node->iftype == iftype) &&
+			    (node->devnum == devnum) &&
+			    (node->blksz == blksz) &&
+			    (node->start <= start) &&
+			    (node->start + node->blkcnt >= start + blkcnt)) {
+				if (block_cache.next != &node->lh) {
+					/* maintain MRU ordering */
+					list_del(&node->lh);
+					list_add(&node->lh, &block_cache);
+				}
+				return node;
 			}
-			return node;
 		}
-	return 0;
+	}
+
+	return NULL;
 }
 
 int blkcache_read(int iftype, int devnum,
@@ -72,6 +139,69 @@ int blkcache_read(int iftype, int devnum,
 	return 0;
 }
 
+static struct block_cache_stream *stream_find(int iftype, int devnum,
+					      lbaint_t start)
+{
+	struct block_cache_stream *s;
+
+	for (s = streams; s < streams + BLKCACHE_STREAMS; s++) {
+		if (s->next && s->iftype == iftype && s->devnum == devnum &&
+		    s->next == start)
+			return s;
+	}
+
+	return NULL;
+}
+
+lbaint_t blkcache_readahead(int iftype, int devnum,
+			    lbaint_t start, lbaint_t blkcnt, lbaint_t lba)
+{
+	struct block_cache_stream *s;
+	lbaint_t count = blkcnt;
+
+	if (!BLKCACHE_RA_BLOCKS || !_stats.max_entries)
+		return blkcnt;
+
+	/* Read ahead once a read continues where the last miss ended */
+	s = stream_find(iftype, devnum, start);
+	if (s) {
+		count = min_t(lbaint_t, BLKCACHE_RA_BLOCKS, lba - start);
+		if (count > blkcnt)
+			_stats.readaheads++;
+		else
+			count = blkcnt;
+	} else {
+		s = &streams[stream_next];
+		stream_next = (stream_next + 1) % BLKCACHE_STREAMS;
+		s->iftype = iftype;
+		s->devnum = devnum;
+	}
+
+	s->next = start + count;
+	s->ra_start = start;
+	s->ra_blkcnt = count > blkcnt ? count : 0;
+
+	return count;
+}
+
+/* Read-ahead windows are cached even when larger than an entry */
+static bool cache_is_readahead(int iftype, int devnum,
+			       lbaint_t start, lbaint_t blkcnt)
+{
+	struct block_cache_stream *s;
+
+	for (s = streams; s < streams + BLKCACHE_STREAMS; s++) {
+		if (s->iftype == iftype && s->devnum == devnum &&
+		    s->ra_blkcnt && s->ra_start == start &&
+		    s->ra_blkcnt == blkcnt) {
+			s->ra_blkcnt = 0;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void blkcache_fill(int iftype, int devnum,
 		   lbaint_t start, lbaint_t blkcnt,
 		   unsigned long blksz, void const *buffer)
@@ -80,7 +210,8 @@ void blkcache_fill(int iftype, int devnum,
 	struct block_cache_node *node;
 
 	/* don't cache big stuff */
-	if (blkcnt > _stats.max_blocks_per_entry)
+	if (blkcnt > _stats.max_blocks_per_entry &&
+	    !cache_is_readahead(iftype, devnum, start, blkcnt))
 		return;
 
 	if (_stats.max_entries == 0)
@@ -91,10 +222,11 @@ void blkcache_fill(int iftype, int devnum,
 		/* pop LRU */
 		node = (struct block_cache_node *)block_cache.prev;
 		list_del(&node->lh);
+		hlist_del(&node->hash);
 		_stats.entries--;
 		debug("drop: start " LBAF ", count " LBAFU "\n",
 		      node->start, node->blkcnt);
-		if (node->blkcnt * node->blksz < bytes) {
+		if (node->bytes < bytes) {
 			free(node->cache);
 			node->cache = 0;
 		}
@@ -111,6 +243,7 @@ void blkcache_fill(int iftype, int devnum,
 			free(node);
 			return;
 		}
+		node->bytes = bytes;
 	}
 
 	debug("fill: start " LBAF ", count " LBAFU "\n",
@@ -123,23 +256,34 @@ void blkcache_fill(int iftype, int devnum,
 	node->blksz = blksz;
 	memcpy(node->cache, buffer, bytes);
 	list_add(&node->lh, &block_cache);
+	hlist_add_head(&node->hash,
+		       cache_bucket(iftype, devnum,
+				    start >> cache_granule_shift()));
 	_stats.entries++;
 }
 
+void blkcache_invalidate_range(int iftype, int devnum,
+			       lbaint_t start, lbaint_t blkcnt)
+{
+	struct block_cache_node *node, *n;
+
+	list_for_each_entry_safe(node, n, &block_cache, lh) {
+		if ((node->iftype == iftype) &&
+		    (node->devnum == devnum) &&
+		    (node->start < start + blkcnt) &&
+		    (node->start + node->blkcnt > start))
+			cache_drop(node);
+	}
+}
+
 void blkcache_invalidate(int iftype, int devnum)
 {
-	struct list_head *entry, *n;
-	struct block_cache_node *node;
+	struct block_cache_node *node, *n;
 
-	list_for_each_safe(entry, n, &block_cache) {
-		node = (struct block_cache_node *)entry;
+	list_for_each_entry_safe(node, n, &block_cache, lh) {
 		if ((node->iftype == iftype) &&
-		    (node->devnum == devnum)) {
-			list_del(entry);
-			free(node->cache);
-			free(node);
-			--_stats.entries;
-		}
+		    (node->devnum == devnum))
+			cache_drop(node);
 	}
 }
 
@@ -148,12 +292,10 @@ void blkcache_configure(unsigned blocks, unsigned entries)
 	struct block_cache_node *node;
 	if ((blocks != _stats.max_blocks_per_entry) ||
 	    (entries != _stats.max_entries)) {
-		/* invalidate cache */
+		/* invalidate cache, the granule may change */
 		while (!list_empty(&block_cache)) {
 			node = (struct block_cache_node *)block_cache.next;
-			list_del(&node->lh);
-			free(node->cache);
-			free(node);
+			cache_drop(node);
 		}
 		_stats.entries = 0;
 	}
@@ -163,6 +305,7 @@ void blkcache_configure(unsigned blocks, unsigned entries)
 
 	_stats.hits = 0;
 	_stats.misses = 0;
+	_stats.readaheads = 0;
 }
 
 void blkcache_stats(struct block_cache_stats *stats)
@@ -170,4 +313,5 @@ void blkcache_stats(struct block_cache_stats *stats)
 	memcpy(stats, &_stats, sizeof(*stats));
 	_stats.hits = 0;
 	_stats.misses = 0;
+	_stats.readaheads = 0;
 }
@@ -0,0 +1,151 @@
+/*
+ * Deferred device probe
+ *
+ * Copyright (C) 2025 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <malloc.h>
+#include <dm/device-internal.h>
+#include <dm/root.h>
+#include <dm/util.h>
+#include <linux/list.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	DEFER_QUEUED,		/* not probed yet */
+	DEFER_ON_USE,		/* probed when it was first used */
+	DEFER_IDLE,		/* probed by dm_probe_deferred() */
+	DEFER_FAILED,		/* dm_probe_deferred() failed to probe it */
+};
+
+/*
+ * Devices stay on this list once their probe was deferred, so that
+ * 'dm deferred' can tell how each of them got probed in the end. Probing
+ * is not reentrant, so this is all done on the boot cpu.
+ */
+struct dm_deferred {
+	struct list_head node;
+	struct udevice *dev;
+	int state;
+};
+
+static LIST_HEAD(deferred_head);
+static bool deferred_idle;
+
+static struct dm_deferred *dm_deferred_find(struct udevice *dev)
+{
+	struct dm_deferred *d;
+
+	list_for_each_entry(d, &deferred_head, node) {
+		if (d->dev == dev)
+			return d;
+	}
+
+	return NULL;
+}
+
+int device_probe_defer(struct udevice *dev)
+{
+	struct dm_deferred *d;
+
+	if (device_active(dev) || (dev->flags & DM_FLAG_DEFERRED))
+		return 0;
+
+	/* The list is in .data, which is read-only before relocation */
+	if (!(dev->driver->flags & DM_FLAG_PROBE_DEFER) ||
+	    !(gd->flags & GD_FLG_RELOC) || !env_get_yesno("dm_defer"))
+		return device_probe(dev);
+
+	d = calloc(1, sizeof(*d));
+	if (!d)
+		return device_probe(dev);
+
+	d->dev = dev;
+	d->state = DEFER_QUEUED;
+	list_add_tail(&d->node, &deferred_head);
+	dev->flags |= DM_FLAG_DEFERRED;
+	debug("%s: %s\n", __func__, dev->name);
+
+	return 0;
+}
+
+void device_deferred_probed(struct udevice *dev)
+{
+	struct dm_deferred *d = dm_deferred_find(dev);
+
+	if (d && d->state == DEFER_QUEUED)
+		d->state = deferred_idle ? DEFER_IDLE : DEFER_ON_USE;
+}
+
+void device_deferred_unbind(struct udevice *dev)
+{
+	struct dm_deferred *d = dm_deferred_find(dev);
+
+	if (d) {
+		list_del(&d->node);
+		free(d);
+	}
+	dev->flags &= ~DM_FLAG_DEFERRED;
+}
+
+int dm_probe_deferred(int max)
+{
+	struct dm_deferred *d;
+	int count = 0;
+
+	list_for_each_entry(d, &deferred_head, node) {
+		if (d->state != DEFER_QUEUED)
+			continue;
+		if (max > 0 && count == max)
+			break;
+
+		deferred_idle = true;
+		if (device_probe(d->dev)) {
+			printf("%s: failed to probe %s\n", __func__,
+			       d->dev->name);
+			d->state = DEFER_FAILED;
+		}
+		deferred_idle = false;
+		count++;
+	}
+
+	return count;
+}
+
+void dm_report_deferred(void)
+{
+	struct dm_deferred *d;
+	int count = 0;
+
+	list_for_each_entry(d, &deferred_head, node) {
+		if (d->state != DEFER_QUEUED)
+			continue;
+		printf("%s %s", count ? "," : "Deferred probe skipped:",
+		       d->dev->name);
+		count++;
+	}
+	if (count)
+		printf("\n");
+}
+
+void dm_dump_deferred(void)
+{
+	static const char *const states[] = {
+		[DEFER_QUEUED]	= "not probed",
+		[DEFER_ON_USE]	= "on use",
+		[DEFER_IDLE]	= "while idle",
+		[DEFER_FAILED]	= "failed",
+	};
+	struct dm_deferred *d;
+
+	printf(" %-10.10s %-20.20s %s\n", "Uclass", "Device", "Probed");
+	list_for_each_entry(d, &deferred_head, node) {
+		printf(" %-10.10s %-20.20s %s\n", d->dev->uclass->uc_drv->name,
+		       d->dev->name, states[d->state]);
+	}
+}
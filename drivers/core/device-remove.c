@@ -111,6 +111,9 @@ int device_unbind(struct udevice *dev)
 	if (dev->parent)
 		list_del(&dev->sibling_node);
 
+	if (dev->flags & DM_FLAG_DEFERRED)
+		device_deferred_unbind(dev);
+
 	devres_release_all(dev);
 
 	if (dev->flags & DM_FLAG_NAME_ALLOCED)
@@ -18,6 +18,7 @@
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/lookup.h>
 #include <dm/of_access.h>
 #include <dm/pinctrl.h>
 #include <dm/platdata.h>
@@ -30,6 +31,98 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#ifdef CONFIG_USING_KERNEL_DTB_V2
+/*
+ * Put these U-Boot devices in the head of uclass device list for
+ * the primary get by uclass_get_device_xxx().
+ *
+ * device-list: U0, U1, U2, ... K0, K1, K2, ... (prior u-boot dev)
+ * device-list: K0, K1, K2, ... U0, U1, U2, ... (normal)
+ *
+ * U: u-boot dev
+ * K: kernel dev
+ */
+static bool device_u_boot_prior(enum uclass_id id)
+{
+	static const u32 prior_u_boot_uclass_id[] = {
+		UCLASS_AHCI,		/* boot device */
+		UCLASS_BLK,
+		UCLASS_MMC,
+		UCLASS_MTD,
+		UCLASS_PCI,
+		UCLASS_RKNAND,
+		UCLASS_SPI_FLASH,
+
+		UCLASS_CRYPTO,		/* RSA security */
+		UCLASS_FIRMWARE,	/* psci sysreset */
+		UCLASS_RNG,		/* ramdom number */
+		UCLASS_SYSCON,		/* grf, pmugrf */
+		UCLASS_SYSRESET,	/* psci sysreset */
+		UCLASS_WDT,		/* reliable sysreset */
+	};
+	u32 i;
+
+	for (i = 0; i < ARRAY_SIZE(prior_u_boot_uclass_id); i++) {
+		if (id == prior_u_boot_uclass_id[i])
+			return true;
+	}
+
+	return false;
+}
+
+static bool device_prop_equal(ofnode a, ofnode b, const char *propname)
+{
+	const void *pa, *pb;
+	int la, lb;
+
+	pa = ofnode_get_property(a, propname, &la);
+	pb = ofnode_get_property(b, propname, &lb);
+	if (!pa || !pb)
+		return pa == pb;
+
+	return la == lb && !memcmp(pa, pb, la);
+}
+
+bool device_match_kernel_node(ofnode node)
+{
+	struct udevice *dev;
+	struct uclass *uc;
+	ofnode subnode;
+
+	if (!ofnode_get_property(node, "compatible", NULL))
+		return false;
+
+	ofnode_for_each_subnode(subnode, node) {
+		if (ofnode_get_property(subnode, "compatible", NULL))
+			return false;
+	}
+
+	/* Kernel devices of the other uclasses are used first */
+	list_for_each_entry(uc, &gd->uclass_root, sibling_node) {
+		if (!device_u_boot_prior(uc->uc_drv->id))
+			continue;
+
+		list_for_each_entry(dev, &uc->dev_head, uclass_node) {
+			if ((dev->flags & DM_FLAG_KNRL_DTB) ||
+			    !dev_has_of_node(dev) ||
+			    ofnode_valid(dev->kernel_node))
+				continue;
+
+			if (device_prop_equal(dev->node, node, "compatible") &&
+			    device_prop_equal(dev->node, node, "reg")) {
+				debug("%s: %s matches kernel node %s\n",
+				      __func__, dev->name, ofnode_get_name(node));
+				dev->kernel_node = node;
+				dm_lookup_invalidate();
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+#endif
+
 static int device_bind_common(struct udevice *parent, const struct driver *drv,
 			      const char *name, void *platdata,
 			      ulong driver_data, ofnode node,
@@ -78,6 +171,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 					 * this. Maybe removed in the future.
 					 */
 					dev->node = node;
+					dm_lookup_invalidate();
 					return 0;
 				}
 			}
@@ -99,6 +193,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 					return 0;
 				} else {
 					list_del_init(&dev->uclass_node);
+					dm_lookup_invalidate();
 				}
 			}
 		}
@@ -197,44 +292,11 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 
 #ifdef CONFIG_USING_KERNEL_DTB
 #ifdef CONFIG_USING_KERNEL_DTB_V2
-	/*
-	 * Put these U-Boot devices in the head of uclass device list for
-	 * the primary get by uclass_get_device_xxx().
-	 *
-	 * device-list: U0, U1, U2, ... K0, K1, K2, ... (prior u-boot dev)
-	 * device-list: K0, K1, K2, ... U0, U1, U2, ... (normal)
-	 *
-	 * U: u-boot dev
-	 * K: kernel dev
-	 */
-	u32 i, prior_u_boot_uclass_id[] = {
-		UCLASS_AHCI,		/* boot device */
-		UCLASS_BLK,
-		UCLASS_MMC,
-		UCLASS_MTD,
-		UCLASS_PCI,
-		UCLASS_RKNAND,
-		UCLASS_SPI_FLASH,
-
-		UCLASS_CRYPTO,		/* RSA security */
-		UCLASS_FIRMWARE,	/* psci sysreset */
-		UCLASS_RNG,		/* ramdom number */
-		UCLASS_SYSCON,		/* grf, pmugrf */
-		UCLASS_SYSRESET,	/* psci sysreset */
-		UCLASS_WDT,		/* reliable sysreset */
-	};
-
+	dev->kernel_node = ofnode_null();
 	if (gd->flags & GD_FLG_KDTB_READY) {
-		after_u_boot_dev = false;
+		after_u_boot_dev = device_u_boot_prior(drv->id);
 		dev->flags |= DM_FLAG_KNRL_DTB;
 
-		for (i = 0; i < ARRAY_SIZE(prior_u_boot_uclass_id); i++) {
-			if (drv->id == prior_u_boot_uclass_id[i]) {
-				after_u_boot_dev = true;
-				break;
-			}
-		}
-
 		/* no u-boot dev ? */
 		if (!dev->uclass->u_boot_dev_head)
 			dev->uclass->u_boot_dev_head = &uc->dev_head;
@@ -274,6 +336,8 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		*devp = dev;
 
 	dev->flags |= DM_FLAG_BOUND;
+	/* bind() methods may have moved the device to another node */
+	dm_lookup_invalidate();
 
 	return 0;
 
@@ -515,6 +579,9 @@ int device_probe(struct udevice *dev)
 		pinctrl_select_state(dev, "default");
 	}
 
+	if (dev->flags & DM_FLAG_DEFERRED)
+		device_deferred_probed(dev);
+
 	return 0;
 fail_uclass:
 	if (device_remove(dev, DM_REMOVE_NORMAL)) {
@@ -700,11 +767,28 @@ static struct udevice *_device_find_global_by_of_offset(struct udevice *parent,
 	return NULL;
 }
 
+bool dev_has_phandle(struct udevice *dev, uint phandle)
+{
+	if (dev_read_phandle(dev) == phandle)
+		return true;
+#ifdef CONFIG_USING_KERNEL_DTB_V2
+	if (ofnode_valid(dev->kernel_node) &&
+	    ofnode_to_np(dev->kernel_node)->phandle == phandle)
+		return true;
+#endif
+
+	return false;
+}
+
 int device_get_global_by_of_offset(int of_offset, struct udevice **devp)
 {
 	struct udevice *dev;
 
-	dev = _device_find_global_by_of_offset(gd->dm_root, of_offset);
+	if (!dm_lookup_find(DM_LOOKUP_GLOBAL, 0, of_offset, NULL, &dev)) {
+		dev = _device_find_global_by_of_offset(gd->dm_root, of_offset);
+		dm_lookup_add(DM_LOOKUP_GLOBAL, 0, of_offset, NULL, dev);
+	}
+
 	return device_get_device_tail(dev, dev ? 0 : -ENOENT, devp);
 }
 
@@ -806,6 +890,7 @@ int device_set_name(struct udevice *dev, const char *name)
 		return -ENOMEM;
 	dev->name = name;
 	device_set_name_alloced(dev);
+	dm_lookup_invalidate();
 
 	return 0;
 }
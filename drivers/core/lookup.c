@@ -0,0 +1,258 @@
+/*
+ * Device lookup cache
+ *
+ * Copyright (C) 2025 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <dm/lookup.h>
+#include <dm/read.h>
+#include <dm/util.h>
+#include <linux/log2.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/*
+ * Searches walk a uclass list (or the whole device tree) and return the
+ * first match, so the result depends on list order: with the kernel DTB
+ * U-Boot devices are inserted in front of kernel ones and both trees may
+ * use the same node offsets. Rather than index every device at bind time,
+ * cache search results in a direct-mapped table and drop them all whenever
+ * anything a search depends on changes, by bumping lookup_gen.
+ *
+ * The table lives in BSS, so it is only used after relocation.
+ */
+#define DM_LOOKUP_ENTRIES	CONFIG_DM_LOOKUP_CACHE_ENTRIES
+#define DM_LOOKUP_HASH_BITS	ilog2(DM_LOOKUP_ENTRIES)
+#define DM_LOOKUP_NAME_LEN	24	/* longer names are not cached */
+
+struct dm_lookup_entry {
+	struct udevice *dev;	/* NULL if the search found nothing */
+	ulong key;
+	u32 gen;
+	s16 id;
+	u8 type;
+	char name[DM_LOOKUP_NAME_LEN];
+};
+
+struct dm_lookup_stats {
+	ulong lookups;
+	ulong hits;
+	ulong us;		/* time spent, with DM_LOOKUP_STATS */
+};
+
+static struct dm_lookup_entry lookup_cache[DM_LOOKUP_ENTRIES];
+static struct dm_lookup_stats lookup_stats[DM_LOOKUP_COUNT];
+static ulong lookup_flushes;
+static u32 lookup_gen;
+
+/* What the cached results were found in */
+static struct {
+	struct udevice *dm_root;
+	const void *fdt_blob;
+#ifdef CONFIG_OF_LIVE
+	struct device_node *of_root;
+#endif
+} lookup_snap;
+
+#if CONFIG_IS_ENABLED(DM_LOOKUP_STATS)
+static ulong lookup_start[DM_LOOKUP_COUNT];
+
+static ulong dm_lookup_time(void)
+{
+#if CONFIG_IS_ENABLED(TIMER)
+	/* Starting the timer looks up devices itself */
+	if (!gd->timer)
+		return 0;
+#endif
+	return timer_get_us();
+}
+#else
+static inline ulong dm_lookup_time(void)
+{
+	return 0;
+}
+#endif
+
+static bool dm_lookup_active(void)
+{
+	return gd->flags & GD_FLG_RELOC;
+}
+
+void dm_lookup_invalidate(void)
+{
+	if (!dm_lookup_active())
+		return;
+
+	/* Entries from a wrapped generation must not come back to life */
+	if (!++lookup_gen) {
+		memset(lookup_cache, '\0', sizeof(lookup_cache));
+		lookup_gen = 1;
+	}
+	lookup_flushes++;
+}
+
+/* Drop everything if the device tree or control FDT were replaced */
+static void dm_lookup_check_snap(void)
+{
+	bool same = lookup_snap.dm_root == gd->dm_root &&
+		    lookup_snap.fdt_blob == gd->fdt_blob;
+
+#ifdef CONFIG_OF_LIVE
+	same = same && lookup_snap.of_root == gd->of_root;
+	lookup_snap.of_root = gd->of_root;
+#endif
+	if (same && lookup_gen)
+		return;
+
+	lookup_snap.dm_root = gd->dm_root;
+	lookup_snap.fdt_blob = gd->fdt_blob;
+	dm_lookup_invalidate();
+}
+
+static struct dm_lookup_entry *dm_lookup_slot(enum dm_lookup_type type,
+					      int id, ulong key,
+					      const char *name)
+{
+	u32 hash = (u32)key ^ (u32)((u64)key >> 32);
+
+	if (name) {
+		hash = 0;
+		while (*name)
+			hash = hash * 31 + *name++;
+	}
+	hash ^= (type << 24) ^ (id << 12);
+	hash *= 0x9e3779b1;
+
+	return &lookup_cache[hash >> (32 - DM_LOOKUP_HASH_BITS)];
+}
+
+/* Check that @dev is still what the search would find first */
+static bool dm_lookup_valid(struct dm_lookup_entry *e, const char *name)
+{
+	struct udevice *dev = e->dev;
+	ofnode node;
+
+	if (!dev)
+		return true;
+
+	if (e->type != DM_LOOKUP_GLOBAL &&
+	    dev->uclass->uc_drv->id != e->id)
+		return false;
+
+	switch (e->type) {
+	case DM_LOOKUP_OFNODE:
+		node.of_offset = e->key;
+		return dev_ofnode_equal(dev, node);
+	case DM_LOOKUP_OF_OFFSET:
+	case DM_LOOKUP_GLOBAL:
+		return dev_of_offset(dev) == (int)e->key;
+#if CONFIG_IS_ENABLED(OF_CONTROL)
+	case DM_LOOKUP_PHANDLE:
+		return dev_has_phandle(dev, e->key);
+#endif
+	case DM_LOOKUP_NAME:
+		return !strncmp(dev->name, name, strlen(name));
+	default:
+		return false;
+	}
+}
+
+bool dm_lookup_find(enum dm_lookup_type type, int id, ulong key,
+		    const char *name, struct udevice **devp)
+{
+	struct dm_lookup_stats *stats = &lookup_stats[type];
+	struct dm_lookup_entry *e;
+	ulong start;
+
+	if (!dm_lookup_active())
+		return false;
+
+	start = dm_lookup_time();
+	stats->lookups++;
+	dm_lookup_check_snap();
+
+	if (name && strlen(name) >= DM_LOOKUP_NAME_LEN)
+		goto miss;
+
+	e = dm_lookup_slot(type, id, key, name);
+	if (e->gen != lookup_gen || e->type != type || e->id != id)
+		goto miss;
+	if (name ? strcmp(e->name, name) : e->key != key)
+		goto miss;
+	if (!dm_lookup_valid(e, name))
+		goto miss;
+
+	*devp = e->dev;
+	stats->hits++;
+	stats->us += dm_lookup_time() - start;
+
+	return true;
+miss:
+#if CONFIG_IS_ENABLED(DM_LOOKUP_STATS)
+	lookup_start[type] = start;
+#endif
+	return false;
+}
+
+void dm_lookup_add(enum dm_lookup_type type, int id, ulong key,
+		   const char *name, struct udevice *dev)
+{
+	struct dm_lookup_entry *e;
+
+	if (!dm_lookup_active())
+		return;
+
+#if CONFIG_IS_ENABLED(DM_LOOKUP_STATS)
+	lookup_stats[type].us += dm_lookup_time() - lookup_start[type];
+#endif
+	if (name && strlen(name) >= DM_LOOKUP_NAME_LEN)
+		return;
+
+	e = dm_lookup_slot(type, id, key, name);
+	e->dev = dev;
+	e->key = key;
+	e->gen = lookup_gen;
+	e->id = id;
+	e->type = type;
+	if (name)
+		strcpy(e->name, name);
+}
+
+static const char *const lookup_names[DM_LOOKUP_COUNT] = {
+	[DM_LOOKUP_OFNODE]	= "ofnode",
+	[DM_LOOKUP_OF_OFFSET]	= "of_offset",
+	[DM_LOOKUP_PHANDLE]	= "phandle",
+	[DM_LOOKUP_NAME]	= "name",
+	[DM_LOOKUP_GLOBAL]	= "global",
+};
+
+void dm_dump_lookup_stats(void)
+{
+	struct dm_lookup_stats *stats;
+	ulong lookups = 0, hits = 0, us = 0;
+	int i;
+
+	printf("Lookup cache: %d entries, %lu flushes\n", DM_LOOKUP_ENTRIES,
+	       lookup_flushes);
+	printf(" %-10s %10s %10s %10s\n", "Lookup", "Calls", "Hits",
+	       CONFIG_IS_ENABLED(DM_LOOKUP_STATS) ? "Time (us)" : "");
+	for (i = 0; i < DM_LOOKUP_COUNT; i++) {
+		stats = &lookup_stats[i];
+		printf(" %-10s %10lu %10lu", lookup_names[i], stats->lookups,
+		       stats->hits);
+		if (CONFIG_IS_ENABLED(DM_LOOKUP_STATS))
+			printf(" %10lu", stats->us);
+		printf("\n");
+		lookups += stats->lookups;
+		hits += stats->hits;
+		us += stats->us;
+	}
+	printf(" %-10s %10lu %10lu", "total", lookups, hits);
+	if (CONFIG_IS_ENABLED(DM_LOOKUP_STATS))
+		printf(" %10lu", us);
+	printf("\n");
+}
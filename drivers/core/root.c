@@ -15,6 +15,7 @@
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/lookup.h>
 #include <dm/of.h>
 #include <dm/of_access.h>
 #include <dm/platdata.h>
@@ -177,6 +178,7 @@ int dm_init(bool of_live)
 #endif
 		DM_ROOT_NON_CONST->node = offset_to_ofnode(0);
 #endif
+	dm_lookup_invalidate();
 	ret = device_probe(DM_ROOT_NON_CONST);
 	if (ret)
 		return ret;
@@ -231,6 +233,10 @@ static int dm_scan_fdt_live(struct udevice *parent,
 			pr_debug("   - ignoring disabled device\n");
 			continue;
 		}
+		/* Nothing to bind if a U-Boot device stands for it */
+		if ((gd->flags & GD_FLG_KDTB_READY) &&
+		    device_match_kernel_node(np_to_ofnode(np)))
+			continue;
 		err = lists_bind_fdt(parent, np_to_ofnode(np), NULL);
 		if (err && !ret) {
 			ret = err;
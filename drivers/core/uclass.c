@@ -14,6 +14,7 @@
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/lookup.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
@@ -241,16 +242,20 @@ int uclass_find_device_by_name(enum uclass_id id, const char *name,
 	*devp = NULL;
 	if (!name)
 		return -EINVAL;
+	if (dm_lookup_find(DM_LOOKUP_NAME, id, 0, name, devp))
+		return *devp ? 0 : -ENODEV;
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
 
 	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
 		if (!strncmp(dev->name, name, strlen(name))) {
+			dm_lookup_add(DM_LOOKUP_NAME, id, 0, name, dev);
 			*devp = dev;
 			return 0;
 		}
 	}
+	dm_lookup_add(DM_LOOKUP_NAME, id, 0, name, NULL);
 
 	return -ENODEV;
 }
@@ -294,16 +299,20 @@ int uclass_find_device_by_of_offset(enum uclass_id id, int node,
 	*devp = NULL;
 	if (node < 0)
 		return -ENODEV;
+	if (dm_lookup_find(DM_LOOKUP_OF_OFFSET, id, node, NULL, devp))
+		return *devp ? 0 : -ENODEV;
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
 
 	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
 		if (dev_of_offset(dev) == node) {
+			dm_lookup_add(DM_LOOKUP_OF_OFFSET, id, node, NULL, dev);
 			*devp = dev;
 			return 0;
 		}
 	}
+	dm_lookup_add(DM_LOOKUP_OF_OFFSET, id, node, NULL, NULL);
 
 	return -ENODEV;
 }
@@ -318,16 +327,21 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	*devp = NULL;
 	if (!ofnode_valid(node))
 		return -ENODEV;
+	if (dm_lookup_find(DM_LOOKUP_OFNODE, id, node.of_offset, NULL, devp))
+		return *devp ? 0 : -ENODEV;
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
 
 	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
-		if (ofnode_equal(dev_ofnode(dev), node)) {
+		if (dev_ofnode_equal(dev, node)) {
+			dm_lookup_add(DM_LOOKUP_OFNODE, id, node.of_offset,
+				      NULL, dev);
 			*devp = dev;
 			return 0;
 		}
 	}
+	dm_lookup_add(DM_LOOKUP_OFNODE, id, node.of_offset, NULL, NULL);
 
 	return -ENODEV;
 }
@@ -347,20 +361,21 @@ static int uclass_find_device_by_phandle(enum uclass_id id,
 	find_phandle = dev_read_u32_default(parent, name, -1);
 	if (find_phandle <= 0)
 		return -ENOENT;
+	if (dm_lookup_find(DM_LOOKUP_PHANDLE, id, find_phandle, NULL, devp))
+		return *devp ? 0 : -ENODEV;
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
 
 	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
-		uint phandle;
-
-		phandle = dev_read_phandle(dev);
-
-		if (phandle == find_phandle) {
+		if (dev_has_phandle(dev, find_phandle)) {
+			dm_lookup_add(DM_LOOKUP_PHANDLE, id, find_phandle,
+				      NULL, dev);
 			*devp = dev;
 			return 0;
 		}
 	}
+	dm_lookup_add(DM_LOOKUP_PHANDLE, id, find_phandle, NULL, NULL);
 
 	return -ENODEV;
 }
@@ -471,22 +486,22 @@ int uclass_get_device_by_phandle_id(enum uclass_id id, uint phandle_id,
 	int ret;
 
 	*devp = NULL;
+	if (dm_lookup_find(DM_LOOKUP_PHANDLE, id, phandle_id, NULL, &dev))
+		return uclass_get_device_tail(dev, dev ? 0 : -ENODEV, devp);
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
 
 	ret = -ENODEV;
 	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
-		uint phandle;
-
-		phandle = dev_read_phandle(dev);
-
-		if (phandle == phandle_id) {
+		if (dev_has_phandle(dev, phandle_id)) {
 			*devp = dev;
 			ret = 0;
 			break;
 		}
 	}
+	dm_lookup_add(DM_LOOKUP_PHANDLE, id, phandle_id, NULL,
+		      ret ? NULL : dev);
 
 	return uclass_get_device_tail(dev, ret, devp);
 }
@@ -616,6 +631,7 @@ int uclass_bind_device(struct udevice *dev, bool after_u_boot_dev)
 #else
 	list_add_tail(&dev->uclass_node, &uc->dev_head);
 #endif
+	dm_lookup_invalidate();
 	if (dev->parent) {
 		struct uclass_driver *uc_drv = dev->parent->uclass->uc_drv;
 
@@ -630,6 +646,7 @@ int uclass_bind_device(struct udevice *dev, bool after_u_boot_dev)
 err:
 	/* There is no need to undo the parent's post_bind call */
 	list_del(&dev->uclass_node);
+	dm_lookup_invalidate();
 
 	return ret;
 }
@@ -648,6 +665,7 @@ int uclass_unbind_device(struct udevice *dev)
 	}
 
 	list_del(&dev->uclass_node);
+	dm_lookup_invalidate();
 	return 0;
 }
 #endif
@@ -4,9 +4,12 @@
  */
 #include <common.h>
 #include <dm.h>
+#include <blk.h>
 #include <misc.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
+#include <asm/unaligned.h>
+#include <linux/sizes.h>
 
 #define HEAD_CRC		2
 #define EXTRA_FIELD		4
@@ -288,3 +291,396 @@ int misc_decompress_process(unsigned long dst, unsigned long src,
 
 	return ret;
 }
+
+/*
+ * Streaming decompression.
+ *
+ * The engine reads its source at full speed, so it can't be started on a
+ * partly loaded image. An lz4 frame with independent blocks, however, can
+ * be cut at any block boundary into smaller frames that are valid on their
+ * own: write a frame header over the tail of the block before the cut, and
+ * an end mark over the size field of the block after it. Each such frame
+ * is started as soon as its blocks have landed, and the bytes it borrowed
+ * are restored once it's done or stopped, so the last one finishes shortly
+ * after the last source block is read and the source is unchanged for a
+ * software retry if the engine fails.
+ *
+ * A deflate stream has no such boundaries, a gzip image is started as a
+ * whole once all of it has landed, which gains nothing over reading it
+ * first.
+ */
+#define LZ4_SUBFRAME_HDR_LEN	7
+#define LZ4_BLOCK_SIZE_MASK	0x7fffffff
+#define DECOM_STREAM_MIN_LEN	SZ_1M	/* source bytes per lz4 sub-frame */
+#define DECOM_STREAM_TIMEOUT	2000	/* ms */
+
+#define XXH_PRIME32_1		2654435761U
+#define XXH_PRIME32_2		2246822519U
+#define XXH_PRIME32_3		3266489917U
+#define XXH_PRIME32_5		374761393U
+
+struct misc_decom_stream {
+	struct udevice *dev;
+	unsigned long src;
+	unsigned long src_len;
+	unsigned long dst;
+	u64 dst_max;
+	u64 produced;		/* output of the finished sub-frames */
+	u32 comp;
+	unsigned long landed;	/* source bytes in memory */
+	unsigned long parsed;	/* offset of the first unparsed lz4 block */
+	unsigned long frame;	/* offset of the next sub-frame first block */
+	unsigned long cut;	/* end mark offset of the running sub-frame */
+	u32 cut_saved;		/* block size field under the end mark */
+	u8 hdr_saved[LZ4_SUBFRAME_HDR_LEN]; /* source under the frame header */
+	bool borrowed;		/* hdr_saved and cut_saved to be restored */
+	u8 flg, bd;		/* lz4 frame descriptor for the sub-frames */
+	bool block_csum;
+	bool ended;		/* lz4 end mark reached */
+	bool running;
+};
+
+static struct misc_decom_stream decom_stream;
+
+/* xxh32(seed 0) of the 2-byte frame descriptor, bits 15:8 are the HC */
+static u8 misc_lz4_header_checksum(u8 flg, u8 bd)
+{
+	u32 h = XXH_PRIME32_5 + 2;
+
+	h += flg * XXH_PRIME32_5;
+	h = ((h << 11) | (h >> 21)) * XXH_PRIME32_1;
+	h += bd * XXH_PRIME32_5;
+	h = ((h << 11) | (h >> 21)) * XXH_PRIME32_1;
+	h ^= h >> 15;
+	h *= XXH_PRIME32_2;
+	h ^= h >> 13;
+	h *= XXH_PRIME32_3;
+	h ^= h >> 16;
+
+	return (h >> 8) & 0xff;
+}
+
+static void misc_stream_flush(unsigned long addr, unsigned long len)
+{
+	flush_dcache_range(rounddown(addr, ARCH_DMA_MINALIGN),
+			   roundup(addr + len, ARCH_DMA_MINALIGN));
+}
+
+static int misc_stream_kick(struct misc_decom_stream *s)
+{
+	struct decom_param param;
+	unsigned long hdr, end;
+	u8 *p;
+
+	if (s->comp == DECOM_GZIP) {
+		s->running = true;
+		return misc_decompress_start(s->dev, s->dst, s->src,
+					     s->src_len, 0);
+	}
+
+	/* Frame header over the tail of the previous block */
+	hdr = s->src + s->frame - LZ4_SUBFRAME_HDR_LEN;
+	p = (u8 *)hdr;
+	memcpy(s->hdr_saved, p, LZ4_SUBFRAME_HDR_LEN);
+	s->borrowed = true;
+	put_unaligned_le32(LZ4F_MAGIC, p);
+	p[4] = s->flg;
+	p[5] = s->bd;
+	p[6] = misc_lz4_header_checksum(s->flg, s->bd);
+	misc_stream_flush(hdr, LZ4_SUBFRAME_HDR_LEN);
+
+	/* End mark over the size field of the next block */
+	s->cut = s->parsed;
+	end = s->src + s->cut;
+	if (!s->ended) {
+		s->cut_saved = get_unaligned_le32((void *)end);
+		put_unaligned_le32(0, (void *)end);
+		misc_stream_flush(end, sizeof(u32));
+	}
+
+	param.addr_src = hdr;
+	param.addr_dst = s->dst + s->produced;
+	param.size_src = end + sizeof(u32) - hdr;
+	param.size_dst = s->dst_max - s->produced;
+	param.mode = DECOM_LZ4;
+	param.flags = 0;
+	s->running = true;
+
+	return misc_ioctl(s->dev, IOCTL_REQ_START, &param);
+}
+
+/* Give back the source bytes of the last sub-frame, the engine is stopped */
+static void misc_stream_restore(struct misc_decom_stream *s)
+{
+	unsigned long hdr = s->src + s->frame - LZ4_SUBFRAME_HDR_LEN;
+
+	if (!s->borrowed)
+		return;
+
+	memcpy((void *)hdr, s->hdr_saved, LZ4_SUBFRAME_HDR_LEN);
+	misc_stream_flush(hdr, LZ4_SUBFRAME_HDR_LEN);
+	if (!s->ended) {
+		put_unaligned_le32(s->cut_saved, (void *)(s->src + s->cut));
+		misc_stream_flush(s->src + s->cut, sizeof(u32));
+	}
+	s->borrowed = false;
+}
+
+static int misc_stream_reap(struct misc_decom_stream *s)
+{
+	u64 size = 0;
+	int ret;
+
+	if (!misc_decompress_is_complete(s->dev))
+		return 0;
+
+	ret = misc_decompress_data_size(s->dev, &size, s->comp);
+	misc_decompress_stop(s->dev);
+	if (ret)
+		return ret;
+
+	s->produced += size;
+	s->running = false;
+
+	if (s->comp == DECOM_LZ4) {
+		misc_stream_restore(s);
+		s->frame = s->cut;
+	}
+
+	return 0;
+}
+
+static void misc_stream_parse(struct misc_decom_stream *s)
+{
+	u32 raw, len;
+
+	while (!s->ended && s->parsed + sizeof(u32) <= s->landed) {
+		raw = get_unaligned_le32((void *)(s->src + s->parsed));
+		if (!raw) {
+			s->ended = true;
+			break;
+		}
+
+		len = sizeof(u32) + (raw & LZ4_BLOCK_SIZE_MASK);
+		if (s->block_csum)
+			len += sizeof(u32);
+		if (s->parsed + len > s->landed)
+			break;
+
+		s->parsed += len;
+	}
+}
+
+static bool misc_stream_ready(struct misc_decom_stream *s)
+{
+	if (s->comp == DECOM_GZIP)
+		return !s->produced && s->landed == s->src_len;
+
+	/* All done, or nothing complete to cut yet */
+	if (s->ended)
+		return s->parsed > s->frame;
+	if (s->parsed - s->frame < DECOM_STREAM_MIN_LEN)
+		return false;
+
+	/* The end mark must not share a cache line with data still to land */
+	return roundup(s->src + s->parsed + sizeof(u32), ARCH_DMA_MINALIGN) <=
+	       s->src + s->landed;
+}
+
+static int misc_stream_advance(struct misc_decom_stream *s)
+{
+	int ret;
+
+	if (s->running) {
+		ret = misc_stream_reap(s);
+		if (ret || s->running)
+			return ret;
+	}
+
+	if (s->comp == DECOM_LZ4)
+		misc_stream_parse(s);
+
+	if (!misc_stream_ready(s))
+		return 0;
+
+	return misc_stream_kick(s);
+}
+
+int misc_decompress_stream_start(unsigned long dst, u64 dst_max,
+				 unsigned long src, unsigned long src_len,
+				 u32 comp)
+{
+	struct misc_decom_stream *s = &decom_stream;
+	const struct lz4_frame_header *hdr = (void *)src;
+	struct udevice *dev;
+	int ret;
+
+	if (s->dev)
+		return -EBUSY;
+
+	if (!IS_ALIGNED(dst, ARCH_DMA_MINALIGN) || !dst_max)
+		return -EINVAL;
+
+	dev = misc_decompress_get_device(comp);
+	if (!dev)
+		return -ENODEV;
+
+	ret = misc_decompress_finish(dev, comp);
+	if (ret)
+		return ret;
+
+	memset(s, 0, sizeof(*s));
+	s->dev = dev;
+	s->src = src;
+	s->src_len = src_len;
+	s->dst = dst;
+	s->dst_max = dst_max;
+	s->comp = comp;
+
+	if (comp == DECOM_LZ4) {
+		/* Only the frame header needs to be there already */
+		if (!misc_lz4_header_is_valid((void *)src)) {
+			s->dev = NULL;
+			return -EPERM;
+		}
+
+		s->block_csum = hdr->has_block_checksum;
+		s->flg = hdr->flags & ~(BIT(2) | BIT(3));	/* no C.size/C.sum */
+		s->bd = hdr->block_descriptor;
+		s->frame = sizeof(*hdr) + sizeof(u8);
+		if (hdr->has_content_size)
+			s->frame += sizeof(u64);
+		s->parsed = s->frame;
+	} else if (comp != DECOM_GZIP) {
+		s->dev = NULL;
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int misc_decompress_stream_feed(unsigned long landed)
+{
+	struct misc_decom_stream *s = &decom_stream;
+	int ret;
+
+	if (!s->dev)
+		return -EINVAL;
+
+	s->landed = min(landed, s->src_len);
+	ret = misc_stream_advance(s);
+	if (ret)
+		misc_decompress_stream_abort();
+
+	return ret;
+}
+
+void misc_decompress_stream_abort(void)
+{
+	struct misc_decom_stream *s = &decom_stream;
+
+	if (!s->dev)
+		return;
+
+	misc_decompress_stop(s->dev);
+	misc_stream_restore(s);
+	s->dev = NULL;
+}
+
+int misc_decompress_stream_finish(u64 *size)
+{
+	struct misc_decom_stream *s = &decom_stream;
+	ulong start = get_timer(0);
+	u64 produced = 0;
+	int ret;
+
+	if (!s->dev)
+		return -EINVAL;
+
+	s->landed = s->src_len;
+	do {
+		ret = misc_stream_advance(s);
+
+		/* Each sub-frame gets the full timeout */
+		if (s->produced != produced) {
+			produced = s->produced;
+			start = get_timer(0);
+		} else if (get_timer(start) > DECOM_STREAM_TIMEOUT) {
+			ret = -ETIMEDOUT;
+		}
+	} while (!ret && (s->running || misc_stream_ready(s)));
+
+	if (!ret && (s->comp == DECOM_LZ4 ? !s->ended : !s->produced))
+		ret = -EINVAL;	/* truncated source */
+
+	if (ret) {
+		misc_decompress_stop(s->dev);
+		misc_stream_restore(s);
+	} else if (size) {
+		*size = s->produced;
+	}
+	s->dev = NULL;
+
+	return ret;
+}
+
+#ifdef CONFIG_BLK
+int misc_decompress_blk(struct blk_desc *desc, lbaint_t start,
+			unsigned long src, unsigned long src_len,
+			unsigned long dst, u64 dst_max, u32 comp, u64 *size)
+{
+	lbaint_t chunk = DECOM_STREAM_MIN_LEN / desc->blksz;
+	lbaint_t blkcnt = DIV_ROUND_UP(src_len, desc->blksz);
+	lbaint_t blk = 0, n;
+#ifdef CONFIG_BLK_ASYNC
+	struct blk_req req;
+#endif
+	int ret;
+
+	/* The lz4 frame header must be in place before the stream starts */
+	n = min(chunk, blkcnt);
+	if (blk_dread(desc, start, n, (void *)src) != n)
+		return -EIO;
+
+	ret = misc_decompress_stream_start(dst, dst_max, src, src_len, comp);
+	if (ret)
+		return ret;
+
+	/* The engine runs on its own while the next chunk is read */
+	for (;;) {
+		ret = misc_decompress_stream_feed((blk + n) * desc->blksz);
+		if (ret)
+			return ret;
+
+		blk += n;
+		if (blk >= blkcnt)
+			break;
+
+		n = min(chunk, blkcnt - blk);
+#ifdef CONFIG_BLK_ASYNC
+		ret = blk_dread_submit(desc, &req, start + blk, n,
+				       (void *)src + blk * desc->blksz);
+
+		/* Start the next sub-frame as soon as the engine is idle */
+		while (!ret && !blk_req_poll(desc, &req)) {
+			ret = misc_decompress_stream_feed(blk * desc->blksz);
+			if (ret)
+				blk_req_drain(desc);
+		}
+
+		if (!ret && blk_req_wait(desc, &req) != n)
+			ret = -EIO;
+#else
+		if (blk_dread(desc, start + blk, n,
+			      (void *)src + blk * desc->blksz) != n)
+			ret = -EIO;
+#endif
+		if (ret) {
+			misc_decompress_stream_abort();
+			return ret;
+		}
+	}
+
+	return misc_decompress_stream_finish(size);
+}
+#endif
@@ -0,0 +1,291 @@
+/*
+ * (C) Copyright 2025 Rockchip Electronics Co., Ltd
+ *
+ * eMMC Command Queue Host Controller Interface, polled mode.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <cqhci.h>
+#include <errno.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <mmc.h>
+#include <linux/bitops.h>
+
+static u8 *cqhci_task_desc(struct cqhci_host *cq_host, int tag)
+{
+	return cq_host->desc_base + tag * cq_host->slot_sz;
+}
+
+static u8 *cqhci_trans_desc(struct cqhci_host *cq_host, int tag)
+{
+	return cq_host->trans_desc_base + tag * cq_host->trans_slot_sz;
+}
+
+static void cqhci_write_addr(struct cqhci_host *cq_host, u8 *desc,
+			     ulong addr)
+{
+	u32 *dataddr = (u32 *)(desc + 4);
+
+	dataddr[0] = lower_32_bits(addr);
+	if (cq_host->dma64)
+		dataddr[1] = upper_32_bits(addr);
+}
+
+static int cqhci_prep_tran_desc(struct cqhci_host *cq_host, int tag,
+				ulong addr, int len)
+{
+	u8 *desc = cqhci_trans_desc(cq_host, tag);
+	ulong boundary;
+	int i, trans;
+
+	for (i = 0; len > 0; i++) {
+		if (i == CQHCI_TRAN_DESCS)
+			return -E2BIG;
+
+		trans = min(len, CQHCI_MAX_DAT_LEN);
+		if (cq_host->boundary_128m) {
+			boundary = (addr | (CQHCI_BOUNDARY_128M - 1)) + 1;
+			if (addr + trans > boundary)
+				trans = boundary - addr;
+		}
+		len -= trans;
+
+		memset(desc, 0, cq_host->trans_desc_len);
+		*(u32 *)desc = CQHCI_VALID(1) | CQHCI_END(len <= 0) |
+			       CQHCI_ACT(CQHCI_ACT_TRAN) |
+			       CQHCI_DAT_LENGTH(trans);
+		cqhci_write_addr(cq_host, desc, addr);
+
+		desc += cq_host->trans_desc_len;
+		addr += trans;
+	}
+
+	return 0;
+}
+
+static int cqhci_prep_task(struct cqhci_host *cq_host, int tag,
+			   lbaint_t start, lbaint_t blkcnt, void *dst)
+{
+	u8 *desc = cqhci_task_desc(cq_host, tag);
+	u8 *link = desc + cq_host->task_desc_len;
+	int len = blkcnt * cq_host->mmc->read_bl_len;
+	int ret;
+
+	ret = cqhci_prep_tran_desc(cq_host, tag, (ulong)dst, len);
+	if (ret)
+		return ret;
+
+	memset(desc, 0, cq_host->slot_sz);
+	*(u64 *)desc = CQHCI_VALID(1) | CQHCI_END(1) | CQHCI_INT(1) |
+		       CQHCI_ACT(CQHCI_ACT_TASK) | CQHCI_DATA_DIR(1) |
+		       CQHCI_BLK_COUNT(blkcnt) | CQHCI_BLK_ADDR(start);
+
+	*(u32 *)link = CQHCI_VALID(1) | CQHCI_ACT(CQHCI_ACT_LINK) |
+		       CQHCI_END(0);
+	cqhci_write_addr(cq_host, link,
+			 (ulong)cqhci_trans_desc(cq_host, tag));
+
+	flush_dcache_range((ulong)cqhci_trans_desc(cq_host, tag),
+			   (ulong)cqhci_trans_desc(cq_host, tag + 1));
+	flush_dcache_range((ulong)desc, (ulong)desc + cq_host->slot_sz);
+	flush_cache((ulong)dst, ALIGN(len, ARCH_DMA_MINALIGN));
+
+	return 0;
+}
+
+static void cqhci_enable(struct cqhci_host *cq_host)
+{
+	u32 cqcfg;
+
+	cqcfg = cqhci_readl(cq_host, CQHCI_CFG);
+	if (cqcfg & CQHCI_ENABLE) {
+		cqcfg &= ~CQHCI_ENABLE;
+		cqhci_writel(cq_host, cqcfg, CQHCI_CFG);
+	}
+
+	cqcfg &= ~(CQHCI_DCMD | CQHCI_TASK_DESC_SZ);
+	if (cq_host->task_desc_len == 16)
+		cqcfg |= CQHCI_TASK_DESC_SZ;
+	cqhci_writel(cq_host, cqcfg, CQHCI_CFG);
+
+	cqhci_writel(cq_host, lower_32_bits((ulong)cq_host->desc_base),
+		     CQHCI_TDLBA);
+	cqhci_writel(cq_host, upper_32_bits((ulong)cq_host->desc_base),
+		     CQHCI_TDLBAU);
+	cqhci_writel(cq_host, cq_host->mmc->rca, CQHCI_SSC2);
+
+	/* Status only, completion is polled */
+	cqhci_writel(cq_host, 0, CQHCI_ISGE);
+	cqhci_writel(cq_host, CQHCI_IS_MASK, CQHCI_ISTE);
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_IS), CQHCI_IS);
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_TCN), CQHCI_TCN);
+
+	cqcfg |= CQHCI_ENABLE;
+	cqhci_writel(cq_host, cqcfg, CQHCI_CFG);
+
+	if (cqhci_readl(cq_host, CQHCI_CTL) & CQHCI_HALT)
+		cqhci_writel(cq_host, 0, CQHCI_CTL);
+
+	if (cq_host->ops->enable)
+		cq_host->ops->enable(cq_host);
+}
+
+static int cqhci_halt(struct cqhci_host *cq_host)
+{
+	ulong start = get_timer(0);
+
+	cqhci_writel(cq_host, cqhci_readl(cq_host, CQHCI_CTL) | CQHCI_HALT,
+		     CQHCI_CTL);
+	while (!(cqhci_readl(cq_host, CQHCI_CTL) & CQHCI_HALT)) {
+		if (get_timer(start) > CQHCI_TIMEOUT)
+			return -ETIMEDOUT;
+	}
+
+	return 0;
+}
+
+static void cqhci_clear_all_tasks(struct cqhci_host *cq_host)
+{
+	ulong start = get_timer(0);
+
+	cqhci_writel(cq_host,
+		     cqhci_readl(cq_host, CQHCI_CTL) | CQHCI_CLEAR_ALL_TASKS,
+		     CQHCI_CTL);
+	while (cqhci_readl(cq_host, CQHCI_CTL) & CQHCI_CLEAR_ALL_TASKS) {
+		if (get_timer(start) > CQHCI_TIMEOUT) {
+			printf("%s: timeout\n", __func__);
+			return;
+		}
+	}
+}
+
+static void cqhci_disable(struct cqhci_host *cq_host, bool recovery)
+{
+	if (cqhci_halt(cq_host))
+		printf("%s: halt timeout\n", __func__);
+
+	if (recovery)
+		cqhci_clear_all_tasks(cq_host);
+
+	cqhci_writel(cq_host, 0, CQHCI_ISTE);
+	cqhci_writel(cq_host,
+		     cqhci_readl(cq_host, CQHCI_CFG) & ~CQHCI_ENABLE,
+		     CQHCI_CFG);
+
+	if (cq_host->ops->disable)
+		cq_host->ops->disable(cq_host, recovery);
+}
+
+int cqhci_read(struct cqhci_host *cq_host, struct mmc_cqe_req *reqs,
+	       int count)
+{
+	struct mmc *mmc = cq_host->mmc;
+	struct mmc_cqe_stats *stats = &mmc->cqe_stats;
+	int depth = min_t(int, cq_host->num_slots, mmc->cmdq_depth);
+	u32 busy = 0, done, status, errors;
+	lbaint_t blkcnt, offset = 0;
+	ulong start;
+	int i = 0, tag, inflight, ret = 0;
+
+	cqhci_enable(cq_host);
+
+	start = get_timer(0);
+	while (i < count || busy) {
+		/* Keep every slot the card can take busy */
+		while (i < count && hweight32(busy) < depth) {
+			tag = ffs(~busy) - 1;
+			blkcnt = min_t(lbaint_t, reqs[i].blkcnt - offset,
+				       CQHCI_MAX_TASK_BLKS);
+			ret = cqhci_prep_task(cq_host, tag,
+					      reqs[i].start + offset, blkcnt,
+					      reqs[i].dst +
+					      offset * mmc->read_bl_len);
+			if (ret)
+				goto out;
+
+			busy |= BIT(tag);
+			cqhci_writel(cq_host, BIT(tag), CQHCI_TDBR);
+
+			inflight = hweight32(busy);
+			stats->tasks++;
+			stats->depth_sum += inflight;
+			if (inflight > stats->max_depth)
+				stats->max_depth = inflight;
+
+			offset += blkcnt;
+			if (offset == reqs[i].blkcnt) {
+				offset = 0;
+				i++;
+			}
+		}
+
+		status = cqhci_readl(cq_host, CQHCI_IS);
+		errors = cq_host->ops->get_errors ?
+			 cq_host->ops->get_errors(cq_host) : 0;
+		if ((status & CQHCI_IS_ERROR) || errors) {
+			printf("%s: error, IS 0x%x TERRI 0x%x host 0x%x\n",
+			       __func__, status,
+			       cqhci_readl(cq_host, CQHCI_TERRI), errors);
+			ret = -EIO;
+			goto out;
+		}
+
+		done = cqhci_readl(cq_host, CQHCI_TCN) & busy;
+		if (done) {
+			cqhci_writel(cq_host, done, CQHCI_TCN);
+			cqhci_writel(cq_host, status & CQHCI_IS_TCC, CQHCI_IS);
+			busy &= ~done;
+			start = get_timer(0);
+		} else if (get_timer(start) > CQHCI_TIMEOUT) {
+			printf("%s: timeout, pending 0x%x\n", __func__, busy);
+			ret = -ETIMEDOUT;
+			goto out;
+		}
+	}
+
+out:
+	cqhci_disable(cq_host, ret != 0);
+	if (ret)
+		return ret;
+
+	/* Drop the lines the cpu may have fetched while the dma was running */
+	for (i = 0; i < count; i++)
+		invalidate_dcache_range((ulong)reqs[i].dst,
+					(ulong)reqs[i].dst +
+					ALIGN(reqs[i].blkcnt * mmc->read_bl_len,
+					      ARCH_DMA_MINALIGN));
+
+	return 0;
+}
+
+int cqhci_init(struct cqhci_host *cq_host, struct mmc *mmc, bool dma64)
+{
+	cq_host->mmc = mmc;
+	cq_host->dma64 = dma64;
+	cq_host->num_slots = CQHCI_NUM_SLOTS;
+	cq_host->task_desc_len = dma64 ? 16 : 8;
+	cq_host->link_desc_len = dma64 ? 16 : 8;
+	cq_host->trans_desc_len = dma64 ? 16 : 8;
+	cq_host->slot_sz = cq_host->task_desc_len + cq_host->link_desc_len;
+	cq_host->trans_slot_sz = ALIGN(cq_host->trans_desc_len *
+				       CQHCI_TRAN_DESCS, ARCH_DMA_MINALIGN);
+
+	cq_host->desc_base = memalign(ARCH_DMA_MINALIGN,
+				      cq_host->num_slots * cq_host->slot_sz);
+	cq_host->trans_desc_base = memalign(ARCH_DMA_MINALIGN,
+					    cq_host->num_slots *
+					    cq_host->trans_slot_sz);
+	if (!cq_host->desc_base || !cq_host->trans_desc_base) {
+		free(cq_host->desc_base);
+		free(cq_host->trans_desc_base);
+		return -ENOMEM;
+	}
+
+	debug("%s: CQHCI version 0x%08x, %d slots\n", __func__,
+	      cqhci_readl(cq_host, CQHCI_VER), cq_host->num_slots);
+
+	return 0;
+}
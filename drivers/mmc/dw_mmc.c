@@ -197,11 +197,39 @@ static unsigned int dwmci_get_cto(struct dwmci_host *host)
 	return cto_ms;
 }
 
+/* Stop a data transfer that failed, including the IDMAC */
+static void dwmci_data_reset(struct dwmci_host *host)
+{
+	int reset_timeout = 100;
+	u32 status, ctrl;
+
+	/*
+	 * It is necessary to wait for several cycles before
+	 * resetting the controller while data timeout or error.
+	 */
+	udelay(1);
+	dwmci_wait_reset(host, DWMCI_RESET_ALL);
+	dwmci_writel(host, DWMCI_CMD, DWMCI_CMD_PRV_DAT_WAIT |
+		     DWMCI_CMD_UPD_CLK | DWMCI_CMD_START);
+
+	do {
+		status = dwmci_readl(host, DWMCI_CMD);
+		if (reset_timeout-- < 0)
+			break;
+		udelay(100);
+	} while (status & DWMCI_CMD_START);
+
+	if (!host->fifo_mode) {
+		ctrl = dwmci_readl(host, DWMCI_BMOD);
+		ctrl |= DWMCI_BMOD_IDMAC_RESET;
+		dwmci_writel(host, DWMCI_BMOD, ctrl);
+	}
+}
+
 static int dwmci_data_transfer(struct dwmci_host *host, struct mmc_data *data)
 {
 	int ret = 0;
-	int reset_timeout = 100;
-	u32 timeout, status, ctrl, mask, size, i, len = 0;
+	u32 timeout, mask, size, i, len = 0;
 	u32 *buf = NULL;
 	ulong start = get_timer(0);
 	u32 fifo_depth = (((host->fifoth_val & RX_WMARK_MASK) >>
@@ -228,28 +256,7 @@ static int dwmci_data_transfer(struct dwmci_host *host, struct mmc_data *data)
 		/* Error during data transfer. */
 		if (mask & (DWMCI_DATA_ERR | DWMCI_DATA_TOUT)) {
 			debug("%s: DATA ERROR!\n", __func__);
-			/*
-			 * It is necessary to wait for several cycles before
-			 * resetting the controller while data timeout or error.
-			 */
-			udelay(1);
-			dwmci_wait_reset(host, DWMCI_RESET_ALL);
-			dwmci_writel(host, DWMCI_CMD, DWMCI_CMD_PRV_DAT_WAIT |
-				     DWMCI_CMD_UPD_CLK | DWMCI_CMD_START);
-
-			do {
-				status = dwmci_readl(host, DWMCI_CMD);
-				if (reset_timeout-- < 0)
-					break;
-				udelay(100);
-			} while (status & DWMCI_CMD_START);
-
-			if (!host->fifo_mode) {
-				ctrl = dwmci_readl(host, DWMCI_BMOD);
-				ctrl |= DWMCI_BMOD_IDMAC_RESET;
-				dwmci_writel(host, DWMCI_BMOD, ctrl);
-			}
-
+			dwmci_data_reset(host);
 			ret = -EINVAL;
 			break;
 		}
@@ -350,24 +357,19 @@ static int dwmci_set_transfer_mode(struct dwmci_host *host,
 	return mode;
 }
 
-#ifdef CONFIG_DM_MMC
-static int dwmci_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
-		   struct mmc_data *data)
-{
-	struct mmc *mmc = mmc_get_mmc_dev(dev);
-#else
-static int dwmci_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
-		struct mmc_data *data)
+/*
+ * Issue @cmd and, unless @async is set, wait for its data phase. An async
+ * data phase is left running and completed later by dwmci_poll_data().
+ */
+static int __dwmci_send_cmd(struct dwmci_host *host, struct mmc_cmd *cmd,
+			    struct mmc_data *data,
+			    struct dwmci_idmac *cur_idmac,
+			    struct bounce_buffer *bbstate, bool async)
 {
-#endif
-	struct dwmci_host *host = mmc->priv;
-	ALLOC_CACHE_ALIGN_BUFFER(struct dwmci_idmac, cur_idmac,
-				 data ? DIV_ROUND_UP(data->blocks, 8) : 0);
 	int ret = 0, flags = 0;
 	unsigned int timeout = 500;
 	u32 mask, ctrl;
 	ulong start = get_timer(0);
-	struct bounce_buffer bbstate;
 
 	while (dwmci_readl(host, DWMCI_STATUS) & DWMCI_BUSY) {
 		if (get_timer(start) > timeout) {
@@ -386,12 +388,12 @@ static int dwmci_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 			dwmci_wait_reset(host, DWMCI_CTRL_FIFO_RESET);
 		} else {
 			if (data->flags == MMC_DATA_READ) {
-				ret = bounce_buffer_start(&bbstate,
+				ret = bounce_buffer_start(bbstate,
 						(void*)data->dest,
 						data->blocksize *
 						data->blocks, GEN_BB_WRITE);
 			} else {
-				ret = bounce_buffer_start(&bbstate,
+				ret = bounce_buffer_start(bbstate,
 						(void*)data->src,
 						data->blocksize *
 						data->blocks, GEN_BB_READ);
@@ -401,7 +403,7 @@ static int dwmci_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 				return ret;
 
 			dwmci_prepare_data(host, data, cur_idmac,
-					   bbstate.bounce_buffer);
+					   bbstate->bounce_buffer);
 		}
 	}
 
@@ -479,6 +481,9 @@ static int dwmci_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 		}
 	}
 
+	if (data && async)
+		return 0;
+
 	if (data) {
 		ret = dwmci_data_transfer(host, data);
 
@@ -487,13 +492,98 @@ static int dwmci_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 			ctrl = dwmci_readl(host, DWMCI_CTRL);
 			ctrl &= ~(DWMCI_DMA_EN);
 			dwmci_writel(host, DWMCI_CTRL, ctrl);
-			bounce_buffer_stop(&bbstate);
+			bounce_buffer_stop(bbstate);
 		}
 	}
 
 	return ret;
 }
 
+#ifdef CONFIG_DM_MMC
+static int dwmci_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
+		   struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+#else
+static int dwmci_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
+		struct mmc_data *data)
+{
+#endif
+	struct dwmci_host *host = mmc->priv;
+	ALLOC_CACHE_ALIGN_BUFFER(struct dwmci_idmac, cur_idmac,
+				 data ? DIV_ROUND_UP(data->blocks, 8) : 0);
+	struct bounce_buffer bbstate;
+
+	return __dwmci_send_cmd(host, cmd, data, cur_idmac, &bbstate, false);
+}
+
+#if defined(CONFIG_BLK_ASYNC) && defined(CONFIG_DM_MMC)
+static int dwmci_send_cmd_async(struct udevice *dev, struct mmc_cmd *cmd,
+				struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct dwmci_host *host = mmc->priv;
+	unsigned int ndesc;
+	int ret;
+
+	if (!data || host->fifo_mode)
+		return -ENOSYS;
+
+	/* The descriptor chain must outlive this call, keep it in the host */
+	ndesc = DIV_ROUND_UP(data->blocks, 8);
+	if (ndesc > host->async_ndesc) {
+		free(host->async_idmac);
+		host->async_idmac = memalign(ARCH_DMA_MINALIGN,
+					     ndesc * sizeof(struct dwmci_idmac));
+		if (!host->async_idmac) {
+			host->async_ndesc = 0;
+			return -ENOMEM;
+		}
+		host->async_ndesc = ndesc;
+	}
+
+	ret = __dwmci_send_cmd(host, cmd, data, host->async_idmac,
+			       &host->async_bb, true);
+	if (ret)
+		return ret;
+
+	host->async_data = *data;
+	host->async_start = get_timer(0);
+	host->async_timeout = dwmci_get_drto(host,
+					     data->blocksize * data->blocks);
+
+	return 0;
+}
+
+static int dwmci_poll_data(struct udevice *dev)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct dwmci_host *host = mmc->priv;
+	u32 mask, ctrl;
+	int ret;
+
+	mask = dwmci_readl(host, DWMCI_RINTSTS);
+	if (mask & (DWMCI_DATA_ERR | DWMCI_DATA_TOUT | DWMCI_INTMSK_DTO))
+		/* Returns at once, and does the reset on data error */
+		ret = dwmci_data_transfer(host, &host->async_data);
+	else if (get_timer(host->async_start) > host->async_timeout)
+		ret = -ETIMEDOUT;
+	else
+		return -EINPROGRESS;
+
+	/* The IDMAC must not write to the buffers once they are given back */
+	if (ret == -ETIMEDOUT)
+		dwmci_data_reset(host);
+
+	ctrl = dwmci_readl(host, DWMCI_CTRL);
+	ctrl &= ~(DWMCI_DMA_EN);
+	dwmci_writel(host, DWMCI_CTRL, ctrl);
+	bounce_buffer_stop(&host->async_bb);
+
+	return ret;
+}
+#endif
+
 #ifdef CONFIG_SPL_BLK_READ_PREPARE
 #ifdef CONFIG_DM_MMC
 static int dwmci_send_cmd_prepare(struct udevice *dev, struct mmc_cmd *cmd,
@@ -889,6 +979,10 @@ const struct dm_mmc_ops dm_dwmci_ops = {
 	.send_cmd	= dwmci_send_cmd,
 #ifdef CONFIG_SPL_BLK_READ_PREPARE
 	.send_cmd_prepare = dwmci_send_cmd_prepare,
+#endif
+#ifdef CONFIG_BLK_ASYNC
+	.send_cmd_async	= dwmci_send_cmd_async,
+	.poll_data	= dwmci_poll_data,
 #endif
 	.set_ios	= dwmci_set_ios,
 	.get_cd         = dwmci_get_cd,
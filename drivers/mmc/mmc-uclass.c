@@ -74,11 +74,53 @@ int dm_mmc_send_cmd_prepare(struct udevice *dev, struct mmc_cmd *cmd,
 }
 #endif
 
+#ifdef CONFIG_BLK_ASYNC
+int dm_mmc_send_cmd_async(struct udevice *dev, struct mmc_cmd *cmd,
+			  struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+	int ret;
+
+	if (!ops->send_cmd_async || !ops->poll_data)
+		return -ENOSYS;
+
+	mmmc_trace_before_send(mmc, cmd);
+	ret = ops->send_cmd_async(dev, cmd, data);
+	mmmc_trace_after_send(mmc, cmd, ret);
+
+	return ret;
+}
+
+int dm_mmc_poll_data(struct udevice *dev)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->poll_data)
+		return -ENOSYS;
+
+	return ops->poll_data(dev);
+}
+#endif
+
 int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 {
 	return dm_mmc_send_cmd(mmc->dev, cmd, data);
 }
 
+#ifdef CONFIG_BLK_ASYNC
+int mmc_send_cmd_async(struct mmc *mmc, struct mmc_cmd *cmd,
+		       struct mmc_data *data)
+{
+	return dm_mmc_send_cmd_async(mmc->dev, cmd, data);
+}
+
+int mmc_poll_data(struct mmc *mmc)
+{
+	return dm_mmc_poll_data(mmc->dev);
+}
+#endif
+
 #ifdef CONFIG_SPL_BLK_READ_PREPARE
 int mmc_send_cmd_prepare(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 {
@@ -352,6 +394,10 @@ static int mmc_blk_probe(struct udevice *dev)
 
 static const struct blk_ops mmc_blk_ops = {
 	.read	= mmc_bread,
+#ifdef CONFIG_BLK_ASYNC
+	.read_submit	= mmc_bread_submit,
+	.read_poll	= mmc_bread_poll,
+#endif
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 	.write	= mmc_bwrite,
 	.erase	= mmc_berase,
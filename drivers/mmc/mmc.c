@@ -464,6 +464,219 @@ re_init_retry:
 	return blkcnt;
 }
 
+#if defined(CONFIG_BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+static int mmc_read_blocks_async(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+	struct mmc_data data;
+	lbaint_t blkcnt;
+
+	blkcnt = min_t(lbaint_t, mmc->async_read.todo, mmc->cfg->b_max);
+	mmc->async_read.cur = blkcnt;
+
+	if (blkcnt > 1)
+		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
+	else
+		cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
+
+	if (mmc->high_capacity)
+		cmd.cmdarg = mmc->async_read.start;
+	else
+		cmd.cmdarg = mmc->async_read.start * mmc->read_bl_len;
+
+	cmd.resp_type = MMC_RSP_R1;
+
+	data.dest = mmc->async_read.dst;
+	data.blocks = blkcnt;
+	data.blocksize = mmc->read_bl_len;
+	data.flags = MMC_DATA_READ;
+
+	return mmc_send_cmd_async(mmc, &cmd, &data);
+}
+
+/*
+ * Read the rest of the request with the blocking path, which owns the
+ * re-init and retry logic.
+ */
+static long mmc_bread_async_fallback(struct udevice *dev, struct mmc *mmc)
+{
+	lbaint_t todo = mmc->async_read.todo;
+
+	mmc->async_read.todo = 0;
+	if (mmc_bread(dev, mmc->async_read.start, todo,
+		      mmc->async_read.dst) != todo)
+		return -EIO;
+
+	return mmc->async_read.total;
+}
+
+int mmc_bread_submit(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
+		     void *dst)
+{
+	struct blk_desc *block_dev = dev_get_uclass_platdata(dev);
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
+	int err;
+
+	if (!mmc || !blkcnt)
+		return -EINVAL;
+
+	if (CONFIG_IS_ENABLED(MMC_TINY))
+		err = mmc_switch_part(mmc, block_dev->hwpart);
+	else
+		err = blk_dselect_hwpart(block_dev, block_dev->hwpart);
+	if (err < 0)
+		return err;
+
+	if ((start + blkcnt) > block_dev->lba) {
+		printf("MMC: block number 0x" LBAF " exceeds max(0x" LBAF ")\n",
+		       start + blkcnt, block_dev->lba);
+		return -EINVAL;
+	}
+
+	if (mmc_set_blocklen(mmc, mmc->read_bl_len)) {
+		debug("%s: Failed to set blocklen\n", __func__);
+		return -EIO;
+	}
+
+	mmc->async_read.start = start;
+	mmc->async_read.todo = blkcnt;
+	mmc->async_read.total = blkcnt;
+	mmc->async_read.dst = dst;
+
+	return mmc_read_blocks_async(mmc);
+}
+
+long mmc_bread_poll(struct udevice *dev)
+{
+	struct blk_desc *block_dev = dev_get_uclass_platdata(dev);
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
+	struct mmc_cmd cmd;
+	int err, ret;
+
+	if (!mmc)
+		return -ENODEV;
+
+	err = mmc_poll_data(mmc);
+	if (err == -EINPROGRESS)
+		return err;
+
+	/* Also after a failed multi-block read, the card may still send */
+	if (mmc->async_read.cur > 1) {
+		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
+		cmd.cmdarg = 0;
+		cmd.resp_type = MMC_RSP_R1b;
+		ret = mmc_send_cmd(mmc, &cmd, NULL);
+		if (!err)
+			err = ret;
+	}
+
+	if (err) {
+		debug("%s: Failed to read blocks, %d\n", __func__, err);
+		return mmc_bread_async_fallback(dev, mmc);
+	}
+
+	mmc->async_read.todo -= mmc->async_read.cur;
+	mmc->async_read.start += mmc->async_read.cur;
+	mmc->async_read.dst += mmc->async_read.cur * mmc->read_bl_len;
+	if (!mmc->async_read.todo)
+		return mmc->async_read.total;
+
+	if (mmc_read_blocks_async(mmc))
+		return mmc_bread_async_fallback(dev, mmc);
+
+	return -EINPROGRESS;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+static int mmc_cqe_discard_queue(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+
+	cmd.cmdidx = MMC_CMD_CMDQ_TASK_MGMT;
+	cmd.cmdarg = 1;		/* discard the entire queue */
+	cmd.resp_type = MMC_RSP_R1b;
+
+	return mmc_send_cmd(mmc, &cmd, NULL);
+}
+
+static bool mmc_cqe_usable(struct mmc *mmc, struct mmc_cqe_req *reqs,
+			   int count)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(mmc->dev);
+	int i;
+
+	/* Queued tasks are not allowed to the RPMB partition */
+	if (!mmc->cmdq_depth || !(mmc->cfg->host_caps & MMC_MODE_CQE) ||
+	    !ops->cqe_read ||
+	    mmc_get_blk_desc(mmc)->hwpart == MMC_PART_RPMB)
+		return false;
+
+	for (i = 0; i < count; i++)
+		if (!IS_ALIGNED((ulong)reqs[i].dst, ARCH_DMA_MINALIGN))
+			return false;
+
+	return true;
+}
+#endif
+
+int mmc_cqe_read(struct mmc *mmc, struct mmc_cqe_req *reqs, int count)
+{
+	struct blk_desc *block_dev = mmc_get_blk_desc(mmc);
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (reqs[i].start + reqs[i].blkcnt > block_dev->lba) {
+			printf("MMC: block number 0x" LBAF " exceeds max(0x" LBAF ")\n",
+			       reqs[i].start + reqs[i].blkcnt, block_dev->lba);
+			return -EINVAL;
+		}
+	}
+
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	int err;
+
+#ifdef CONFIG_BLK_ASYNC
+	blk_req_drain(block_dev);
+#endif
+	err = blk_dselect_hwpart(block_dev, block_dev->hwpart);
+	if (err < 0)
+		return err;
+
+	if (mmc_cqe_usable(mmc, reqs, count) &&
+	    !mmc_set_blocklen(mmc, mmc->read_bl_len) &&
+	    !mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL, EXT_CSD_CMDQ_MODE_EN, 1)) {
+		struct dm_mmc_ops *ops = mmc_get_ops(mmc->dev);
+
+		err = ops->cqe_read(mmc->dev, reqs, count);
+		if (err)
+			mmc_cqe_discard_queue(mmc);
+
+		/* Legacy commands need the card out of command queue mode */
+		if (mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
+			       EXT_CSD_CMDQ_MODE_EN, 0)) {
+			printf("MMC: failed to leave command queue mode\n");
+			mmc->has_init = 0;
+			mmc_init(mmc);
+		}
+
+		if (!err) {
+			mmc->cqe_stats.batches++;
+			return 0;
+		}
+	}
+	mmc->cqe_stats.fallbacks++;
+#endif
+
+	for (i = 0; i < count; i++) {
+		if (blk_dread(block_dev, reqs[i].start, reqs[i].blkcnt,
+			      reqs[i].dst) != reqs[i].blkcnt)
+			return -EIO;
+	}
+
+	return 0;
+}
+
 void mmc_set_clock(struct mmc *mmc, uint clock)
 {
 	if (clock > mmc->cfg->f_max)
@@ -2059,6 +2272,14 @@ static int mmc_startup(struct mmc *mmc)
 		mmc->wr_rel_set = ext_csd[EXT_CSD_WR_REL_SET];
 
 		mmc->raw_driver_strength = ext_csd[EXT_CSD_DRIVER_STRENGTH];
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+		/* Command queue is an eMMC 5.1 feature */
+		if (ext_csd[EXT_CSD_REV] >= 8 &&
+		    (ext_csd[EXT_CSD_CMDQ_SUPPORT] & 0x1))
+			mmc->cmdq_depth = (ext_csd[EXT_CSD_CMDQ_DEPTH] & 0x1f) + 1;
+		else
+			mmc->cmdq_depth = 0;
+#endif
 	}
 
 	err = mmc_set_capacity(mmc, mmc_get_blk_desc(mmc)->hwpart);
@@ -18,6 +18,11 @@ extern int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 int mmc_send_cmd_prepare(struct mmc *mmc, struct mmc_cmd *cmd,
 			 struct mmc_data *data);
 #endif
+#if defined(CONFIG_BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+int mmc_send_cmd_async(struct mmc *mmc, struct mmc_cmd *cmd,
+		       struct mmc_data *data);
+int mmc_poll_data(struct mmc *mmc);
+#endif
 extern int mmc_send_status(struct mmc *mmc, int timeout);
 extern int mmc_set_blocklen(struct mmc *mmc, int len);
 int mmc_set_blockcount(struct mmc *mmc, unsigned int blkcnt, bool is_rel_write);
@@ -32,6 +37,11 @@ ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 ulong mmc_bread_prepare(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 			void *dst);
 #endif
+#if defined(CONFIG_BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+int mmc_bread_submit(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
+		     void *dst);
+long mmc_bread_poll(struct udevice *dev);
+#endif
 #else
 ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
@@ -14,6 +14,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <sdhci.h>
+#include <cqhci.h>
 #include <clk.h>
 #include <syscon.h>
 #include <dm/ofnode.h>
@@ -45,6 +46,8 @@ DECLARE_GLOBAL_DATA_PTR;
 /* DWC IP vendor area 1 pointer */
 #define DWCMSHC_P_VENDOR_AREA1		0xe8
 #define DWCMSHC_AREA1_MASK		GENMASK(11, 0)
+/* DWC IP vendor area 2 pointer, it locates the CQHCI registers */
+#define DWCMSHC_P_VENDOR_AREA2		0xea
 /* Rockchip specific Registers */
 #define DWCMSHC_CTRL_HS400		0x7
 #define DWCMSHC_CARD_IS_EMMC		BIT(0)
@@ -114,6 +117,9 @@ struct rockchip_sdhc {
 	void *base;
 	struct rockchip_emmc_phy *phy;
 	struct clk emmc_clk;
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	struct cqhci_host cq_host;
+#endif
 };
 
 struct sdhci_data {
@@ -125,6 +131,7 @@ struct sdhci_data {
 #define RK_DLL_CMD_OUT		BIT(1)
 #define RK_RXCLK_NO_INVERTER	BIT(2)
 #define RK_TAP_VALUE_SEL	BIT(3)
+#define RK_SUPPORT_CQE		BIT(4)
 
 	u8 hs200_tx_tap;
 	u8 hs400_tx_tap;
@@ -514,6 +521,103 @@ static struct sdhci_ops rockchip_sdhci_ops = {
 	.set_enhanced_strobe = rockchip_sdhci_set_enhanced_strobe,
 };
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+static void dwcmshc_cqe_enable(struct cqhci_host *cq_host)
+{
+	struct sdhci_host *host = cq_host->priv;
+	u16 ctrl2;
+	u8 ctrl;
+
+	sdhci_writew(host, SDHCI_TRNS_MULTI | SDHCI_TRNS_BLK_CNT_EN |
+		     SDHCI_TRNS_DMA, SDHCI_TRANSFER_MODE);
+	sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG, 512),
+		     SDHCI_BLOCK_SIZE);
+	sdhci_writeb(host, 0xe, SDHCI_TIMEOUT_CONTROL);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	sdhci_writel(host, SDHCI_CQE_INT_MASK, SDHCI_INT_ENABLE);
+
+	/*
+	 * The engine fetches ADMA2 transfer descriptors, 64-bit ones are
+	 * only walked in host version 4 mode.
+	 */
+	ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+	ctrl2 |= SDHCI_CTRL_V4_MODE;
+	if (cq_host->dma64)
+		ctrl2 |= SDHCI_CTRL_64BIT_ADDR;
+	sdhci_writew(host, ctrl2, SDHCI_HOST_CONTROL2);
+
+	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+	ctrl &= ~SDHCI_CTRL_DMA_MASK;
+	ctrl |= SDHCI_CTRL_ADMA32;
+	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+}
+
+static void dwcmshc_cqe_disable(struct cqhci_host *cq_host, bool recovery)
+{
+	struct sdhci_host *host = cq_host->priv;
+	u8 mask = SDHCI_RESET_CMD | SDHCI_RESET_DATA;
+	ulong start;
+	u16 ctrl2;
+
+	ctrl2 = sdhci_readw(host, SDHCI_HOST_CONTROL2);
+	ctrl2 &= ~(SDHCI_CTRL_V4_MODE | SDHCI_CTRL_64BIT_ADDR);
+	sdhci_writew(host, ctrl2, SDHCI_HOST_CONTROL2);
+
+	sdhci_writel(host, SDHCI_INT_DATA_MASK | SDHCI_INT_CMD_MASK,
+		     SDHCI_INT_ENABLE);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+
+	if (!recovery)
+		return;
+
+	sdhci_writeb(host, mask, SDHCI_SOFTWARE_RESET);
+	start = get_timer(0);
+	while (sdhci_readb(host, SDHCI_SOFTWARE_RESET) & mask) {
+		if (get_timer(start) > 100) {
+			printf("%s: reset timeout\n", __func__);
+			return;
+		}
+	}
+}
+
+static u32 dwcmshc_cqe_get_errors(struct cqhci_host *cq_host)
+{
+	struct sdhci_host *host = cq_host->priv;
+
+	return sdhci_readl(host, SDHCI_INT_STATUS) & SDHCI_CQE_INT_ERR_MASK;
+}
+
+static const struct cqhci_host_ops dwcmshc_cqhci_ops = {
+	.enable		= dwcmshc_cqe_enable,
+	.disable	= dwcmshc_cqe_disable,
+	.get_errors	= dwcmshc_cqe_get_errors,
+};
+
+static int dwcmshc_cqe_init(struct rockchip_sdhc *prv)
+{
+	struct sdhci_host *host = &prv->host;
+	struct cqhci_host *cq_host = &prv->cq_host;
+	int ret;
+
+	cq_host->mmio = host->ioaddr +
+			(sdhci_readw(host, DWCMSHC_P_VENDOR_AREA2) &
+			 DWCMSHC_AREA1_MASK);
+	cq_host->priv = host;
+	cq_host->ops = &dwcmshc_cqhci_ops;
+	/* Same limit as the legacy ADMA engine */
+	cq_host->boundary_128m = true;
+
+	ret = cqhci_init(cq_host, host->mmc,
+			 IS_ENABLED(CONFIG_DMA_ADDR_T_64BIT));
+	if (ret)
+		return ret;
+
+	host->cq_host = cq_host;
+
+	return 0;
+}
+#endif
+
 static int rockchip_sdhci_probe(struct udevice *dev)
 {
 	struct sdhci_data *data = (struct sdhci_data *)dev_get_driver_data(dev);
@@ -564,6 +668,8 @@ static int rockchip_sdhci_probe(struct udevice *dev)
 		return ret;
 
 	host->ops = &rockchip_sdhci_ops;
+	/* DWCMSHC ADMA can't cross 128MiB boundary in one descriptor */
+	host->quirks |= SDHCI_QUIRK_ADMA_BOUNDARY_128M;
 
 	host->max_clk = max_frequency;
 
@@ -575,6 +681,11 @@ static int rockchip_sdhci_probe(struct udevice *dev)
 	if (data->set_enhanced_strobe && dev_read_bool(dev, "mmc-hs400-enhanced-strobe"))
 		host->host_caps |= MMC_MODE_HS400ES;
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	if ((data->flags & RK_SUPPORT_CQE) && dev_read_bool(dev, "supports-cqe"))
+		host->host_caps |= MMC_MODE_CQE;
+#endif
+
 	ret = sdhci_setup_cfg(&plat->cfg, host, 0, EMMC_MIN_FREQ);
 
 	plat->cfg.fixed_drv_type = dev_read_u32_default(dev, "fixed-emmc-driver-type", 0);
@@ -586,7 +697,23 @@ static int rockchip_sdhci_probe(struct udevice *dev)
 	host->mmc->dev = dev;
 	upriv->mmc = host->mmc;
 
-	return sdhci_probe(dev);
+	ret = sdhci_probe(dev);
+	if (ret)
+		return ret;
+
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	if (host->host_caps & MMC_MODE_CQE) {
+		ret = dwcmshc_cqe_init(prv);
+		if (ret) {
+			/* Plain transfers still work */
+			printf("%s: cqe init failed %d\n", __func__, ret);
+			host->host_caps &= ~MMC_MODE_CQE;
+			plat->cfg.host_caps &= ~MMC_MODE_CQE;
+		}
+	}
+#endif
+
+	return 0;
 }
 
 static int rockchip_sdhci_of_to_plat(struct udevice *dev)
@@ -616,7 +743,7 @@ static const struct sdhci_data arasan_data = {
 static const struct sdhci_data rk3568_data = {
 	.emmc_set_clock = dwcmshc_sdhci_emmc_set_clock,
 	.get_phy = dwcmshc_emmc_get_phy,
-	.flags = RK_RXCLK_NO_INVERTER | RK_TAP_VALUE_SEL,
+	.flags = RK_RXCLK_NO_INVERTER | RK_TAP_VALUE_SEL | RK_SUPPORT_CQE,
 	.hs200_tx_tap = 16,
 	.hs400_tx_tap = 8,
 	.hs400_cmd_tap = 8,
@@ -629,7 +756,7 @@ static const struct sdhci_data rk3588_data = {
 	.get_phy = dwcmshc_emmc_get_phy,
 	.set_ios_post = dwcmshc_sdhci_set_ios_post,
 	.set_enhanced_strobe = dwcmshc_sdhci_set_enhanced_strobe,
-	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL,
+	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL | RK_SUPPORT_CQE,
 	.hs200_tx_tap = 16,
 	.hs400_tx_tap = 9,
 	.hs400_cmd_tap = 8,
@@ -642,7 +769,7 @@ static const struct sdhci_data rk3528_data = {
 	.get_phy = dwcmshc_emmc_get_phy,
 	.set_ios_post = dwcmshc_sdhci_set_ios_post,
 	.set_enhanced_strobe = dwcmshc_sdhci_set_enhanced_strobe,
-	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL,
+	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL | RK_SUPPORT_CQE,
 	.hs200_tx_tap = 16,
 	.hs400_tx_tap = 8,
 	.hs400_cmd_tap = 8,
@@ -655,7 +782,7 @@ static const struct sdhci_data rk3562_data = {
 	.get_phy = dwcmshc_emmc_get_phy,
 	.set_ios_post = dwcmshc_sdhci_set_ios_post,
 	.set_enhanced_strobe = dwcmshc_sdhci_set_enhanced_strobe,
-	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL,
+	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL | RK_SUPPORT_CQE,
 	.hs200_tx_tap = 12,
 	.hs400_tx_tap = 6,
 	.hs400_cmd_tap = 6,
@@ -668,7 +795,7 @@ static const struct sdhci_data rk3576_data = {
 	.get_phy = dwcmshc_emmc_get_phy,
 	.set_ios_post = dwcmshc_sdhci_set_ios_post,
 	.set_enhanced_strobe = dwcmshc_sdhci_set_enhanced_strobe,
-	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL,
+	.flags = RK_DLL_CMD_OUT | RK_TAP_VALUE_SEL | RK_SUPPORT_CQE,
 	.hs200_tx_tap = 16,
 	.hs400_tx_tap = 7,
 	.hs400_cmd_tap = 7,
@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <cqhci.h>
 #include <errno.h>
 #include <malloc.h>
 #include <mmc.h>
@@ -68,18 +69,120 @@ static void sdhci_transfer_pio(struct sdhci_host *host, struct mmc_data *data)
 	}
 }
 
-static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
-				unsigned int start_addr)
+#ifdef CONFIG_MMC_SDHCI_ADMA
+static void sdhci_adma_write_desc(struct sdhci_adma_desc *desc,
+				  dma_addr_t addr, int len, bool end)
 {
-	unsigned int stat, rdy, mask, timeout, block = 0;
-	bool transfer_done = false;
-#ifdef CONFIG_MMC_SDHCI_SDMA
-	unsigned char ctrl;
+	u8 attr;
+
+	attr = ADMA_DESC_ATTR_VALID | ADMA_DESC_TRANSFER_DATA;
+	if (end)
+		attr |= ADMA_DESC_ATTR_END;
+
+	desc->attr = attr;
+	desc->reserved = 0;
+	desc->len = len;
+	desc->addr_lo = lower_32_bits(addr);
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+	desc->addr_hi = upper_32_bits(addr);
+#endif
+}
+
+/*
+ * Describe the whole buffer with one descriptor chain, so that the
+ * controller moves it without any software intervention.
+ */
+static void sdhci_prepare_adma_table(struct sdhci_host *host,
+				     dma_addr_t addr, int len)
+{
+	struct sdhci_adma_desc *desc = host->adma_desc_table;
+	dma_addr_t boundary;
+	int trans;
+
+	while (len > 0) {
+		trans = min(len, ADMA_MAX_LEN);
+		if (host->quirks & SDHCI_QUIRK_ADMA_BOUNDARY_128M) {
+			boundary = (addr | (ADMA_BOUNDARY_128M - 1)) + 1;
+			if (addr + trans > boundary)
+				trans = boundary - addr;
+		}
+		len -= trans;
+		sdhci_adma_write_desc(desc++, addr, trans, len <= 0);
+		addr += trans;
+	}
+
+	flush_cache((unsigned long)host->adma_desc_table,
+		    ALIGN((ulong)desc - (ulong)host->adma_desc_table,
+			  ARCH_DMA_MINALIGN));
+}
+
+static int sdhci_adma_init(struct sdhci_host *host, u32 caps)
+{
+	if (!(caps & SDHCI_CAN_DO_ADMA2))
+		return -ENOTSUPP;
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+	if (!(caps & SDHCI_CAN_64BIT))
+		return -ENOTSUPP;
+#endif
+
+	if (!host->adma_desc_table) {
+		host->adma_desc_table = memalign(ARCH_DMA_MINALIGN,
+						 ADMA_TABLE_SZ);
+		if (!host->adma_desc_table)
+			return -ENOMEM;
+	}
+	host->dma_mode = SDHCI_DMA_ADMA;
+
+	return 0;
+}
+#endif
+
+static inline bool sdhci_use_adma(struct sdhci_host *host)
+{
+	return host->dma_mode == SDHCI_DMA_ADMA;
+}
+
+static inline bool sdhci_use_dma(struct sdhci_host *host)
+{
+	return host->dma_mode != SDHCI_DMA_NONE;
+}
+
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+static void sdhci_prepare_dma(struct sdhci_host *host, dma_addr_t start_addr,
+			      int trans_bytes)
+{
+	u8 ctrl;
+
 	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
 	ctrl &= ~SDHCI_CTRL_DMA_MASK;
-	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	if (sdhci_use_adma(host)) {
+		sdhci_prepare_adma_table(host, start_addr, trans_bytes);
+		sdhci_writel(host, lower_32_bits((ulong)host->adma_desc_table),
+			     SDHCI_ADMA_ADDRESS);
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+		sdhci_writel(host, upper_32_bits((ulong)host->adma_desc_table),
+			     SDHCI_ADMA_ADDRESS_HI);
+		ctrl |= SDHCI_CTRL_ADMA64;
+#else
+		ctrl |= SDHCI_CTRL_ADMA32;
+#endif
+		sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+		return;
+	}
+#endif
+	sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
+	sdhci_writeb(host, ctrl | SDHCI_CTRL_SDMA, SDHCI_HOST_CONTROL);
+}
 #endif
 
+static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
+				dma_addr_t start_addr)
+{
+	unsigned int stat, rdy, mask, timeout, block = 0;
+	bool transfer_done = false;
+
 	timeout = 1000000;
 	rdy = SDHCI_INT_SPACE_AVAIL | SDHCI_INT_DATA_AVAIL;
 	mask = SDHCI_DATA_AVAILABLE | SDHCI_SPACE_AVAILABLE;
@@ -106,7 +209,8 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 			}
 		}
 #ifdef CONFIG_MMC_SDHCI_SDMA
-		if (!transfer_done && (stat & SDHCI_INT_DMA_END)) {
+		if (!transfer_done && (stat & SDHCI_INT_DMA_END) &&
+		    !sdhci_use_adma(host)) {
 			sdhci_writel(host, SDHCI_INT_DMA_END, SDHCI_INT_STATUS);
 			start_addr &= ~(SDHCI_DEFAULT_BOUNDARY_SIZE - 1);
 			start_addr += SDHCI_DEFAULT_BOUNDARY_SIZE;
@@ -134,23 +238,29 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 #define SDHCI_CMD_DEFAULT_TIMEOUT		100
 #define SDHCI_READ_STATUS_TIMEOUT		1000
 
-#ifdef CONFIG_DM_MMC
-static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
-{
-	struct mmc *mmc = mmc_get_mmc_dev(dev);
+#define SDHCI_ASYNC_DATA_TIMEOUT		10000
 
-#else
-static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
-{
+/* Async data needs dma straight into the caller buffer */
+#if defined(CONFIG_BLK_ASYNC) && defined(CONFIG_DM_MMC) && \
+	!defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER) && \
+	(defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA))
+#define SDHCI_ASYNC_DATA
 #endif
+
+/*
+ * Issue @cmd and, unless @async is set, wait for its data phase. An async
+ * data phase is left running and completed later by sdhci_poll_data().
+ */
+static int __sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
+				struct mmc_data *data, bool async)
+{
 	struct sdhci_host *host = mmc->priv;
 	unsigned int stat = 0;
 	int ret = 0;
 	int trans_bytes = 0, is_aligned = 1;
 	u32 mask, flags, mode;
-	unsigned int time = 0, start_addr = 0;
+	unsigned int time = 0;
+	dma_addr_t start_addr = 0;
 	int mmc_dev = mmc_get_blk_desc(mmc)->devnum;
 	unsigned start = get_timer(0);
 
@@ -224,32 +334,35 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		if (data->flags == MMC_DATA_READ)
 			mode |= SDHCI_TRNS_READ;
 
-#ifdef CONFIG_MMC_SDHCI_SDMA
-		if (data->flags == MMC_DATA_READ)
-			start_addr = (unsigned long)data->dest;
-		else
-			start_addr = (unsigned long)data->src;
-		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				(start_addr & 0x7) != 0x0) {
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+		if (sdhci_use_dma(host)) {
+			if (data->flags == MMC_DATA_READ)
+				start_addr = (unsigned long)data->dest;
+			else
+				start_addr = (unsigned long)data->src;
+			if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
+			    (start_addr & 0x7) != 0x0) {
+				is_aligned = 0;
+				start_addr = (unsigned long)aligned_buffer;
+				if (data->flags != MMC_DATA_READ)
+					memcpy(aligned_buffer, data->src,
+					       trans_bytes);
+			}
+
+#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
+			/*
+			 * Always use this bounce-buffer when
+			 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
+			 */
 			is_aligned = 0;
 			start_addr = (unsigned long)aligned_buffer;
 			if (data->flags != MMC_DATA_READ)
 				memcpy(aligned_buffer, data->src, trans_bytes);
-		}
-
-#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
-		/*
-		 * Always use this bounce-buffer when
-		 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
-		 */
-		is_aligned = 0;
-		start_addr = (unsigned long)aligned_buffer;
-		if (data->flags != MMC_DATA_READ)
-			memcpy(aligned_buffer, data->src, trans_bytes);
 #endif
 
-		sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
-		mode |= SDHCI_TRNS_DMA;
+			sdhci_prepare_dma(host, start_addr, trans_bytes);
+			mode |= SDHCI_TRNS_DMA;
+		}
 #endif
 		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 				data->blocksize),
@@ -261,8 +374,8 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	}
 
 	sdhci_writel(host, cmd->cmdarg, SDHCI_ARGUMENT);
-#ifdef CONFIG_MMC_SDHCI_SDMA
-	if (data != 0) {
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+	if (data != 0 && sdhci_use_dma(host)) {
 		trans_bytes = ALIGN(trans_bytes, CONFIG_SYS_CACHELINE_SIZE);
 		flush_cache(start_addr, trans_bytes);
 	}
@@ -291,6 +404,14 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	} else
 		ret = -1;
 
+#ifdef SDHCI_ASYNC_DATA
+	if (!ret && data && async) {
+		host->async_data = *data;
+		host->async_addr = start_addr;
+		host->async_start = get_timer(0);
+		return 0;
+	}
+#endif
 	if (!ret && data)
 		ret = sdhci_transfer_data(host, data, start_addr);
 
@@ -314,6 +435,80 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		return -ECOMM;
 }
 
+#ifdef CONFIG_DM_MMC
+static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+
+#else
+static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+#endif
+	return __sdhci_send_command(mmc, cmd, data, false);
+}
+
+#ifdef SDHCI_ASYNC_DATA
+static int sdhci_send_command_async(struct udevice *dev, struct mmc_cmd *cmd,
+				    struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+
+	/* PIO and the bounce buffer need the cpu for the whole transfer */
+	if (!sdhci_use_dma(mmc->priv) || !data ||
+	    data->flags != MMC_DATA_READ ||
+	    !IS_ALIGNED((ulong)data->dest, ARCH_DMA_MINALIGN))
+		return -ENOSYS;
+
+	return __sdhci_send_command(mmc, cmd, data, true);
+}
+
+static int sdhci_poll_data(struct udevice *dev)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+	struct mmc_data *data = &host->async_data;
+	unsigned int stat;
+	ulong start, len;
+	int ret = 0;
+
+	stat = sdhci_readl(host, SDHCI_INT_STATUS);
+	if (stat & SDHCI_INT_ERROR) {
+		printf("%s: Error detected in status(0x%X)!\n", __func__, stat);
+		ret = -EIO;
+	} else if (!(stat & SDHCI_INT_DATA_END)) {
+#ifdef CONFIG_MMC_SDHCI_SDMA
+		if ((stat & SDHCI_INT_DMA_END) && !sdhci_use_adma(host)) {
+			sdhci_writel(host, SDHCI_INT_DMA_END, SDHCI_INT_STATUS);
+			host->async_addr &= ~(SDHCI_DEFAULT_BOUNDARY_SIZE - 1);
+			host->async_addr += SDHCI_DEFAULT_BOUNDARY_SIZE;
+			sdhci_writel(host, host->async_addr, SDHCI_DMA_ADDRESS);
+		}
+#endif
+		if (get_timer(host->async_start) < SDHCI_ASYNC_DATA_TIMEOUT)
+			return -EINPROGRESS;
+
+		printf("%s: Transfer data timeout\n", __func__);
+		ret = -ETIMEDOUT;
+	}
+
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	if (ret) {
+		sdhci_reset(host, SDHCI_RESET_CMD);
+		sdhci_reset(host, SDHCI_RESET_DATA);
+		return ret;
+	}
+
+	/* Drop the lines the cpu may have fetched while the dma was running */
+	start = (ulong)data->dest;
+	len = ALIGN(data->blocks * data->blocksize, ARCH_DMA_MINALIGN);
+	invalidate_dcache_range(start, start + len);
+
+	return 0;
+}
+#endif
+
 void sdhci_enable_clk(struct sdhci_host *host, u16 clk)
 {
 	unsigned int timeout;
@@ -701,12 +896,33 @@ static int sdhci_set_enhanced_strobe(struct udevice *dev)
 	return -ENOTSUPP;
 }
 
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+static int sdhci_cqe_read(struct udevice *dev, struct mmc_cqe_req *reqs,
+			  int count)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	if (!host->cq_host)
+		return -ENOSYS;
+
+	return cqhci_read(host->cq_host, reqs, count);
+}
+#endif
+
 const struct dm_mmc_ops sdhci_ops = {
 	.card_busy	= sdhci_card_busy,
 	.send_cmd	= sdhci_send_command,
+#ifdef SDHCI_ASYNC_DATA
+	.send_cmd_async	= sdhci_send_command_async,
+	.poll_data	= sdhci_poll_data,
+#endif
 	.set_ios	= sdhci_set_ios,
 	.execute_tuning = sdhci_execute_tuning,
 	.set_enhanced_strobe = sdhci_set_enhanced_strobe,
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	.cqe_read	= sdhci_cqe_read,
+#endif
 };
 #else
 static const struct mmc_ops sdhci_ops = {
@@ -725,12 +941,19 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 
 	caps = sdhci_readl(host, SDHCI_CAPABILITIES);
 
+	host->dma_mode = SDHCI_DMA_NONE;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	if (sdhci_adma_init(host, caps))
+		debug("%s: ADMA2 unavailable, fall back\n", __func__);
+#endif
 #ifdef CONFIG_MMC_SDHCI_SDMA
-	if (!(caps & SDHCI_CAN_DO_SDMA)) {
-		printf("%s: Your controller doesn't support SDMA!!\n",
+	if (!sdhci_use_adma(host) && (caps & SDHCI_CAN_DO_SDMA))
+		host->dma_mode = SDHCI_DMA_SDMA;
+#endif
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+	if (!sdhci_use_dma(host))
+		printf("%s: Your controller doesn't support DMA, using PIO\n",
 		       __func__);
-		return -EINVAL;
-	}
 #endif
 	if (host->quirks & SDHCI_QUIRK_REG32_RW)
 		host->version =
@@ -2236,5 +2236,6 @@ U_BOOT_DRIVER(eth_eqos) = {
 	.ops = &eqos_ops,
 	.priv_auto_alloc_size = sizeof(struct eqos_priv),
 	.platdata_auto_alloc_size = sizeof(struct eth_pdata),
+	.flags = DM_FLAG_PROBE_DEFER,
 };
 #endif
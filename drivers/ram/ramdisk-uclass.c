@@ -58,6 +58,17 @@ static ulong ramdisk_berase(struct udevice *dev,
 	return ops->erase(desc, start, blkcnt);
 }
 
+static void *ramdisk_bmap(struct udevice *dev, lbaint_t start, lbaint_t blkcnt)
+{
+	const struct ramdisk_ops *ops = dev_get_driver_ops(dev->parent);
+	struct blk_desc *desc = dev_get_uclass_platdata(dev);
+
+	if (!ops->map)
+		return NULL;
+
+	return ops->map(desc, start, blkcnt);
+}
+
 int dm_ramdisk_is_enabled(void)
 {
 	return (atags_is_available() && atags_get_tag(ATAG_RAM_PARTITION));
@@ -65,6 +76,7 @@ int dm_ramdisk_is_enabled(void)
 
 static const struct blk_ops ramdisk_blk_ops = {
 	.read	= ramdisk_bread,
+	.map	= ramdisk_bmap,
 #ifndef CONFIG_SPL_BUILD
 	.write	= ramdisk_bwrite,
 	.erase	= ramdisk_berase,
@@ -32,6 +32,13 @@ static ulong ramdisk_ro_bread(struct blk_desc *desc, lbaint_t start,
 	return blkcnt;
 }
 
+/* The block number is the address in units of blocks */
+static void *ramdisk_ro_map(struct blk_desc *desc, lbaint_t start,
+			    lbaint_t blkcnt)
+{
+	return (void *)(ulong)(start * desc->blksz);
+}
+
 static int ramdisk_ro_bind(struct udevice *dev)
 {
 	struct udevice *bdev;
@@ -49,6 +56,7 @@ static int ramdisk_ro_bind(struct udevice *dev)
 
 static const struct ramdisk_ops ramdisk_ro_ops = {
 	.read = ramdisk_ro_bread,
+	.map = ramdisk_ro_map,
 };
 
 static const struct udevice_id ramdisk_ro_ids[] = {
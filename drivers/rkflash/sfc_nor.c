@@ -454,6 +454,7 @@ int snor_prog_page(struct SFNOR_DEV *p_dev,
 	return ret;
 }
 
+#ifndef CONFIG_RKSFC_NOR_DIFF_WRITE
 static int snor_prog(struct SFNOR_DEV *p_dev, u32 addr, void *p_data, u32 size)
 {
 	int ret = SFC_OK;
@@ -474,6 +475,7 @@ static int snor_prog(struct SFNOR_DEV *p_dev, u32 addr, void *p_data, u32 size)
 
 	return ret;
 }
+#endif
 
 static int snor_enable_QE(struct SFNOR_DEV *p_dev)
 {
@@ -589,6 +591,129 @@ out:
 	return ret;
 }
 
+#ifdef CONFIG_RKSFC_NOR_DIFF_WRITE
+/* Programming can only clear bits, anything else needs an erase first */
+static bool snor_can_prog(const u8 *old, const u8 *new, u32 size)
+{
+	const u32 *o = (const u32 *)old, *n = (const u32 *)new;
+	u32 i;
+
+	for (i = 0; i < size / 4; i++) {
+		if ((o[i] & n[i]) != n[i])
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Write 'len' sectors at 'offset' into the erase block of 'blk_size'
+ * sectors at 'sec'. Only the 4KB sectors that can't be programmed over
+ * are erased, keeping the data around the write, and only the pages that
+ * change are programmed. 'old' and 'new' must each hold a block.
+ */
+static int snor_write_diff(struct SFNOR_DEV *p_dev, u32 sec, u32 blk_size,
+			   u32 offset, u32 len, const u8 *p_buf, u8 *old,
+			   u8 *new, u32 *prog, u32 *erase)
+{
+	u32 size = blk_size << 9, sec_size = NOR_SECS_PAGE << 9;
+	u32 addr = sec << 9, mask = 0, count = 0, i;
+	int ret;
+
+	ret = snor_read(p_dev, sec, blk_size, old);
+	if (ret != blk_size)
+		return ret;
+
+	memcpy(new, old, size);
+	memcpy(new + (offset << 9), p_buf, len << 9);
+
+	for (i = 0; i < size; i += sec_size) {
+		if (!snor_can_prog(old + i, new + i, sec_size)) {
+			mask |= BIT(i / sec_size);
+			count++;
+		}
+	}
+
+	if (blk_size > NOR_SECS_PAGE && count == size / sec_size) {
+		ret = snor_erase(p_dev, addr, ERASE_BLOCK64K);
+		if (ret != SFC_OK)
+			return ret;
+		memset(old, 0xFF, size);
+		*erase += size;
+	} else {
+		for (i = 0; i < size; i += sec_size) {
+			if (!(mask & BIT(i / sec_size)))
+				continue;
+			ret = snor_erase(p_dev, addr + i, ERASE_SECTOR);
+			if (ret != SFC_OK)
+				return ret;
+			memset(old + i, 0xFF, sec_size);
+			*erase += sec_size;
+		}
+	}
+
+	for (i = 0; i < size; i += NOR_PAGE_SIZE) {
+		if (!memcmp(old + i, new + i, NOR_PAGE_SIZE))
+			continue;
+		ret = snor_prog_page(p_dev, addr + i, new + i, NOR_PAGE_SIZE);
+		if (ret != SFC_OK)
+			return ret;
+		*prog += NOR_PAGE_SIZE;
+	}
+
+	return SFC_OK;
+}
+
+int snor_write(struct SFNOR_DEV *p_dev, u32 sec, u32 n_sec, void *p_data)
+{
+	int ret = SFC_OK;
+	u32 len, blk_size, offset;
+	u8 *p_buf =  (u8 *)p_data;
+	u32 total_sec = n_sec;
+	u32 prog = 0, erase = 0;
+	u8 *old, *new;
+
+	rkflash_print_dio("%s %x %x\n", __func__, sec, n_sec);
+
+	if ((sec + n_sec) > p_dev->capacity)
+		return SFC_PARAM_ERR;
+
+	blk_size = max_t(u32, p_dev->blk_size, 8);
+	old = malloc(blk_size << 10);
+	if (!old)
+		return SFC_ERROR;
+	new = old + (blk_size << 9);
+
+	while (n_sec) {
+		if (sec < 512 || sec >= p_dev->capacity  - 512)
+			blk_size = 8;
+		else
+			blk_size = p_dev->blk_size;
+
+		offset = (sec & (blk_size - 1));
+		len = (blk_size - offset) < n_sec ?
+		      (blk_size - offset) : n_sec;
+		ret = snor_write_diff(p_dev, sec - offset, blk_size, offset,
+				      len, p_buf, old, new, &prog, &erase);
+		if (ret != SFC_OK) {
+			rkflash_print_error("snor_write_diff %x ret= %x\n",
+					    sec, ret);
+			goto out;
+		}
+		n_sec -= len;
+		sec += len;
+		p_buf += len << 9;
+	}
+out:
+	free(old);
+	rkflash_print_dio("%s programmed %x erased %x of %x\n", __func__,
+			  prog, erase, total_sec << 9);
+	if (!ret)
+		ret = total_sec;
+
+	return ret;
+}
+#else
 int snor_write(struct SFNOR_DEV *p_dev, u32 sec, u32 n_sec, void *p_data)
 {
 	int ret = SFC_OK;
@@ -634,6 +759,7 @@ out:
 
 	return ret;
 }
+#endif
 
 int snor_read_id(u8 *data)
 {
@@ -84,6 +84,14 @@ static inline struct f_fastboot *func_to_fastboot(struct usb_function *f)
 static struct f_fastboot *fastboot_func;
 static unsigned int download_size;
 static unsigned int download_bytes;
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+/* Largest streamed download, rx_bytes_expected() works with an int */
+#define FB_STREAM_MAX_SIZE	0x7ffff000
+static char stream_part[32];	/* partition streamed downloads go to */
+static bool stream_armed;	/* stream the next download */
+static bool stream_flashed;	/* a piece of the image was flashed */
+static bool download_streamed;
+#endif
 static unsigned int upload_size;
 static unsigned int upload_bytes;
 static bool start_upload;
@@ -681,6 +689,13 @@ static int fb_read_var(char *cmd, char *response,
 		fb_add_string(response, chars_left, "userdebug", NULL);
 		break;
 	case FB_DWNLD_SIZE:
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+		if (stream_armed) {
+			fb_add_number(response, chars_left, "0x%08x",
+				      FB_STREAM_MAX_SIZE);
+			break;
+		}
+#endif
 		fb_add_number(response, chars_left, "0x%08x",
 			      CONFIG_FASTBOOT_BUF_SIZE);
 		break;
@@ -1580,6 +1595,26 @@ static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 	if (buffer_size < transfer_size)
 		transfer_size = buffer_size;
 
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	if (download_streamed) {
+		if (fb_mmc_stream_write(buffer, transfer_size)) {
+			/* Stall the rest of the download, it cannot be kept */
+			fb_mmc_stream_finish(response);
+			printf("\nstreaming to '%s' failed, download stopped\n",
+			       stream_part);
+			stream_armed = false;
+			download_streamed = false;
+			download_size = 0;
+			req->complete = rx_handler_command;
+			req->length = EP_BUFFER_SIZE;
+			req->actual = 0;
+			usb_ep_set_halt(ep);
+			fastboot_tx_write_str(response);
+			usb_ep_queue(ep, req, 0);
+			return;
+		}
+	} else
+#endif
 	memcpy((void *)CONFIG_FASTBOOT_BUF_ADDR + download_bytes,
 	       buffer, transfer_size);
 
@@ -1604,6 +1639,13 @@ static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 		req->length = EP_BUFFER_SIZE;
 
 		strcpy(response, "OKAY");
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+		if (download_streamed) {
+			fb_mmc_stream_finish(response);
+			if (strncmp(response, "OKAY", 4))
+				stream_armed = false;
+		}
+#endif
 		fastboot_tx_write_str(response);
 
 		printf("\ndownloading of %d bytes finished\n", download_bytes);
@@ -1626,6 +1668,38 @@ static void cb_download(struct usb_ep *ep, struct usb_request *req)
 
 	printf("Starting download of %d bytes\n", download_size);
 
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	download_streamed = false;
+	if (stream_armed && download_size) {
+		int ret;
+
+		strcpy(response, "FAILno flash device defined");
+		if (download_size > FB_STREAM_MAX_SIZE) {
+			strcpy(response, "FAILdata too large");
+			ret = -EFBIG;
+		} else if (stream_flashed) {
+			/* The next sparse piece of an image split by the client */
+			fb_mmc_stream_next();
+			ret = 0;
+		} else {
+			ret = fb_mmc_stream_start(stream_part, download_size,
+						  response);
+		}
+		if (ret == 0) {
+			download_streamed = true;
+			sprintf(response, "DATA%08x", download_size);
+			req->complete = rx_handler_dl_image;
+			req->length = rx_bytes_expected(ep);
+		} else {
+			download_size = 0;
+			stream_armed = false;
+			stream_flashed = false;
+		}
+		fastboot_tx_write_str(response);
+		return;
+	}
+#endif
+
 	if (0 == download_size) {
 		strcpy(response, "FAILdata invalid size");
 	} else if (download_size > CONFIG_FASTBOOT_BUF_SIZE) {
@@ -1727,6 +1801,12 @@ static void do_bootm_on_complete(struct usb_ep *ep, struct usb_request *req)
 
 static void cb_boot(struct usb_ep *ep, struct usb_request *req)
 {
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	if (download_streamed) {
+		fastboot_tx_write_str("FAILimage was written to storage");
+		return;
+	}
+#endif
 	fastboot_func->in_req->complete = do_bootm_on_complete;
 	fastboot_tx_write_str("OKAY");
 }
@@ -1783,10 +1863,9 @@ static void cb_set_active(struct usb_ep *ep, struct usb_request *req)
 }
 
 #ifdef CONFIG_FASTBOOT_FLASH
-static void cb_flash(struct usb_ep *ep, struct usb_request *req)
+/* Checks before writing to a partition, replies with FAIL if not allowed */
+static int fb_flash_allowed(const char *part)
 {
-	char *cmd = req->buf;
-	char response[FASTBOOT_RESPONSE_LEN] = {0};
 #ifdef CONFIG_RK_AVB_LIBAVB_USER
 	uint8_t flash_lock_state;
 
@@ -1794,35 +1873,62 @@ static void cb_flash(struct usb_ep *ep, struct usb_request *req)
 		/* write the device flashing unlock when first read */
 		if (rk_avb_write_flash_lock_state(1)) {
 			fastboot_tx_write_str("FAILflash lock state write failure");
-			return;
+			return 0;
 		}
 		if (rk_avb_read_flash_lock_state(&flash_lock_state)) {
 			fastboot_tx_write_str("FAILflash lock state read failure");
-			return;
+			return 0;
 		}
 	}
 
 	if (flash_lock_state == 0) {
 		fastboot_tx_write_str("FAILThe device is locked, can not flash!");
 		printf("The device is locked, can not flash!\n");
-		return;
+		return 0;
 	}
 #endif
-	strsep(&cmd, ":");
-	if (!cmd) {
+	if (!part) {
 		pr_err("missing partition name");
 		fastboot_tx_write_str("FAILmissing partition name");
-		return;
+		return 0;
 	}
 #ifdef CONFIG_ANDROID_AB
-	if ((strcmp(cmd, PART_USERDATA) == 0) || (strcmp(cmd, PART_METADATA) == 0)) {
+	if ((strcmp(part, PART_USERDATA) == 0) || (strcmp(part, PART_METADATA) == 0)) {
 		if (should_prevent_userdata_wipe()) {
 			pr_err("FAILThe virtual A/B merging, can not flash userdata or metadata!\n");
 			fastboot_tx_write_str("FAILvirtual A/B merging,abort flash!");
-			return;
+			return 0;
 		}
 	}
 #endif
+	return 1;
+}
+
+static void cb_flash(struct usb_ep *ep, struct usb_request *req)
+{
+	char *cmd = req->buf;
+	char response[FASTBOOT_RESPONSE_LEN] = {0};
+
+	strsep(&cmd, ":");
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	if (download_streamed) {
+		/* Written during the download, which reported the result */
+		download_streamed = false;
+		if (cmd && !strcmp(cmd, stream_part)) {
+			/* Stay armed for further pieces of a split image */
+			stream_flashed = true;
+			fastboot_tx_write_str("OKAY");
+		} else {
+			stream_armed = false;
+			stream_flashed = false;
+			fastboot_tx_write_str("FAILimage was streamed to another partition");
+		}
+		return;
+	}
+#endif
+	if (!fb_flash_allowed(cmd))
+		return;
+
 	fastboot_fail("no flash device defined", response);
 #ifdef CONFIG_FASTBOOT_FLASH_MMC_DEV
 	fb_mmc_flash_write(cmd, (void *)CONFIG_FASTBOOT_BUF_ADDR,
@@ -2031,6 +2137,26 @@ static void cb_oem(struct usb_ep *ep, struct usb_request *req)
 		fastboot_tx_write_str("OKAY");
 #endif
 	} else
+#endif
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	if (strncmp("stream", cmd + 4, 6) == 0) {
+		char *part = cmd + 10;
+
+		stream_armed = false;
+		stream_flashed = false;
+		if (*part == ' ')
+			part++;
+		if (!*part) {
+			fastboot_tx_write_str("OKAY");
+		} else if (strlen(part) >= sizeof(stream_part)) {
+			fastboot_tx_write_str("FAILpartition name too long");
+		} else if (fb_flash_allowed(part)) {
+			strcpy(stream_part, part);
+			stream_armed = true;
+			printf("Next download is written to '%s'\n", part);
+			fastboot_tx_write_str("OKAY");
+		}
+	} else
 #endif
 	if (strncmp("unlock", cmd + 4, 8) == 0) {
 #ifdef CONFIG_FASTBOOT_OEM_UNLOCK
@@ -2373,6 +2499,20 @@ static void rx_handler_command(struct usb_ep *ep, struct usb_request *req)
 	if (req->status != 0 || req->length == 0)
 		return;
 
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	/*
+	 * An image over max-download-size comes as several sparse images,
+	 * each downloaded and flashed in turn. Once one was flashed, any
+	 * other command means the image is complete.
+	 */
+	if (stream_flashed && strncmp(cmdbuf, "download:", 9) &&
+	    strncmp(cmdbuf, "flash:", 6)) {
+		printf("Streaming to '%s' finished\n", stream_part);
+		stream_armed = false;
+		stream_flashed = false;
+	}
+#endif
+
 	for (i = 0; i < ARRAY_SIZE(cmd_dispatch_info); i++) {
 		if (!strcmp_l1(cmd_dispatch_info[i].cmd, cmdbuf)) {
 			func_cb = cmd_dispatch_info[i].cb;
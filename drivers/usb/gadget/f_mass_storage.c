@@ -254,6 +254,7 @@
 #include <rockusb.h>
 
 #include <asm/unaligned.h>
+#include <div64.h>
 #include <linux/bitops.h>
 #include <linux/usb/gadget.h>
 #include <linux/usb/gadget.h>
@@ -321,6 +322,13 @@ struct fsg_common {
 	u32			usb_amount_left;
 	u32			usb_trb_size;	/* usb transfer size */
 
+	/* Media write statistics, reported when the function is unbound */
+	u64			write_bytes;
+	unsigned int		write_calls;
+	ulong			write_media_us;	/* time spent in write_sector */
+	ulong			write_begin;	/* get_timer() of the first write */
+	ulong			write_end;	/* get_timer() after the last one */
+
 	unsigned int		can_stall:1;
 	unsigned int		free_storage_on_release:1;
 	unsigned int		phase_error:1;
@@ -827,6 +835,8 @@ static int do_write(struct fsg_common *common)
 	unsigned int		amount;
 	unsigned int		partial_page;
 	ssize_t			nwritten;
+	struct fsg_buffhd	*last;
+	ulong			start_us;
 	int			rc;
 	const char		*cdev_name __maybe_unused;
 
@@ -925,26 +935,52 @@ static int do_write(struct fsg_common *common)
 		if (bh->state == BUF_STATE_EMPTY && !get_some_more)
 			break;			/* We stopped early */
 		if (bh->state == BUF_STATE_FULL) {
-			common->next_buffhd_to_drain = bh->next;
-			bh->state = BUF_STATE_EMPTY;
-
 			/* Did something go wrong with the transfer? */
 			if (bh->outreq->status != 0) {
+				common->next_buffhd_to_drain = bh->next;
+				bh->state = BUF_STATE_EMPTY;
 				curlun->sense_data = SS_COMMUNICATION_FAILURE;
 				curlun->info_valid = 1;
 				break;
 			}
 
+			/*
+			 * The buffers are carved out of one allocation, so
+			 * full buffers that follow each other in memory are
+			 * written to the medium at once.
+			 */
 			amount = bh->outreq->actual;
+			last = bh;
+			while (last->outreq->actual == last->outreq->length &&
+			       last->next->state == BUF_STATE_FULL &&
+			       last->next->outreq->status == 0 &&
+			       last->next->buf == bh->buf + amount) {
+				last = last->next;
+				amount += last->outreq->actual;
+			}
 
 			/* Perform the write */
+			start_us = timer_get_us();
+			if (!common->write_bytes)
+				common->write_begin = get_timer(0);
 			rc = ums[common->lun].write_sector(&ums[common->lun],
 					       file_offset / SECTOR_SIZE,
 					       amount / SECTOR_SIZE,
 					       (char __user *)bh->buf);
+			common->write_media_us += timer_get_us() - start_us;
+			common->write_end = get_timer(0);
+			common->write_calls++;
+
+			/* The buffers can take more data from the host now */
+			common->next_buffhd_to_drain = last->next;
+			for (; bh != last; bh = bh->next)
+				bh->state = BUF_STATE_EMPTY;
+			bh->state = BUF_STATE_EMPTY;
+
 			if (!rc)
 				return -EIO;
 			nwritten = rc * SECTOR_SIZE;
+			common->write_bytes += nwritten;
 
 			VLDBG(curlun, "file write %u @ %llu -> %d\n", amount,
 					(unsigned long long) file_offset,
@@ -2479,6 +2515,7 @@ static struct fsg_common *fsg_common_init(struct fsg_common *common,
 	struct usb_gadget *gadget = cdev->gadget;
 	struct fsg_buffhd *bh;
 	struct fsg_lun *curlun;
+	char *buf;
 	int nluns, i, rc;
 
 	/* Find out how many LUNs there should be */
@@ -2534,8 +2571,14 @@ static struct fsg_common *fsg_common_init(struct fsg_common *common,
 	}
 	common->lun = 0;
 
-	/* Data buffers cyclic list */
+	/* Data buffers cyclic list, back to back in one allocation */
 	bh = common->buffhds;
+	buf = memalign(CONFIG_SYS_CACHELINE_SIZE,
+		       FSG_NUM_BUFFERS * FSG_BUFLEN);
+	if (unlikely(!buf)) {
+		rc = -ENOMEM;
+		goto error_release;
+	}
 
 	i = FSG_NUM_BUFFERS;
 	goto buffhds_first_it;
@@ -2545,11 +2588,8 @@ static struct fsg_common *fsg_common_init(struct fsg_common *common,
 buffhds_first_it:
 		bh->inreq_busy = 0;
 		bh->outreq_busy = 0;
-		bh->buf = memalign(CONFIG_SYS_CACHELINE_SIZE, FSG_BUFLEN);
-		if (unlikely(!bh->buf)) {
-			rc = -ENOMEM;
-			goto error_release;
-		}
+		bh->buf = buf;
+		buf += FSG_BUFLEN;
 	} while (--i);
 	bh->next = common->buffhds;
 
@@ -2611,13 +2651,8 @@ static void fsg_common_release(struct kref *ref)
 		kfree(common->luns);
 	}
 
-	{
-		struct fsg_buffhd *bh = common->buffhds;
-		unsigned i = FSG_NUM_BUFFERS;
-		do {
-			kfree(bh->buf);
-		} while (++bh, --i);
-	}
+	/* All the buffers share the allocation of the first one */
+	kfree(common->buffhds[0].buf);
 
 	if (common->free_storage_on_release)
 		kfree(common);
@@ -2675,11 +2710,29 @@ usb_copy_descriptors(struct usb_descriptor_header **src)
 	return ret;
 }
 
+static void fsg_report_writes(struct fsg_common *common)
+{
+	ulong ms = common->write_end - common->write_begin;
+
+	if (!common->write_bytes)
+		return;
+
+	printf("UMS: wrote %llu MiB in %lu ms (%llu KiB/s), %u media writes taking %lu ms\n",
+	       common->write_bytes >> 20, ms,
+	       lldiv(common->write_bytes * 1000, max(ms, 1UL)) >> 10,
+	       common->write_calls, common->write_media_us / 1000);
+
+	common->write_bytes = 0;
+	common->write_calls = 0;
+	common->write_media_us = 0;
+}
+
 static void fsg_unbind(struct usb_configuration *c, struct usb_function *f)
 {
 	struct fsg_dev		*fsg = fsg_from_func(f);
 
 	DBG(fsg, "unbind\n");
+	fsg_report_writes(fsg->common);
 	if (fsg->common->fsg == fsg) {
 		fsg->common->new_fsg = NULL;
 		raise_exception(fsg->common, FSG_STATE_CONFIG_CHANGE);
@@ -1371,25 +1371,103 @@ static void bitmap_destroy(void *bitmap)
 	free(bitmap);
 }
 
+/*
+ * Convert the RGBA8888 output of libnsbmp to ARGB8888 (BGRA in memory). A
+ * whole pixel is loaded before it is stored, so @dst may be the bitmap.
+ */
 static void bmp_copy(void *dst, bmp_image *bmp)
 {
-	u16 row, col;
-	u8 *image;
-	u8 *pdst = (u8 *)dst;
+	const u32 *image = (const u32 *)bmp->bitmap;
+	u32 *pdst = (u32 *)dst;
+	size_t i, n = (size_t)bmp->width * bmp->height;
+	u32 p;
 
-	image = (u8 *)bmp->bitmap;
-	for (row = 0; row != bmp->height; row++) {
-		for (col = 0; col != bmp->width; col++) {
-			size_t z = (row * bmp->width + col) * BYTES_PER_PIXEL;
+	for (i = 0; i < n; i++) {
+		p = image[i];
+		pdst[i] = (p & 0xff00ff00) | ((p & 0xff) << 16) |
+			  ((p >> 16) & 0xff);
+	}
+}
 
-			*pdst++ = image[z + 2];
-			*pdst++ = image[z + 1];
-			*pdst++ = image[z + 0];
-			*pdst++ = image[z + 3];
+static __always_inline void rotate_pixel(u8 *d, const u8 *s, int bytes)
+{
+	if (bytes == 4) {
+		*(u32 *)d = *(const u32 *)s;
+	} else if (bytes == 2) {
+		*(u16 *)d = *(const u16 *)s;
+	} else {
+		d[0] = s[0];
+		d[1] = s[1];
+		d[2] = s[2];
+	}
+}
+
+/*
+ * Rotating by 90 or 270 degrees reads rows and writes columns, so one of
+ * the two walks a new cache line for every pixel. Going through the image
+ * in tiles of @tile x @tile pixels keeps the lines of both a tile's rows
+ * and its columns in the cache until they have been used up.
+ */
+static __always_inline void rotate_tiled(u8 *dst, const u8 *src,
+					 int width, int height,
+					 int dst_stride, int rotate,
+					 int bytes, int tile)
+{
+	int src_stride = width * bytes;
+	int ti, tj, i, j, ie, je, step;
+	const u8 *s;
+	u8 *d;
+
+	for (ti = 0; ti < height; ti += tile) {
+		ie = min(ti + tile, height);
+		for (tj = 0; tj < width; tj += tile) {
+			je = min(tj + tile, width);
+			for (i = ti; i < ie; i++) {
+				s = src + i * src_stride + tj * bytes;
+				if (rotate == 90) {
+					d = dst + tj * dst_stride +
+					    (height - 1 - i) * bytes;
+					step = dst_stride;
+				} else if (rotate == 270) {
+					d = dst + (width - 1 - tj) * dst_stride +
+					    i * bytes;
+					step = -dst_stride;
+				} else {
+					d = dst + (height - 1 - i) * dst_stride +
+					    (width - 1 - tj) * bytes;
+					step = -bytes;
+				}
+				for (j = tj; j < je; j++, s += bytes, d += step)
+					rotate_pixel(d, s, bytes);
+			}
 		}
 	}
 }
 
+int rockchip_rotate_image(void *dst, const void *src, int width, int height,
+			  int dst_stride, int bpp, int rotate)
+{
+	if (rotate != 90 && rotate != 180 && rotate != 270)
+		return -EINVAL;
+
+	/* Tiles one cache line wide, constant so each depth gets its own loop */
+	switch (bpp) {
+	case 16:
+		rotate_tiled(dst, src, width, height, dst_stride, rotate, 2, 32);
+		break;
+	case 24:
+		rotate_tiled(dst, src, width, height, dst_stride, rotate, 3, 16);
+		break;
+	case 32:
+		rotate_tiled(dst, src, width, height, dst_stride, rotate, 4, 16);
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static void *rockchip_logo_rotate(struct logo_info *logo, void *src)
 {
 	void *dst_rotate;
@@ -1397,72 +1475,40 @@ static void *rockchip_logo_rotate(struct logo_info *logo, void *src)
 	int height = logo->height;
 	int width_rotate = logo->height & 0x3 ? (logo->height & ~0x3) + 4 : logo->height;
 	int height_rotate = logo->width;
-	int dst_size = width * height * logo->bpp >> 3;
-	int dst_size_rotate = width_rotate * height_rotate * logo->bpp >> 3;
 	int bytes_per_pixel = logo->bpp >> 3;
-	int padded_width;
-	int i, j;
-	char *img_data;
+	int dst_stride, dst_size_rotate;
+	int i;
 
 	if (!(logo->rotate == 90 || logo->rotate == 180 || logo->rotate == 270)) {
 		printf("Unsupported rotation angle\n");
 		return NULL;
 	}
 
-	img_data = (char *)malloc(dst_size);
-	if (!img_data) {
-		printf("failed to alloc memory for image data\n");
-		return NULL;
+	if (logo->rotate == 180) {
+		width_rotate = width;
+		height_rotate = height;
 	}
-	memcpy(img_data, src, dst_size);
+	dst_stride = width_rotate * bytes_per_pixel;
+	dst_size_rotate = dst_stride * height_rotate;
 
 	dst_rotate = get_display_buffer(dst_size_rotate);
 	if (!dst_rotate)
 		return NULL;
-	memset(dst_rotate, 0, dst_size_rotate);
-
-	switch (logo->rotate) {
-	case 90:
-		logo->width = width_rotate;
-		logo->height = height_rotate;
-		padded_width = height & 0x3 ? (height & ~0x3) + 4 : height;
-		for (i = 0; i < height; i++) {
-			for (j = 0; j < width; j++) {
-				memcpy(dst_rotate + (j * padded_width * bytes_per_pixel) +
-				       (height - i - 1) * bytes_per_pixel,
-				       img_data + i * width * bytes_per_pixel + j * bytes_per_pixel,
-				       bytes_per_pixel);
-			}
-		}
-		break;
-	case 180:
-		for (i = 0; i < height; i++) {
-			for (j = 0; j < width; j++) {
-				memcpy(dst_rotate + (height - i - 1) * width * bytes_per_pixel +
-				       (width - j - 1) * bytes_per_pixel,
-				       img_data + i * width * bytes_per_pixel + j * bytes_per_pixel,
-				       bytes_per_pixel);
-			}
-		}
-		break;
-	case 270:
-		logo->width = width_rotate;
-		logo->height = height_rotate;
-		padded_width = height & 0x3 ? (height & ~0x3) + 4 : height;
-		for (i = 0; i < height; i++) {
-			for (j = 0; j < width; j++) {
-				memcpy(dst_rotate + (width - j - 1) * padded_width * bytes_per_pixel +
-				       i * bytes_per_pixel,
-				       img_data + i * width * bytes_per_pixel + j * bytes_per_pixel,
-				       bytes_per_pixel);
-			}
-		}
-		break;
-	default:
-		break;
+
+	if (rockchip_rotate_image(dst_rotate, src, width, height, dst_stride,
+				  logo->bpp, logo->rotate))
+		return NULL;
+
+	/* Rows are padded to 4 pixels, clear what the image did not cover */
+	if (width_rotate > height && logo->rotate != 180) {
+		for (i = 0; i < height_rotate; i++)
+			memset(dst_rotate + i * dst_stride +
+			       height * bytes_per_pixel, 0,
+			       (width_rotate - height) * bytes_per_pixel);
 	}
 
-	free(img_data);
+	logo->width = width_rotate;
+	logo->height = height_rotate;
 
 	return dst_rotate;
 }
@@ -1543,21 +1589,28 @@ static int load_bmp_logo(struct logo_info *logo, const char *bmp_name)
 		}
 	}
 
-	dst = get_display_buffer(dst_size);
-	if (!dst) {
-		ret = -ENOMEM;
-		goto free_bmp_data;
-	}
-	bmp_copy(dst, &bmp);
-
+	/* A rotated logo is rotated straight out of the decoded bitmap */
 	if (logo->rotate) {
-		dst_rotate = rockchip_logo_rotate(logo, dst);
+		bmp_copy(bmp.bitmap, &bmp);
+		dst_rotate = rockchip_logo_rotate(logo, bmp.bitmap);
 		if (dst_rotate) {
 			dst = dst_rotate;
 			dst_size = logo->width * logo->height * logo->bpp >> 3;
 		}
 		printf("logo ratate %d\n", logo->rotate);
 	}
+
+	if (!dst) {
+		dst = get_display_buffer(dst_size);
+		if (!dst) {
+			ret = -ENOMEM;
+			goto free_bmp_data;
+		}
+		if (logo->rotate)
+			memcpy(dst, bmp.bitmap, dst_size);
+		else
+			bmp_copy(dst, &bmp);
+	}
 	logo->mem = dst;
 
 	memcpy(&logo_cache->logo, logo, sizeof(*logo));
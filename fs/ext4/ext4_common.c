@@ -43,6 +43,21 @@ int ext4fs_indir2_blkno = -1;
 __le32 *ext4fs_indir3_block;
 int ext4fs_indir3_size;
 int ext4fs_indir3_blkno = -1;
+
+/*
+ * The extent that the last block lookup found, like ext4fs_indir*_block
+ * for indirect blocks, so that reading a file block by block only walks
+ * its extent tree once per extent. It is tagged with the root of the tree,
+ * which is held in the inode.
+ */
+struct ext4fs_ext_run {
+	__le32 root[INDIRECT_BLOCKS + 3];	/* copy of the inode's i_block */
+	uint32_t first;		/* first file block */
+	uint32_t len;		/* blocks, 0 if the cache is empty */
+	uint64_t start;		/* device block of @first, 0 for a hole */
+};
+
+static struct ext4fs_ext_run ext4fs_ext_cache;
 struct ext2_inode *g_parent_inode;
 static int symlinknest;
 
@@ -1615,7 +1630,49 @@ int ext4fs_read_inode(struct ext2_data *data, int ino, struct ext2_inode *inode)
 	return 1;
 }
 
-long int read_allocated_block(struct ext2_inode *inode, int fileblock)
+/*
+ * Look up @fileblock in the extent cache, see ext4fs_ext_cache. Returns
+ * the physical block, 0 for a hole, or -1 if the cache does not cover it.
+ */
+static long int ext4fs_ext_cache_find(struct ext2_inode *inode, int fileblock,
+				      int *count)
+{
+	struct ext4fs_ext_run *run = &ext4fs_ext_cache;
+
+	if (!run->len || fileblock < run->first ||
+	    fileblock - run->first >= run->len ||
+	    memcmp(run->root, &inode->b, sizeof(run->root)))
+		return -1;
+
+	if (count)
+		*count = run->first + run->len - fileblock;
+
+	return run->start ? run->start + (fileblock - run->first) : 0;
+}
+
+static void ext4fs_ext_cache_add(struct ext2_inode *inode, uint32_t first,
+				 uint32_t len, uint64_t start)
+{
+	struct ext4fs_ext_run *run = &ext4fs_ext_cache;
+
+	memcpy(run->root, &inode->b, sizeof(run->root));
+	run->first = first;
+	run->len = len;
+	run->start = start;
+}
+
+/*
+ * read_allocated_extent() - map a file block to a device block
+ *
+ * Also returns in @count how many file blocks from @fileblock on are
+ * mapped to consecutive device blocks, or are all a hole, so that a caller
+ * reading a file needs one call per extent rather than one per block.
+ * @count may be NULL. Files that are not extent mapped report 1 block.
+ *
+ * Return: the filesystem block, 0 for a hole, negative on error.
+ */
+long int read_allocated_extent(struct ext2_inode *inode, int fileblock,
+			       int *count)
 {
 	long int blknr;
 	int blksz;
@@ -1630,14 +1687,23 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root)
 		- get_fs()->dev_desc->log2blksz;
 
+	if (count)
+		*count = 1;
+
 	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL) {
 		long int startblock, endblock;
-		char *buf = zalloc(blksz);
-		if (!buf)
-			return -ENOMEM;
+		char *buf;
 		struct ext4_extent_header *ext_block;
 		struct ext4_extent *extent;
 		int i;
+
+		blknr = ext4fs_ext_cache_find(inode, fileblock, count);
+		if (blknr >= 0)
+			return blknr;
+
+		buf = zalloc(blksz);
+		if (!buf)
+			return -ENOMEM;
 		ext_block =
 			ext4fs_get_extent_block(ext4fs_root, buf,
 						(struct ext4_extent_header *)
@@ -1658,6 +1724,10 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 			if (startblock > fileblock) {
 				/* Sparse file */
 				free(buf);
+				ext4fs_ext_cache_add(inode, fileblock,
+						     startblock - fileblock, 0);
+				if (count)
+					*count = startblock - fileblock;
 				return 0;
 
 			} else if (fileblock < endblock) {
@@ -1665,6 +1735,11 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 				start = (start << 32) +
 					le32_to_cpu(extent[i].ee_start_lo);
 				free(buf);
+				ext4fs_ext_cache_add(inode, startblock,
+						     endblock - startblock,
+						     start);
+				if (count)
+					*count = endblock - fileblock;
 				return (fileblock - startblock) + start;
 			}
 		}
@@ -1958,6 +2033,11 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	return blknr;
 }
 
+long int read_allocated_block(struct ext2_inode *inode, int fileblock)
+{
+	return read_allocated_extent(inode, fileblock, NULL);
+}
+
 /**
  * ext4fs_reinit_global() - Reinitialize values of ext4 write implementation's
  *			    global pointers
@@ -1972,6 +2052,7 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
  */
 void ext4fs_reinit_global(void)
 {
+	memset(&ext4fs_ext_cache, 0, sizeof(ext4fs_ext_cache));
 	if (ext4fs_indir1_block != NULL) {
 		free(ext4fs_indir1_block);
 		ext4fs_indir1_block = NULL;
@@ -2005,6 +2086,215 @@ void ext4fs_close(void)
 	ext4fs_reinit_global();
 }
 
+/* Allocate a node for @dirent in @diro, and find out its type */
+static struct ext2fs_node *ext4fs_dirent_node(struct ext2fs_node *diro,
+					      struct ext2_dirent *dirent,
+					      int *ftype)
+{
+	struct ext2fs_node *fdiro;
+	int type = FILETYPE_UNKNOWN;
+	int status;
+
+	fdiro = zalloc(sizeof(struct ext2fs_node));
+	if (!fdiro)
+		return NULL;
+
+	fdiro->data = diro->data;
+	fdiro->ino = le32_to_cpu(dirent->inode);
+
+	if (dirent->filetype != FILETYPE_UNKNOWN) {
+		fdiro->inode_read = 0;
+
+		if (dirent->filetype == FILETYPE_DIRECTORY)
+			type = FILETYPE_DIRECTORY;
+		else if (dirent->filetype == FILETYPE_SYMLINK)
+			type = FILETYPE_SYMLINK;
+		else if (dirent->filetype == FILETYPE_REG)
+			type = FILETYPE_REG;
+	} else {
+		status = ext4fs_read_inode(diro->data,
+					   le32_to_cpu(dirent->inode),
+					   &fdiro->inode);
+		if (status == 0) {
+			free(fdiro);
+			return NULL;
+		}
+		fdiro->inode_read = 1;
+
+		if ((le16_to_cpu(fdiro->inode.mode) &
+		     FILETYPE_INO_MASK) == FILETYPE_INO_DIRECTORY) {
+			type = FILETYPE_DIRECTORY;
+		} else if ((le16_to_cpu(fdiro->inode.mode)
+			    & FILETYPE_INO_MASK) == FILETYPE_INO_SYMLINK) {
+			type = FILETYPE_SYMLINK;
+		} else if ((le16_to_cpu(fdiro->inode.mode)
+			    & FILETYPE_INO_MASK) == FILETYPE_INO_REG) {
+			type = FILETYPE_REG;
+		}
+	}
+
+	*ftype = type;
+
+	return fdiro;
+}
+
+#ifdef CONFIG_EXT4_DIR_INDEX
+static int ext4fs_dx_read_block(struct ext2fs_node *diro, uint32_t block,
+				char *buf)
+{
+	int blksz = EXT2_BLOCK_SIZE(diro->data);
+	loff_t actread;
+
+	if (ext4fs_read_file(diro, (loff_t)block * blksz, blksz, buf,
+			     &actread) < 0 || actread != blksz)
+		return -EIO;
+
+	return 0;
+}
+
+/*
+ * Scan directory block @buf for @name. Returns 1 and the node if found,
+ * 0 if not, or -EINVAL if the block is corrupt.
+ */
+static int ext4fs_dx_scan_leaf(struct ext2fs_node *diro, char *buf,
+			       const char *name, struct ext2fs_node **fnode,
+			       int *ftype)
+{
+	int blksz = EXT2_BLOCK_SIZE(diro->data);
+	int namelen = strlen(name);
+	struct ext2_dirent *dirent;
+	int pos, len;
+
+	for (pos = 0; pos + sizeof(*dirent) <= blksz; pos += len) {
+		dirent = (struct ext2_dirent *)(buf + pos);
+		len = le16_to_cpu(dirent->direntlen);
+		if (len < sizeof(*dirent) || pos + len > blksz ||
+		    dirent->namelen > len - sizeof(*dirent))
+			return -EINVAL;
+
+		if (!dirent->inode || dirent->namelen != namelen ||
+		    memcmp(dirent + 1, name, namelen))
+			continue;
+
+		*fnode = ext4fs_dirent_node(diro, dirent, ftype);
+
+		return *fnode ? 1 : -ENOMEM;
+	}
+
+	return 0;
+}
+
+/*
+ * Look @name up in the hash tree of an indexed directory, as Linux's
+ * dx_probe() does: pick the last index entry whose hash is not above the
+ * name's at each level, then scan the leaf block it points to. Names that
+ * share a hash may spill into the following leaves, these are flagged by
+ * the low bit of the next entry's hash.
+ *
+ * Return: 1 if found, 0 if not, or negative if the index cannot be used
+ * and the caller should scan the directory linearly.
+ */
+static int ext4fs_dx_find(struct ext2fs_node *diro, const char *name,
+			  struct ext2fs_node **fnode, int *ftype)
+{
+	struct ext2_sblock *sblock = &diro->data->sblock;
+	int blksz = EXT2_BLOCK_SIZE(diro->data);
+	struct dx_root_info *info;
+	struct dx_countlimit *cl;
+	struct dx_entry *entries, *p, *q, *at;
+	int version, indirect, levels, count, limit, ret;
+	uint32_t hash, block;
+	char *buf, *leaf;
+
+	buf = zalloc(blksz);
+	leaf = zalloc(blksz);
+	if (!buf || !leaf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	ret = ext4fs_dx_read_block(diro, 0, buf);
+	if (ret)
+		goto out;
+
+	/* The root info follows the 12 byte '.' and '..' entries */
+	ret = -EINVAL;
+	info = (struct dx_root_info *)(buf + 24);
+	if (info->reserved_zero || info->info_length != sizeof(*info) ||
+	    info->indirect_levels > 2)
+		goto out;
+
+	indirect = info->indirect_levels;
+	version = info->hash_version;
+	if (version <= DX_HASH_TEA &&
+	    (le32_to_cpu(sblock->flags) & EXT2_FLAGS_UNSIGNED_HASH))
+		version += DX_HASH_LEGACY_UNSIGNED;
+	if (ext4fs_dirhash(name, strlen(name), version, sblock->hash_seed,
+			   &hash))
+		goto out;
+
+	entries = (struct dx_entry *)((char *)info + info->info_length);
+	for (levels = indirect; ; levels--) {
+		cl = (struct dx_countlimit *)entries;
+		count = le16_to_cpu(cl->count);
+		limit = le16_to_cpu(cl->limit);
+		if (!count || count > limit ||
+		    (char *)(entries + limit) > buf + blksz)
+			goto out;
+
+		/* Last entry with a hash that is not above ours */
+		p = entries + 1;
+		q = entries + count - 1;
+		while (p <= q) {
+			at = p + (q - p) / 2;
+			if (le32_to_cpu(at->hash) > hash)
+				q = at - 1;
+			else
+				p = at + 1;
+		}
+		at = p - 1;
+		block = le32_to_cpu(at->block) & 0x0fffffff;
+
+		if (!levels)
+			break;
+
+		/* Interior index blocks start with an empty dirent */
+		ret = ext4fs_dx_read_block(diro, block, buf);
+		if (ret)
+			goto out;
+		ret = -EINVAL;
+		entries = (struct dx_entry *)(buf + 8);
+	}
+
+	while (1) {
+		ret = ext4fs_dx_read_block(diro, block, leaf);
+		if (ret)
+			goto out;
+
+		ret = ext4fs_dx_scan_leaf(diro, leaf, name, fnode, ftype);
+		if (ret)
+			goto out;
+
+		/* Continue into the next leaf only for the same hash */
+		if (++at >= entries + count) {
+			/* It is in another index block, let the caller scan */
+			if (indirect)
+				ret = -EAGAIN;
+			goto out;
+		}
+		if ((le32_to_cpu(at->hash) & ~1) != hash)
+			goto out;
+		block = le32_to_cpu(at->block) & 0x0fffffff;
+	}
+
+out:
+	free(leaf);
+	free(buf);
+
+	return ret;
+}
+#endif
+
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 				struct ext2fs_node **fnode, int *ftype)
 {
@@ -2022,6 +2312,17 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 		if (status == 0)
 			return 0;
 	}
+
+#ifdef CONFIG_EXT4_DIR_INDEX
+	if (name && fnode && ftype &&
+	    (le32_to_cpu(diro->inode.flags) & EXT4_INDEX_FL)) {
+		status = ext4fs_dx_find(diro, name, fnode, ftype);
+		if (status >= 0)
+			return status;
+		debug("%s: no usable index, scanning directory\n", __func__);
+	}
+#endif
+
 	/* Search the file.  */
 	while (fpos < le32_to_cpu(diro->inode.size)) {
 		struct ext2_dirent dirent;
@@ -2050,49 +2351,11 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			if (status < 0)
 				return 0;
 
-			fdiro = zalloc(sizeof(struct ext2fs_node));
+			fdiro = ext4fs_dirent_node(diro, &dirent, &type);
 			if (!fdiro)
 				return 0;
 
-			fdiro->data = diro->data;
-			fdiro->ino = le32_to_cpu(dirent.inode);
-
 			filename[dirent.namelen] = '\0';
-
-			if (dirent.filetype != FILETYPE_UNKNOWN) {
-				fdiro->inode_read = 0;
-
-				if (dirent.filetype == FILETYPE_DIRECTORY)
-					type = FILETYPE_DIRECTORY;
-				else if (dirent.filetype == FILETYPE_SYMLINK)
-					type = FILETYPE_SYMLINK;
-				else if (dirent.filetype == FILETYPE_REG)
-					type = FILETYPE_REG;
-			} else {
-				status = ext4fs_read_inode(diro->data,
-							   le32_to_cpu
-							   (dirent.inode),
-							   &fdiro->inode);
-				if (status == 0) {
-					free(fdiro);
-					return 0;
-				}
-				fdiro->inode_read = 1;
-
-				if ((le16_to_cpu(fdiro->inode.mode) &
-				     FILETYPE_INO_MASK) ==
-				    FILETYPE_INO_DIRECTORY) {
-					type = FILETYPE_DIRECTORY;
-				} else if ((le16_to_cpu(fdiro->inode.mode)
-					    & FILETYPE_INO_MASK) ==
-					   FILETYPE_INO_SYMLINK) {
-					type = FILETYPE_SYMLINK;
-				} else if ((le16_to_cpu(fdiro->inode.mode)
-					    & FILETYPE_INO_MASK) ==
-					   FILETYPE_INO_REG) {
-					type = FILETYPE_REG;
-				}
-			}
 #ifdef DEBUG
 			printf("iterate >%s<\n", filename);
 #endif /* of DEBUG */
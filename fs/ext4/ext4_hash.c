@@ -0,0 +1,183 @@
+/*
+ * Directory index hashes, as used by ext3/ext4 HTree directories.
+ *
+ * Based on fs/ext4/hash.c from Linux:
+ * Copyright (C) 2002 by Theodore Ts'o
+ *
+ * SPDX-License-Identifier:	GPL-2.0
+ */
+
+#include <common.h>
+#include <ext4fs.h>
+#include <ext_common.h>
+#include "ext4_common.h"
+
+#define DELTA		0x9E3779B9
+
+#define ROL32(x, s)	(((x) << (s)) | ((x) >> (32 - (s))))
+
+static void tea_transform(u32 buf[4], const u32 in[])
+{
+	u32 sum = 0;
+	u32 b0 = buf[0], b1 = buf[1];
+	u32 a = in[0], b = in[1], c = in[2], d = in[3];
+	int n = 16;
+
+	do {
+		sum += DELTA;
+		b0 += ((b1 << 4) + a) ^ (b1 + sum) ^ ((b1 >> 5) + b);
+		b1 += ((b0 << 4) + c) ^ (b0 + sum) ^ ((b0 >> 5) + d);
+	} while (--n);
+
+	buf[0] += b0;
+	buf[1] += b1;
+}
+
+/* F, G and H are basic MD4 functions: selection, majority, parity */
+#define F(x, y, z)	((z) ^ ((x) & ((y) ^ (z))))
+#define G(x, y, z)	(((x) & (y)) + (((x) ^ (y)) & (z)))
+#define H(x, y, z)	((x) ^ (y) ^ (z))
+
+#define MD4_ROUND(f, a, b, c, d, x, s)	\
+	(a += f(b, c, d) + x, a = ROL32(a, s))
+#define K1	0
+#define K2	013240474631UL
+#define K3	015666365641UL
+
+/* Basic cut-down MD4 transform */
+static void half_md4_transform(u32 buf[4], const u32 in[8])
+{
+	u32 a = buf[0], b = buf[1], c = buf[2], d = buf[3];
+
+	/* Round 1 */
+	MD4_ROUND(F, a, b, c, d, in[0] + K1,  3);
+	MD4_ROUND(F, d, a, b, c, in[1] + K1,  7);
+	MD4_ROUND(F, c, d, a, b, in[2] + K1, 11);
+	MD4_ROUND(F, b, c, d, a, in[3] + K1, 19);
+	MD4_ROUND(F, a, b, c, d, in[4] + K1,  3);
+	MD4_ROUND(F, d, a, b, c, in[5] + K1,  7);
+	MD4_ROUND(F, c, d, a, b, in[6] + K1, 11);
+	MD4_ROUND(F, b, c, d, a, in[7] + K1, 19);
+
+	/* Round 2 */
+	MD4_ROUND(G, a, b, c, d, in[1] + K2,  3);
+	MD4_ROUND(G, d, a, b, c, in[3] + K2,  5);
+	MD4_ROUND(G, c, d, a, b, in[5] + K2,  9);
+	MD4_ROUND(G, b, c, d, a, in[7] + K2, 13);
+	MD4_ROUND(G, a, b, c, d, in[0] + K2,  3);
+	MD4_ROUND(G, d, a, b, c, in[2] + K2,  5);
+	MD4_ROUND(G, c, d, a, b, in[4] + K2,  9);
+	MD4_ROUND(G, b, c, d, a, in[6] + K2, 13);
+
+	/* Round 3 */
+	MD4_ROUND(H, a, b, c, d, in[3] + K3,  3);
+	MD4_ROUND(H, d, a, b, c, in[7] + K3,  9);
+	MD4_ROUND(H, c, d, a, b, in[2] + K3, 11);
+	MD4_ROUND(H, b, c, d, a, in[6] + K3, 15);
+	MD4_ROUND(H, a, b, c, d, in[1] + K3,  3);
+	MD4_ROUND(H, d, a, b, c, in[5] + K3,  9);
+	MD4_ROUND(H, c, d, a, b, in[0] + K3, 11);
+	MD4_ROUND(H, b, c, d, a, in[4] + K3, 15);
+
+	buf[0] += a;
+	buf[1] += b;
+	buf[2] += c;
+	buf[3] += d;
+}
+
+/* The old legacy hash, @uns picks how the name's chars are extended */
+static u32 dx_hack_hash(const char *name, int len, bool uns)
+{
+	u32 hash, hash0 = 0x12a3fe2d, hash1 = 0x37abe8f9;
+	int c;
+
+	while (len--) {
+		c = uns ? (int)(unsigned char)*name : (int)(signed char)*name;
+		name++;
+		hash = hash1 + (hash0 ^ (c * 7152373));
+
+		if (hash & 0x80000000)
+			hash -= 0x7fffffff;
+		hash1 = hash0;
+		hash0 = hash;
+	}
+
+	return hash0 << 1;
+}
+
+static void str2hashbuf(const char *msg, int len, u32 *buf, int num,
+			bool uns)
+{
+	u32 pad, val;
+	int i, c;
+
+	pad = (u32)len | ((u32)len << 8);
+	pad |= pad << 16;
+
+	val = pad;
+	if (len > num * 4)
+		len = num * 4;
+	for (i = 0; i < len; i++) {
+		c = uns ? (int)(unsigned char)msg[i] : (int)(signed char)msg[i];
+		val = c + (val << 8);
+		if ((i % 4) == 3) {
+			*buf++ = val;
+			val = pad;
+			num--;
+		}
+	}
+	if (--num >= 0)
+		*buf++ = val;
+	while (--num >= 0)
+		*buf++ = pad;
+}
+
+int ext4fs_dirhash(const char *name, int len, int version,
+		   const __le32 seed[4], u32 *hash)
+{
+	u32 buf[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+	bool uns = version >= DX_HASH_LEGACY_UNSIGNED;
+	u32 in[8];
+	int i;
+
+	/* A zero seed means the default one */
+	for (i = 0; i < 4; i++) {
+		if (seed[i])
+			break;
+	}
+	if (i < 4) {
+		for (i = 0; i < 4; i++)
+			buf[i] = le32_to_cpu(seed[i]);
+	}
+
+	switch (version) {
+	case DX_HASH_LEGACY:
+	case DX_HASH_LEGACY_UNSIGNED:
+		*hash = dx_hack_hash(name, len, uns);
+		break;
+	case DX_HASH_HALF_MD4:
+	case DX_HASH_HALF_MD4_UNSIGNED:
+		for (; len > 0; len -= 32, name += 32) {
+			str2hashbuf(name, len, in, 8, uns);
+			half_md4_transform(buf, in);
+		}
+		*hash = buf[1];
+		break;
+	case DX_HASH_TEA:
+	case DX_HASH_TEA_UNSIGNED:
+		for (; len > 0; len -= 16, name += 16) {
+			str2hashbuf(name, len, in, 4, uns);
+			tea_transform(buf, in);
+		}
+		*hash = buf[0];
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	*hash &= ~1;
+	if (*hash == (EXT4_HTREE_EOF_32BIT << 1))
+		*hash = (EXT4_HTREE_EOF_32BIT - 1) << 1;
+
+	return 0;
+}
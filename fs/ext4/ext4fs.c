@@ -62,6 +62,8 @@ int ext4fs_read_file(struct ext2fs_node *node, loff_t pos,
 	lbaint_t delayed_skipfirst = 0;
 	lbaint_t delayed_next = 0;
 	char *delayed_buf = NULL;
+	long int run_blknr = 0;
+	int run_start = 0, run_end = 0;
 	short status;
 
 	if (blocksize <= 0)
@@ -78,9 +80,18 @@ int ext4fs_read_file(struct ext2fs_node *node, loff_t pos,
 		int blockoff = pos - (blocksize * i);
 		int blockend = blocksize;
 		int skipfirst = 0;
-		blknr = read_allocated_block(&(node->inode), i);
-		if (blknr < 0)
-			return -1;
+		int count;
+
+		/* Map a whole extent at a time */
+		if (i >= run_end) {
+			run_blknr = read_allocated_extent(&node->inode, i,
+							  &count);
+			if (run_blknr < 0)
+				return -1;
+			run_start = i;
+			run_end = i + count;
+		}
+		blknr = run_blknr ? run_blknr + (i - run_start) : 0;
 
 		blknr = blknr << log2_fs_blocksize;
 
@@ -161,6 +161,70 @@ int flush_dirty_fat_buffer(fsdata *mydata)
 }
 #endif
 
+/*
+ * The FAT cache holds the whole of the first FAT, read in chunks of
+ * FAT_CACHE_CHUNK bytes the first time an entry in them is needed. It
+ * only lives as long as the fsdata, and is not used when writing.
+ */
+#define FAT_CACHE_CHUNK	0x8000
+
+static void fat_cache_init(fsdata *mydata)
+{
+	__u32 size = mydata->fatlength * mydata->sect_size;
+
+	mydata->fatcache = NULL;
+	mydata->fatcache_valid = NULL;
+
+	if (!size || size > CONFIG_FS_FAT_CACHE_SIZE ||
+	    mydata->sect_size > FAT_CACHE_CHUNK)
+		return;
+
+	mydata->fatcache = malloc_cache_aligned(size);
+	mydata->fatcache_valid = calloc(DIV_ROUND_UP(size, FAT_CACHE_CHUNK),
+					1);
+	if (!mydata->fatcache || !mydata->fatcache_valid) {
+		/* Fall back to reading the FAT through fatbuf */
+		free(mydata->fatcache);
+		free(mydata->fatcache_valid);
+		mydata->fatcache = NULL;
+		mydata->fatcache_valid = NULL;
+	}
+}
+
+/* Make sure bytes 'start' to 'end' of the FAT are in the cache */
+static int fat_cache_fill(fsdata *mydata, __u32 start, __u32 end)
+{
+	__u32 chunk_sects = FAT_CACHE_CHUNK / mydata->sect_size;
+	__u32 chunk, sect, count;
+
+	if (end >= mydata->fatlength * mydata->sect_size)
+		return -1;
+
+	for (chunk = start / FAT_CACHE_CHUNK;
+	     chunk <= end / FAT_CACHE_CHUNK; chunk++) {
+		if (mydata->fatcache_valid[chunk])
+			continue;
+
+		sect = chunk * chunk_sects;
+		count = min(chunk_sects, mydata->fatlength - sect);
+		if (disk_read(mydata->fat_sect + sect, count,
+			      mydata->fatcache + sect * mydata->sect_size) < 0) {
+			debug("Error reading FAT blocks\n");
+			return -1;
+		}
+		mydata->fatcache_valid[chunk] = 1;
+	}
+
+	return 0;
+}
+
+static void free_fs_info(fsdata *mydata)
+{
+	free(mydata->fatbuf);
+	free(mydata->fatcache);
+	free(mydata->fatcache_valid);
+}
+
 /*
  * Get the entry at index 'entry' in a FAT (12/16/32) table.
  * On failure 0x00 is returned.
@@ -170,12 +234,42 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 	__u32 bufnum;
 	__u32 offset, off8;
 	__u32 ret = 0x00;
+	__u8 *fatbuf = mydata->fatbuf;
 
 	if (CHECK_CLUST(entry, mydata->fatsize)) {
 		printf("Error: Invalid FAT entry: 0x%08x\n", entry);
 		return ret;
 	}
 
+	if (mydata->fatcache) {
+		__u32 first, last;
+
+		/* Bytes of the FAT the entry is in */
+		switch (mydata->fatsize) {
+		case 32:
+			first = entry * 4;
+			last = first + 3;
+			break;
+		case 16:
+			first = entry * 2;
+			last = first + 1;
+			break;
+		case 12:
+			first = (entry * 3) / 2;
+			last = first + 1;
+			break;
+		default:
+			/* Unsupported FAT size */
+			return ret;
+		}
+		if (fat_cache_fill(mydata, first, last))
+			return ret;
+
+		fatbuf = mydata->fatcache;
+		offset = entry;
+		goto get_entry;
+	}
+
 	switch (mydata->fatsize) {
 	case 32:
 		bufnum = entry / FAT32BUFSIZE;
@@ -222,18 +316,19 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 		mydata->fatbufnum = bufnum;
 	}
 
+get_entry:
 	/* Get the actual entry from the table */
 	switch (mydata->fatsize) {
 	case 32:
-		ret = FAT2CPU32(((__u32 *) mydata->fatbuf)[offset]);
+		ret = FAT2CPU32(((__u32 *)fatbuf)[offset]);
 		break;
 	case 16:
-		ret = FAT2CPU16(((__u16 *) mydata->fatbuf)[offset]);
+		ret = FAT2CPU16(((__u16 *)fatbuf)[offset]);
 		break;
 	case 12:
 		off8 = (offset * 3) / 2;
 		/* fatbut + off8 may be unaligned, read in byte granularity */
-		ret = mydata->fatbuf[off8] + (mydata->fatbuf[off8 + 1] << 8);
+		ret = fatbuf[off8] + (fatbuf[off8 + 1] << 8);
 
 		if (offset & 0x1)
 			ret >>= 4;
@@ -604,6 +699,7 @@ static int get_fs_info(fsdata *mydata)
 		debug("Error: allocating memory\n");
 		return -1;
 	}
+	fat_cache_init(mydata);
 
 	if (vfat_enabled)
 		debug("VFAT Support enabled\n");
@@ -1045,7 +1141,7 @@ int fat_exists(const char *filename)
 		goto out;
 
 	ret = fat_itr_resolve(itr, filename, TYPE_ANY);
-	free(fsdata.fatbuf);
+	free_fs_info(&fsdata);
 out:
 	free(itr);
 	return ret == 0;
@@ -1070,7 +1166,7 @@ int fat_size(const char *filename, loff_t *size)
 		 * Directories don't have size, but fs_size() is not
 		 * expected to fail if passed a directory path:
 		 */
-		free(fsdata.fatbuf);
+		free_fs_info(&fsdata);
 		fat_itr_root(itr, &fsdata);
 		if (!fat_itr_resolve(itr, filename, TYPE_DIR)) {
 			*size = 0;
@@ -1081,7 +1177,7 @@ int fat_size(const char *filename, loff_t *size)
 
 	*size = FAT2CPU32(itr->dent->size);
 out_free_both:
-	free(fsdata.fatbuf);
+	free_fs_info(&fsdata);
 out_free_itr:
 	free(itr);
 	return ret;
@@ -1109,7 +1205,7 @@ int file_fat_read_at(const char *filename, loff_t pos, void *buffer,
 	ret = get_contents(&fsdata, itr->dent, pos, buffer, maxsize, actread);
 
 out_free_both:
-	free(fsdata.fatbuf);
+	free_fs_info(&fsdata);
 out_free_itr:
 	free(itr);
 	return ret;
@@ -1166,7 +1262,7 @@ int fat_opendir(const char *filename, struct fs_dir_stream **dirsp)
 	return 0;
 
 fail_free_both:
-	free(dir->fsdata.fatbuf);
+	free_fs_info(&dir->fsdata);
 fail_free_dir:
 	free(dir);
 	return ret;
@@ -1198,7 +1294,7 @@ int fat_readdir(struct fs_dir_stream *dirs, struct fs_dirent **dentp)
 void fat_closedir(struct fs_dir_stream *dirs)
 {
 	fat_dir *dir = (fat_dir *)dirs;
-	free(dir->fsdata.fatbuf);
+	free_fs_info(&dir->fsdata);
 	free(dir);
 }
 
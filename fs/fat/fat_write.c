@@ -958,6 +958,9 @@ static int do_fat_write(const char *filename, void *buffer, loff_t size,
 
 	mydata->fatbufnum = -1;
 	mydata->fat_dirty = 0;
+	/* Entries are changed through fatbuf, so don't cache the FAT */
+	mydata->fatcache = NULL;
+	mydata->fatcache_valid = NULL;
 	mydata->fatbuf = memalign(ARCH_DMA_MINALIGN, FATBUFSIZE);
 	if (mydata->fatbuf == NULL) {
 		debug("Error: allocating memory\n");
@@ -1071,7 +1074,7 @@ static int do_fat_write(const char *filename, void *buffer, loff_t size,
 		printf("Error: writing directory entry\n");
 
 exit:
-	free(mydata->fatbuf);
+	free_fs_info(mydata);
 	return ret;
 }
 
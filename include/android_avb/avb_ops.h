@@ -340,8 +340,27 @@ struct AvbOps {
       size_t public_key_metadata_length,
       bool* out_is_trusted,
       uint32_t* out_rollback_index_location);
+
+  /* Set by avb_slot_verify() while it loads a partition it is about to
+   * hash, NULL otherwise. read_from_partition() may pass what it read to
+   * avb_read_hash_update() as soon as each piece arrives, so that hashing
+   * overlaps the rest of the I/O instead of following it.
+   */
+  struct AvbReadHash* read_hash;
 };
 
+/* Feeds |num_bytes| of |partition| read from |offset| into |buffer| to the
+ * hash set up in |ops->read_hash|. Data that is not next in the partition
+ * is ignored, avb_slot_verify() hashes whatever was not passed in after
+ * the load. The hash may still be reading |buffer| when this returns, so
+ * it must be where the partition is being loaded to.
+ */
+void avb_read_hash_update(AvbOps* ops,
+                          const char* partition,
+                          int64_t offset,
+                          const uint8_t* buffer,
+                          size_t num_bytes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,9 @@ extern "C" {
 #include <android_avb/avb_sysdeps.h>
 #include <dm/device.h>
 #include <u-boot/sha256.h>
+#ifdef CONFIG_SHA512
+#include <u-boot/sha512.h>
+#endif
 
 /* Block size in bytes of a SHA-256 digest. */
 #define AVB_SHA256_BLOCK_SIZE 64
@@ -75,6 +78,9 @@ typedef struct {
   struct udevice *crypto_dev;
   sha_context crypto_ctx;
 #endif
+#ifdef CONFIG_SHA512
+  sha512_context sha512ctx;
+#endif
 } AvbSHA512Ctx;
 
 /* Initializes the SHA-256 context. */
@@ -125,6 +125,10 @@ struct blk_desc {
 	void		*priv;		/* driver private struct pointer */
 #endif
 
+#ifdef CONFIG_BLK_ASYNC
+	struct blk_req	*req_head;	/* async requests, head is in flight */
+	struct blk_req	*req_tail;
+#endif
 	uspinlock_t	blk_lock;
 };
 
@@ -174,6 +178,35 @@ void blkcache_fill(int iftype, int dev,
  */
 void blkcache_invalidate(int iftype, int dev);
 
+/**
+ * blkcache_invalidate_range() - discard the cached blocks a write changes
+ *
+ * @param iftype - IF_TYPE_x for type of device
+ * @param dev - device index of particular type
+ * @param start - first block written
+ * @param blkcnt - number of blocks written
+ */
+void blkcache_invalidate_range(int iftype, int dev,
+			       lbaint_t start, lbaint_t blkcnt);
+
+/**
+ * blkcache_readahead() - size a read that missed the cache
+ *
+ * When a read starts where an earlier miss on the device ended, a larger
+ * window is read instead, with CONFIG_BLOCK_CACHE_READAHEAD. Filling the
+ * cache with that window then keeps it even if it is larger than an entry.
+ *
+ * @param iftype - IF_TYPE_x for type of device
+ * @param dev - device index of particular type
+ * @param start - starting block number
+ * @param blkcnt - number of blocks requested
+ * @param lba - number of blocks on the device
+ *
+ * @return - number of blocks to read from @start, at least @blkcnt
+ */
+lbaint_t blkcache_readahead(int iftype, int dev,
+			    lbaint_t start, lbaint_t blkcnt, lbaint_t lba);
+
 /**
  * blkcache_configure() - configure block cache
  *
@@ -191,6 +224,7 @@ struct block_cache_stats {
 	unsigned entries; /* current entry count */
 	unsigned max_blocks_per_entry;
 	unsigned max_entries;
+	unsigned readaheads;
 };
 
 /**
@@ -215,6 +249,16 @@ static inline void blkcache_fill(int iftype, int dev,
 
 static inline void blkcache_invalidate(int iftype, int dev) {}
 
+static inline void blkcache_invalidate_range(int iftype, int dev,
+					     lbaint_t start, lbaint_t blkcnt) {}
+
+static inline lbaint_t blkcache_readahead(int iftype, int dev,
+					  lbaint_t start, lbaint_t blkcnt,
+					  lbaint_t lba)
+{
+	return blkcnt;
+}
+
 #endif
 
 #if CONFIG_IS_ENABLED(BLK)
@@ -235,6 +279,33 @@ struct blk_ops {
 	unsigned long (*read)(struct udevice *dev, lbaint_t start,
 			      lbaint_t blkcnt, void *buffer);
 
+#ifdef CONFIG_BLK_ASYNC
+	/**
+	 * read_submit() - start a read without waiting for the data
+	 *
+	 * Only one read is in flight per device, the uclass does not submit
+	 * another one nor call any other op until read_poll() reports it done.
+	 *
+	 * @dev:	Device to read from
+	 * @start:	Start block number to read (0=first)
+	 * @blkcnt:	Number of blocks to read
+	 * @buffer:	Destination buffer for data read
+	 * @return 0 if started, -ENOSYS to fall back to read(), other -ve
+	 * error number on failure
+	 */
+	int (*read_submit)(struct udevice *dev, lbaint_t start,
+			   lbaint_t blkcnt, void *buffer);
+
+	/**
+	 * read_poll() - check the read started by read_submit()
+	 *
+	 * @dev:	Device to check
+	 * @return number of blocks read once done, -EINPROGRESS while the
+	 * read is in flight, or other -ve error number
+	 */
+	long (*read_poll)(struct udevice *dev);
+#endif
+
 	/**
 	 * write() - write to a block device
 	 *
@@ -290,6 +361,20 @@ struct blk_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*select_hwpart)(struct udevice *dev, int hwpart);
+
+	/**
+	 * map() - get the memory backing a range of blocks
+	 *
+	 * Only for devices whose blocks are plain memory, such as a RAM disk.
+	 * It lets callers use the data in place instead of reading a copy.
+	 *
+	 * @dev:	Device to map
+	 * @start:	Start block number to map (0=first)
+	 * @blkcnt:	Number of blocks to map
+	 * @return pointer to block @start, the @blkcnt blocks following it in
+	 * memory, or NULL if the range cannot be mapped
+	 */
+	void *(*map)(struct udevice *dev, lbaint_t start, lbaint_t blkcnt);
 };
 
 #define blk_get_ops(dev)	((struct blk_ops *)(dev)->driver->ops)
@@ -309,6 +394,86 @@ unsigned long blk_dwrite_zeroes(struct blk_desc *block_dev, lbaint_t start,
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt);
 
+/**
+ * blk_dmap() - get the memory backing a range of blocks
+ *
+ * The data must only be read through the pointer, and it is only valid
+ * until the blocks are written.
+ *
+ * @block_dev:	Block device to map
+ * @start:	Start block number to map
+ * @blkcnt:	Number of blocks to map
+ * @return pointer to the data of block @start, or NULL if the device is
+ * not memory-backed and the blocks must be read with blk_dread()
+ */
+void *blk_dmap(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt);
+
+enum blk_req_state {
+	BLK_REQ_IDLE = 0,
+	BLK_REQ_QUEUED,
+	BLK_REQ_ACTIVE,
+	BLK_REQ_DONE,
+};
+
+/*
+ * struct blk_req - an asynchronous read and its completion.
+ *
+ * The request memory is owned by the caller and must stay valid until
+ * blk_req_wait() returns or blk_req_poll() reports it done.
+ */
+struct blk_req {
+	struct blk_req *next;
+	lbaint_t start;
+	lbaint_t blkcnt;
+	void *buffer;
+	enum blk_req_state state;
+	long ret;		/* number of blocks read, or -ve error */
+};
+
+#ifdef CONFIG_BLK_ASYNC
+/**
+ * blk_dread_submit() - queue a read on a block device
+ *
+ * Requests on a device complete in submission order. Devices without the
+ * read_submit() op read synchronously when the request reaches the queue
+ * head, so callers never need a blocking fallback path.
+ *
+ * @block_dev:	Block device to read from
+ * @req:	Caller owned request
+ * @start:	Start block number to read (0=first)
+ * @blkcnt:	Number of blocks to read
+ * @buffer:	Destination buffer for data read
+ * @return 0 if queued, -ve on error
+ */
+int blk_dread_submit(struct blk_desc *block_dev, struct blk_req *req,
+		     lbaint_t start, lbaint_t blkcnt, void *buffer);
+
+/**
+ * blk_req_poll() - advance the device queue without blocking
+ *
+ * @block_dev:	Block device the request was submitted to
+ * @req:	Request to check
+ * @return true if @req is done
+ */
+bool blk_req_poll(struct blk_desc *block_dev, struct blk_req *req);
+
+/**
+ * blk_req_wait() - wait for a request to complete
+ *
+ * @block_dev:	Block device the request was submitted to
+ * @req:	Request to wait for
+ * @return number of blocks read, or -ve error number
+ */
+long blk_req_wait(struct blk_desc *block_dev, struct blk_req *req);
+
+/**
+ * blk_req_drain() - complete all requests queued on a device
+ *
+ * @block_dev:	Block device to drain
+ */
+void blk_req_drain(struct blk_desc *block_dev);
+#endif
+
 /**
  * blk_find_device() - Find a block device
  *
@@ -473,17 +638,25 @@ static inline ulong blk_dread(struct blk_desc *block_dev, lbaint_t start,
 static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt, const void *buffer)
 {
-	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	blkcache_invalidate_range(block_dev->if_type, block_dev->devnum,
+				  start, blkcnt);
 	return block_dev->block_write(block_dev, start, blkcnt, buffer);
 }
 
 static inline ulong blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt)
 {
-	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	blkcache_invalidate_range(block_dev->if_type, block_dev->devnum,
+				  start, blkcnt);
 	return block_dev->block_erase(block_dev, start, blkcnt);
 }
 
+static inline void *blk_dmap(struct blk_desc *block_dev, lbaint_t start,
+			     lbaint_t blkcnt)
+{
+	return NULL;
+}
+
 /**
  * struct blk_driver - Driver for block interface types
  *
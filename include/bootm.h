@@ -56,6 +56,20 @@ int do_bootm_states(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 
 void arch_preboot_os(uint32_t bootm_state, bootm_headers_t *images);
 
+/**
+ * arch_preload_os() - look at the OS before it is loaded
+ *
+ * This is called for Linux kernels before they are loaded or decompressed
+ * to images->os.load, so that they can be put where they are going to
+ * run rather than moved there later. It may change images->os.load and
+ * images->ep.
+ *
+ * @images:	images being booted
+ * @head:	start of the uncompressed kernel
+ * @size:	number of bytes at @head
+ */
+void arch_preload_os(bootm_headers_t *images, const void *head, ulong size);
+
 int board_do_bootm(int argc, char * const argv[]);
 
 /**
@@ -17,6 +17,17 @@
 #define CONFIG_BOOTSTAGE_USER_COUNT	20
 #endif
 
+/* Room for one "<name> +<time>" entry in /chosen */
+#define BOOTSTAGE_CHOSEN_ENTRY_LEN	48
+
+/* Room bootstage_fdt_add_chosen() needs in the OS device tree */
+#ifdef CONFIG_BOOTSTAGE_CHOSEN
+#define BOOTSTAGE_CHOSEN_SIZE	\
+	(CONFIG_BOOTSTAGE_RECORD_COUNT * BOOTSTAGE_CHOSEN_ENTRY_LEN + 128)
+#else
+#define BOOTSTAGE_CHOSEN_SIZE	0
+#endif
+
 /* Flags for each bootstage record */
 enum bootstage_flags {
 	BOOTSTAGEF_ERROR	= 1 << 0,	/* Error record */
@@ -205,6 +216,11 @@ enum bootstage_id {
 	BOOTSTATE_ID_ACCUM_DM_SPL,
 	BOOTSTATE_ID_ACCUM_DM_F,
 	BOOTSTATE_ID_ACCUM_DM_R,
+	BOOTSTAGE_ID_ACCUM_FIT_LOAD,
+	BOOTSTAGE_ID_ACCUM_STORAGE,
+	BOOTSTAGE_ID_ACCUM_IMAGE_LOAD,
+	BOOTSTAGE_ID_ACCUM_AVB,
+	BOOTSTAGE_ID_ACCUM_FDT_FIXUP,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -321,6 +337,20 @@ void bootstage_report(void);
  */
 int bootstage_fdt_add_report(void);
 
+/**
+ * bootstage_fdt_add_chosen() - Pass the boot timing to the OS in /chosen
+ *
+ * Adds a 'u-boot,bootstage' string list to /chosen of @blob, one
+ * "<name> <mark>" or "<name> +<accum>" entry per record in microseconds,
+ * sorted by time. With CONFIG_BOOTSTAGE_STASH the records are also stashed
+ * at CONFIG_BOOTSTAGE_STASH_ADDR, which is reserved in @blob and pointed to
+ * by 'u-boot,bootstage-stash'.
+ *
+ * @blob:	OS device tree, with BOOTSTAGE_CHOSEN_SIZE bytes free
+ * @return 0 if ok, -ve on error
+ */
+int bootstage_fdt_add_chosen(void *blob);
+
 /**
  * Stash bootstage data into memory
  *
@@ -410,6 +440,11 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline int bootstage_fdt_add_chosen(void *blob)
+{
+	return 0;
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
@@ -641,6 +641,7 @@ int gzip_parse_header(const unsigned char *src, unsigned long len);
 int gunzip(void *, int, unsigned char *, unsigned long *);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
+int gunzip_head(void *dst, int dstlen, unsigned char *src, unsigned long len);
 
 /**
  * gzwrite progress indicators: defined weak to allow board-specific
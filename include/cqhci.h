@@ -0,0 +1,159 @@
+/*
+ * (C) Copyright 2025 Rockchip Electronics Co., Ltd
+ *
+ * eMMC Command Queue Host Controller Interface (CQHCI), JESD84-B51
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __CQHCI_H
+#define __CQHCI_H
+
+#include <asm/io.h>
+#include <mmc.h>
+
+/*
+ * Controller registers
+ */
+
+#define CQHCI_VER		0x00
+#define CQHCI_CAP		0x04
+
+#define CQHCI_CFG		0x08
+#define  CQHCI_DCMD		BIT(12)
+#define  CQHCI_TASK_DESC_SZ	BIT(8)
+#define  CQHCI_ENABLE		BIT(0)
+
+#define CQHCI_CTL		0x0C
+#define  CQHCI_CLEAR_ALL_TASKS	BIT(8)
+#define  CQHCI_HALT		BIT(0)
+
+#define CQHCI_IS		0x10
+#define CQHCI_ISTE		0x14
+#define CQHCI_ISGE		0x18
+#define CQHCI_IC		0x1C
+#define  CQHCI_IS_HAC		BIT(0)
+#define  CQHCI_IS_TCC		BIT(1)
+#define  CQHCI_IS_RED		BIT(2)
+#define  CQHCI_IS_TCL		BIT(3)
+#define  CQHCI_IS_GCE		BIT(4)
+#define  CQHCI_IS_ICCE		BIT(5)
+#define  CQHCI_IS_MASK		(CQHCI_IS_HAC | CQHCI_IS_TCC | CQHCI_IS_RED | \
+				 CQHCI_IS_TCL | CQHCI_IS_GCE | CQHCI_IS_ICCE)
+#define  CQHCI_IS_ERROR		(CQHCI_IS_RED | CQHCI_IS_GCE | CQHCI_IS_ICCE)
+
+#define CQHCI_TDLBA		0x20
+#define CQHCI_TDLBAU		0x24
+#define CQHCI_TDBR		0x28
+#define CQHCI_TCN		0x2C
+#define CQHCI_DQS		0x30
+#define CQHCI_DPT		0x34
+#define CQHCI_TCLR		0x38
+#define CQHCI_SSC1		0x40
+#define CQHCI_SSC2		0x44
+#define CQHCI_CRDCT		0x48
+#define CQHCI_RMEM		0x50
+#define CQHCI_TERRI		0x54
+#define CQHCI_CRI		0x58
+#define CQHCI_CRA		0x5C
+
+/*
+ * Descriptor fields, the task descriptor is 64 bits (or 128 bits with the
+ * upper half reserved), transfer and link descriptors share the ADMA2
+ * attribute layout.
+ */
+#define CQHCI_VALID(x)		(((x) & 1) << 0)
+#define CQHCI_END(x)		(((x) & 1) << 1)
+#define CQHCI_INT(x)		(((x) & 1) << 2)
+#define CQHCI_ACT(x)		(((x) & 0x7) << 3)
+#define CQHCI_FORCED_PROG(x)	(((x) & 1) << 6)
+#define CQHCI_CONTEXT(x)	(((x) & 0xF) << 7)
+#define CQHCI_DATA_TAG(x)	(((x) & 1) << 11)
+#define CQHCI_DATA_DIR(x)	(((x) & 1) << 12)
+#define CQHCI_PRIORITY(x)	(((x) & 1) << 13)
+#define CQHCI_QBAR(x)		(((x) & 1) << 14)
+#define CQHCI_REL_WRITE(x)	(((x) & 1) << 15)
+#define CQHCI_BLK_COUNT(x)	(((u64)(x) & 0xFFFF) << 16)
+#define CQHCI_BLK_ADDR(x)	(((u64)(x) & 0xFFFFFFFF) << 32)
+#define CQHCI_DAT_LENGTH(x)	(((x) & 0xFFFF) << 16)
+
+#define CQHCI_ACT_TASK		0x5
+#define CQHCI_ACT_TRAN		0x4
+#define CQHCI_ACT_LINK		0x6
+
+#define CQHCI_NUM_SLOTS		32
+/* Larger requests are split, which also keeps more slots busy */
+#define CQHCI_MAX_TASK_BLKS	2048
+#define CQHCI_MAX_DAT_LEN	65024
+#define CQHCI_BOUNDARY_128M	(128 * 1024 * 1024)
+#define CQHCI_TRAN_DESCS	\
+	(DIV_ROUND_UP(CQHCI_MAX_TASK_BLKS * 512, CQHCI_MAX_DAT_LEN) + 1)
+#define CQHCI_TIMEOUT		1000	/* ms without any task completion */
+
+struct cqhci_host;
+
+struct cqhci_host_ops {
+	/* Prepare the host for queued transfers, after CQHCI is enabled */
+	void (*enable)(struct cqhci_host *cq_host);
+	/* Back to legacy transfers, after CQHCI is halted and disabled */
+	void (*disable)(struct cqhci_host *cq_host, bool recovery);
+	/* Data/command errors the host reported for queued tasks */
+	u32 (*get_errors)(struct cqhci_host *cq_host);
+};
+
+struct cqhci_host {
+	void *mmio;
+	struct mmc *mmc;
+	void *priv;
+	const struct cqhci_host_ops *ops;
+
+	bool dma64;
+	bool boundary_128m;	/* transfers must not cross 128MiB */
+	int num_slots;
+	int task_desc_len;
+	int link_desc_len;
+	int trans_desc_len;
+	int slot_sz;
+	int trans_slot_sz;
+
+	u8 *desc_base;		/* task and link descriptor list */
+	u8 *trans_desc_base;	/* CQHCI_TRAN_DESCS per slot */
+};
+
+static inline void cqhci_writel(struct cqhci_host *cq_host, u32 val, int reg)
+{
+	writel(val, cq_host->mmio + reg);
+}
+
+static inline u32 cqhci_readl(struct cqhci_host *cq_host, int reg)
+{
+	return readl(cq_host->mmio + reg);
+}
+
+/**
+ * cqhci_init() - allocate the descriptor lists of a CQHCI engine
+ *
+ * @cq_host:	engine with mmio, ops and priv set up by the host driver
+ * @mmc:	MMC device the engine belongs to
+ * @dma64:	use 64-bit addresses and 128-bit task descriptors
+ * @return 0 if OK, -ve on error
+ */
+int cqhci_init(struct cqhci_host *cq_host, struct mmc *mmc, bool dma64);
+
+/**
+ * cqhci_read() - read block ranges with queued tasks
+ *
+ * The card must already be in command queue mode. Requests are split into
+ * tasks of at most CQHCI_MAX_TASK_BLKS blocks and every free slot, up to
+ * the card queue depth, is kept busy. The engine is halted and disabled
+ * again on return.
+ *
+ * @cq_host:	engine to use
+ * @reqs:	block ranges to read, the buffers must be cache aligned
+ * @count:	number of requests
+ * @return 0 if all requests completed, -ve on error
+ */
+int cqhci_read(struct cqhci_host *cq_host, struct mmc_cqe_req *reqs,
+	       int count);
+
+#endif /* __CQHCI_H */
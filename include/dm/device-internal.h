@@ -91,6 +91,34 @@ int device_bind_by_name(struct udevice *parent, bool pre_reloc_only,
  */
 int device_probe(struct udevice *dev);
 
+/**
+ * device_probe_defer() - Probe a device now or when it is first used
+ *
+ * This is for code that probes devices eagerly, though the boot may not
+ * need them, e.g. to announce them. If the driver has DM_FLAG_PROBE_DEFER
+ * set, the device is queued instead and probed by the first
+ * device_probe() for it or by dm_probe_deferred(). Setting the "dm_defer"
+ * environment variable to "no" probes all devices right away.
+ *
+ * @dev: Pointer to device to probe
+ * @return 0 if OK or deferred, -ve on error
+ */
+#if CONFIG_IS_ENABLED(DM_DEFERRED_PROBE)
+int device_probe_defer(struct udevice *dev);
+
+/* Internal hooks for device_probe() and device_unbind() */
+void device_deferred_probed(struct udevice *dev);
+void device_deferred_unbind(struct udevice *dev);
+#else
+static inline int device_probe_defer(struct udevice *dev)
+{
+	return device_probe(dev);
+}
+
+static inline void device_deferred_probed(struct udevice *dev) {}
+static inline void device_deferred_unbind(struct udevice *dev) {}
+#endif
+
 /**
  * device_remove() - Remove a device, de-activating it
  *
@@ -127,6 +155,24 @@ void device_free(struct udevice *dev);
 static inline void device_free(struct udevice *dev) {}
 #endif
 
+/**
+ * device_match_kernel_node() - Match a kernel DTB node to a U-Boot device
+ *
+ * Look for a U-Boot device that the kernel DTB describes with the same
+ * "compatible" and "reg" and which is used ahead of kernel devices anyway.
+ * If there is one, it also stands for @node from now on, so nothing has
+ * to be bound for the node. Nodes with compatible subnodes are never
+ * matched, as their children would not be bound.
+ *
+ * @node: Kernel DTB node about to be bound
+ * @return true if @node was matched and must not be bound
+ */
+#ifdef CONFIG_USING_KERNEL_DTB_V2
+bool device_match_kernel_node(ofnode node);
+#else
+static inline bool device_match_kernel_node(ofnode node) { return false; }
+#endif
+
 /**
  * simple_bus_translate() - translate a bus address to a system address
  *
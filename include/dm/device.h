@@ -11,6 +11,7 @@
 #ifndef _DM_DEVICE_H
 #define _DM_DEVICE_H
 
+#include <dm/lookup.h>
 #include <dm/ofnode.h>
 #include <dm/uclass-id.h>
 #include <fdtdec.h>
@@ -62,6 +63,12 @@ struct driver_info;
  */
 #define DM_FLAG_OS_PREPARE		(1 << 10)
 
+/* Driver can be probed when first used, see device_probe_defer() */
+#define DM_FLAG_PROBE_DEFER		(1 << 11)
+
+/* Probe of the device was deferred by device_probe_defer() */
+#define DM_FLAG_DEFERRED		(1 << 12)
+
 /* Device is from kernel dtb */
 #define DM_FLAG_KNRL_DTB		(1 << 31)
 
@@ -127,6 +134,8 @@ enum {
  *		When CONFIG_DEVRES is enabled, devm_kmalloc() and friends will
  *		add to this list. Memory so-allocated will be freed
  *		automatically when the device is removed / unbound
+ * @kernel_node: Kernel DTB node this U-Boot device stands for, see
+ *		device_match_kernel_node(). ofnode_null() if none.
  */
 struct udevice {
 	const struct driver *driver;
@@ -150,6 +159,9 @@ struct udevice {
 #ifdef CONFIG_DEVRES
 	struct list_head devres_head;
 #endif
+#ifdef CONFIG_USING_KERNEL_DTB_V2
+	ofnode kernel_node;
+#endif
 };
 
 /* Maximum sequence number supported */
@@ -169,6 +181,7 @@ static inline int dev_of_offset(const struct udevice *dev)
 static inline void dev_set_of_offset(struct udevice *dev, int of_offset)
 {
 	dev->node = offset_to_ofnode(of_offset);
+	dm_lookup_invalidate();
 }
 
 static inline bool dev_has_of_node(struct udevice *dev)
@@ -176,6 +189,40 @@ static inline bool dev_has_of_node(struct udevice *dev)
 	return ofnode_valid(dev->node);
 }
 
+/**
+ * dev_ofnode_equal() - check if a device tree node belongs to a device
+ *
+ * Besides its own node, a U-Boot device also owns the kernel DTB node it
+ * was matched to.
+ *
+ * @dev: Device to check
+ * @node: Node to check for
+ * @return true if @node is the device's node
+ */
+static inline bool dev_ofnode_equal(const struct udevice *dev, ofnode node)
+{
+	if (ofnode_equal(dev->node, node))
+		return true;
+#ifdef CONFIG_USING_KERNEL_DTB_V2
+	return ofnode_valid(dev->kernel_node) &&
+	       ofnode_equal(dev->kernel_node, node);
+#else
+	return false;
+#endif
+}
+
+/**
+ * dev_has_phandle() - check if a phandle refers to a device
+ *
+ * This also checks the kernel DTB node the device was matched to, see
+ * dev_ofnode_equal().
+ *
+ * @dev: Device to check
+ * @phandle: Phandle to check for
+ * @return true if @phandle is the phandle of the device's node
+ */
+bool dev_has_phandle(struct udevice *dev, uint phandle);
+
 /**
  * struct udevice_id - Lists the compatible strings supported by a driver
  * @compatible: Compatible string
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2025 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef _DM_LOOKUP_H
+#define _DM_LOOKUP_H
+
+#include <linux/types.h>
+
+struct udevice;
+
+/* Kinds of device lookup that are cached, see dm_lookup_find() */
+enum dm_lookup_type {
+	DM_LOOKUP_OFNODE,	/* uclass_find_device_by_ofnode() */
+	DM_LOOKUP_OF_OFFSET,	/* uclass_find_device_by_of_offset() */
+	DM_LOOKUP_PHANDLE,	/* uclass_get_device_by_phandle() */
+	DM_LOOKUP_NAME,		/* uclass_find_device_by_name() */
+	DM_LOOKUP_GLOBAL,	/* device_get_global_by_of_offset() */
+
+	DM_LOOKUP_COUNT,
+};
+
+#if CONFIG_IS_ENABLED(DM_LOOKUP_CACHE)
+/**
+ * dm_lookup_find() - look up the result of an earlier device search
+ *
+ * The cache only holds the first match of a search, so a hit returns the
+ * same device a walk of the uclass list would. Any change to the device
+ * lists, to a device's node or name, or to the control FDT invalidates it.
+ *
+ * @type:	kind of lookup
+ * @id:		uclass searched, ignored for DM_LOOKUP_GLOBAL
+ * @key:	node, offset or phandle searched for, ignored for names
+ * @name:	name searched for with DM_LOOKUP_NAME, else NULL
+ * @devp:	returns the device, or NULL if the search found none
+ * @return true if the result was cached, false if the caller must search
+ */
+bool dm_lookup_find(enum dm_lookup_type type, int id, ulong key,
+		    const char *name, struct udevice **devp);
+
+/**
+ * dm_lookup_add() - record the result of a device search
+ *
+ * This must follow a dm_lookup_find() for the same search that missed.
+ *
+ * @type:	kind of lookup
+ * @id:		uclass searched
+ * @key:	node, offset or phandle searched for
+ * @name:	name searched for with DM_LOOKUP_NAME, else NULL
+ * @dev:	device found, or NULL if there is none
+ */
+void dm_lookup_add(enum dm_lookup_type type, int id, ulong key,
+		   const char *name, struct udevice *dev);
+
+/* Drop all cached results */
+void dm_lookup_invalidate(void);
+#else
+static inline bool dm_lookup_find(enum dm_lookup_type type, int id,
+				  ulong key, const char *name,
+				  struct udevice **devp)
+{
+	return false;
+}
+
+static inline void dm_lookup_add(enum dm_lookup_type type, int id,
+				 ulong key, const char *name,
+				 struct udevice *dev)
+{
+}
+
+static inline void dm_lookup_invalidate(void)
+{
+}
+#endif
+
+#endif
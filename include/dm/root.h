@@ -130,4 +130,25 @@ int dm_remove_devices_flags(uint flags);
 static inline int dm_remove_devices_flags(uint flags) { return 0; }
 #endif
 
+#if CONFIG_IS_ENABLED(DM_DEFERRED_PROBE)
+/**
+ * dm_probe_deferred - Probe devices whose probe was deferred
+ *
+ * Call this when waiting anyway, devices that are used in the meantime
+ * are probed on their first use.
+ *
+ * @max: Maximum number of devices to probe, 0 for all of them
+ * @return number of devices probed
+ */
+int dm_probe_deferred(int max);
+
+/**
+ * dm_report_deferred - Print the deferred devices that were never probed
+ */
+void dm_report_deferred(void);
+#else
+static inline int dm_probe_deferred(int max) { return 0; }
+static inline void dm_report_deferred(void) {}
+#endif
+
 #endif
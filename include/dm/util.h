@@ -40,6 +40,24 @@ static inline void dm_dump_devres(void)
 }
 #endif
 
+#if CONFIG_IS_ENABLED(DM_DEFERRED_PROBE)
+/* Dump out the devices whose probe was deferred */
+void dm_dump_deferred(void);
+#else
+static inline void dm_dump_deferred(void)
+{
+}
+#endif
+
+#if CONFIG_IS_ENABLED(DM_LOOKUP_CACHE)
+/* Dump out device lookup counts and cache hits */
+void dm_dump_lookup_stats(void);
+#else
+static inline void dm_dump_lookup_stats(void)
+{
+}
+#endif
+
 /**
  * Check if a dt node should be or was bound before relocation.
  *
@@ -9,6 +9,7 @@
 #define __DWMMC_HW_H
 
 #include <asm/io.h>
+#include <bouncebuf.h>
 #include <mmc.h>
 
 #define DWMCI_CTRL		0x000
@@ -207,6 +208,16 @@ struct dwmci_host {
 
 	/* use fifo mode to read and write data */
 	bool fifo_mode;
+
+#ifdef CONFIG_BLK_ASYNC
+	/* Data phase left running by dwmci_send_cmd_async() */
+	struct mmc_data async_data;
+	struct bounce_buffer async_bb;
+	struct dwmci_idmac *async_idmac;
+	unsigned int async_ndesc;
+	ulong async_start;
+	unsigned int async_timeout;
+#endif
 };
 
 struct dwmci_idmac {
@@ -78,6 +78,40 @@ struct ext4_extent_header {
 	__le32	eh_generation;	/* generation of the tree */
 };
 
+/* Hash functions of indexed (HTree) directories */
+#define DX_HASH_LEGACY			0
+#define DX_HASH_HALF_MD4		1
+#define DX_HASH_TEA			2
+#define DX_HASH_LEGACY_UNSIGNED		3
+#define DX_HASH_HALF_MD4_UNSIGNED	4
+#define DX_HASH_TEA_UNSIGNED		5
+#define EXT2_FLAGS_UNSIGNED_HASH	0x0002
+#define EXT4_HTREE_EOF_32BIT		0x7fffffff
+
+/*
+ * Block 0 of an indexed directory starts with the '.' and '..' entries,
+ * followed by dx_root_info and the top level dx_entry array. Interior
+ * index blocks start with an empty 8 byte dirent instead.
+ */
+struct dx_root_info {
+	__le32	reserved_zero;
+	__u8	hash_version;
+	__u8	info_length;	/* 8 */
+	__u8	indirect_levels;
+	__u8	unused_flags;
+};
+
+/* The first entry of each array holds its limit and count instead of a hash */
+struct dx_entry {
+	__le32	hash;
+	__le32	block;
+};
+
+struct dx_countlimit {
+	__le16	limit;
+	__le16	count;
+};
+
 struct ext_filesystem {
 	/* Total Sector of partition */
 	uint64_t total_sect;
@@ -148,6 +182,8 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot);
 int ext4fs_devread(lbaint_t sector, int byte_offset, int byte_len, char *buf);
 void ext4fs_set_blk_dev(struct blk_desc *rbdd, disk_partition_t *info);
 long int read_allocated_block(struct ext2_inode *inode, int fileblock);
+long int read_allocated_extent(struct ext2_inode *inode, int fileblock,
+			       int *count);
 int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 disk_partition_t *fs_partition);
 int ext4_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
@@ -175,6 +175,8 @@ typedef struct {
 	int	fatbufnum;	/* Used by get_fatent, init to -1 */
 	int	rootdir_size;	/* Size of root dir for non-FAT32 */
 	__u32	root_cluster;	/* First cluster of root dir for FAT32 */
+	__u8	*fatcache;	/* Whole FAT, read on demand, or NULL */
+	__u8	*fatcache_valid; /* Chunks of fatcache read so far */
 } fsdata;
 
 static inline u32 clust_to_sect(fsdata *fsdata, u32 clust)
@@ -12,4 +12,15 @@ void fb_mmc_erase(const char *cmd, char *response);
 
 lbaint_t fb_mmc_get_erase_grp_size(void);
 
+/*
+ * Write an image to a partition while it is being downloaded, a sparse
+ * image or a raw one of @size bytes. fb_mmc_stream_finish() sets the
+ * response for the whole download.
+ */
+int fb_mmc_stream_start(const char *cmd, u64 size, char *response);
+/* Continue with the next sparse piece of an image the client split up */
+void fb_mmc_stream_next(void);
+int fb_mmc_stream_write(const void *data, unsigned int len);
+void fb_mmc_stream_finish(char *response);
+
 #endif
@@ -23,8 +23,63 @@ struct sparse_storage {
 	lbaint_t	(*reserve)(struct sparse_storage *info,
 				 lbaint_t blk,
 				 lbaint_t blkcnt);
+
+	/* Optional, zero blocks without a data buffer */
+	lbaint_t	(*write_zeroes)(struct sparse_storage *info,
+				 lbaint_t blk,
+				 lbaint_t blkcnt);
+};
+
+/*
+ * Incremental sparse image writer, the image can be passed in pieces of
+ * any size as they arrive.
+ */
+struct sparse_stream {
+	struct sparse_storage	*info;
+	char		*buf;		/* write buffer, also for FILL data */
+	u32		buf_size;
+	u32		buf_len;	/* bytes waiting in buf */
+	u64		raw_size;	/* size of a non-sparse image, or 0 */
+	lbaint_t	blk;		/* where buf[0] goes */
+	int		state;
+	u8		hdr[sizeof(sparse_header_t)] __aligned(4); /* being read */
+	u32		hdr_len;
+	u32		skip;		/* bytes to drop before the next item */
+	u64		left;		/* RAW bytes or FILL blocks to go */
+	sparse_header_t	sparse;
+	chunk_header_t	chunk;
+	u32		chunks;		/* chunk headers read */
+	u32		total_blocks;
+	u64		bytes_written;
+	const char	*error;
 };
 
+/**
+ * sparse_stream_init() - start writing an image in pieces
+ *
+ * @s:		stream state
+ * @info:	storage to write to
+ * @buf:	buffer that gathers small writes, cache aligned
+ * @buf_size:	size of @buf, at least one storage block
+ * @raw_size:	size of the image if it may also be a raw (non-sparse) one,
+ *		0 if it must be a sparse image
+ */
+void sparse_stream_init(struct sparse_stream *s, struct sparse_storage *info,
+			void *buf, u32 buf_size, u64 raw_size);
+
+/**
+ * sparse_stream_write() - pass the next piece of the image
+ *
+ * @return 0, or -EIO once writing failed; later pieces are ignored then
+ */
+int sparse_stream_write(struct sparse_stream *s, const void *data, u32 len);
+
+/**
+ * sparse_stream_finish() - complete the image and set the fastboot response
+ */
+void sparse_stream_finish(struct sparse_stream *s, const char *part_name,
+			  char *response);
+
 static inline int is_sparse_image(void *buf)
 {
 	sparse_header_t *s_header = (sparse_header_t *)buf;
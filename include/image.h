@@ -368,6 +368,7 @@ typedef struct bootm_headers {
 #ifndef USE_HOSTCC
 	image_info_t	os;		/* os image info */
 	ulong		ep;		/* entry point of OS */
+	ulong		preload_ep;	/* ep set by arch_preload_os(), or 0 */
 
 	ulong		rd_start, rd_end;/* ramdisk start/end */
 
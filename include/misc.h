@@ -169,4 +169,46 @@ int misc_decompress_cleanup(void);
 int misc_decompress_process(unsigned long dst, unsigned long src,
 			    unsigned long src_len, u32 cap, bool sync,
 			    u64 *size, u32 flags);
+
+/*
+ * Streaming decompression, for a source that is still being loaded.
+ *
+ * misc_decompress_stream_start() - begin a stream, only the lz4 frame header
+ *	must be in memory, @dst must be ARCH_DMA_MINALIGN aligned.
+ * misc_decompress_stream_feed() - the first @landed bytes of the source are
+ *	in memory, the engine is started/advanced without waiting.
+ * misc_decompress_stream_finish() - wait for the whole source to be
+ *	decompressed, @size returns the output length.
+ * misc_decompress_stream_abort() - drop the stream, e.g. on a read error.
+ *
+ * Only one stream can be open at a time.
+ */
+int misc_decompress_stream_start(unsigned long dst, u64 dst_max,
+				 unsigned long src, unsigned long src_len,
+				 u32 cap);
+int misc_decompress_stream_feed(unsigned long landed);
+int misc_decompress_stream_finish(u64 *size);
+void misc_decompress_stream_abort(void);
+
+/*
+ * misc_decompress_blk() - read a compressed image from a block device and
+ * decompress it while it is being read.
+ *
+ * Only lz4 overlaps the read, a gzip image is read in full first. On return
+ * the source holds the image as read, also on error, so it can still be
+ * decompressed in software.
+ *
+ * @desc:	block device
+ * @start:	first block of the image
+ * @src:	load address of the compressed image
+ * @src_len:	compressed image length
+ * @dst:	output address, ARCH_DMA_MINALIGN aligned
+ * @dst_max:	output buffer size
+ * @cap:	DECOM_GZIP or DECOM_LZ4
+ * @size:	returns the decompressed length, may be NULL
+ * @return 0 if OK, -ve on error
+ */
+int misc_decompress_blk(struct blk_desc *desc, lbaint_t start,
+			unsigned long src, unsigned long src_len,
+			unsigned long dst, u64 dst_max, u32 cap, u64 *size);
 #endif	/* _MISC_H_ */
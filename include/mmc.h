@@ -61,6 +61,7 @@
 #define MMC_MODE_HS200		(1 << 6)
 #define MMC_MODE_HS400		(1 << 7)
 #define MMC_MODE_HS400ES	(1 << 8)
+#define MMC_MODE_CQE		(1 << 9)	/* command queue engine */
 
 #define SD_DATA_4BIT	0x00040000
 
@@ -93,6 +94,7 @@
 #define MMC_CMD_ERASE_GROUP_START	35
 #define MMC_CMD_ERASE_GROUP_END		36
 #define MMC_CMD_ERASE			38
+#define MMC_CMD_CMDQ_TASK_MGMT		48
 #define MMC_CMD_APP_CMD			55
 #define MMC_CMD_SPI_READ_OCR		58
 #define MMC_CMD_SPI_CRC_ON_OFF		59
@@ -172,6 +174,7 @@
 /*
  * EXT_CSD fields
  */
+#define EXT_CSD_CMDQ_MODE_EN		15	/* R/W */
 #define EXT_CSD_ENH_START_ADDR		136	/* R/W */
 #define EXT_CSD_ENH_SIZE_MULT		140	/* R/W */
 #define EXT_CSD_GP_SIZE_MULT		143	/* R/W */
@@ -199,6 +202,8 @@
 #define EXT_CSD_HC_ERASE_GRP_SIZE	224	/* RO */
 #define EXT_CSD_BOOT_MULT		226	/* RO */
 #define EXT_CSD_SEC_FEATURE_SUPPORT     231     /* RO */
+#define EXT_CSD_CMDQ_DEPTH		307	/* RO */
+#define EXT_CSD_CMDQ_SUPPORT		308	/* RO */
 #define EXT_CSD_BKOPS_SUPPORT		502	/* RO */
 
 /*
@@ -406,6 +411,21 @@ struct mmc_data {
 /* forward decl. */
 struct mmc;
 
+/* One independent read for mmc_cqe_read() */
+struct mmc_cqe_req {
+	lbaint_t start;
+	lbaint_t blkcnt;
+	void *dst;
+};
+
+struct mmc_cqe_stats {
+	ulong batches;		/* mmc_cqe_read() calls served by the queue */
+	ulong fallbacks;	/* mmc_cqe_read() calls read one by one */
+	ulong tasks;		/* task descriptors issued */
+	ulong depth_sum;	/* tasks in flight, summed at each issue */
+	uint max_depth;		/* most tasks in flight at once */
+};
+
 #if CONFIG_IS_ENABLED(DM_MMC)
 struct dm_mmc_ops {
 	/**
@@ -431,6 +451,30 @@ struct dm_mmc_ops {
 	int (*send_cmd_prepare)(struct udevice *dev, struct mmc_cmd *cmd,
 				struct mmc_data *data);
 #endif
+
+#ifdef CONFIG_BLK_ASYNC
+	/**
+	 * send_cmd_async() - Send a data command without waiting for the data
+	 *
+	 * The data phase keeps running after return and must be completed by
+	 * poll_data() before any other command is sent to the device.
+	 *
+	 * @dev:	Device to receive the command
+	 * @cmd:	Command to send
+	 * @data:	Data to send/receive
+	 * @return 0 if OK, -ENOSYS if the host can't do it, other -ve on error
+	 */
+	int (*send_cmd_async)(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data);
+
+	/**
+	 * poll_data() - Check the data phase started by send_cmd_async()
+	 *
+	 * @dev:	Device to check
+	 * @return 0 if done, -EINPROGRESS if still running, other -ve on error
+	 */
+	int (*poll_data)(struct udevice *dev);
+#endif
 	/**
 	 * card_busy() - Query the card device status
 	 *
@@ -475,12 +519,33 @@ struct dm_mmc_ops {
 	int (*execute_tuning)(struct udevice *dev, u32 opcode);
 	/* set_enhanced_strobe() - set HS400 enhanced strobe */
 	int (*set_enhanced_strobe)(struct udevice *dev);
+
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	/**
+	 * cqe_read() - Read block ranges with the command queue engine
+	 *
+	 * The card is already in command queue mode, the ranges are read
+	 * from the selected hardware partition in any order.
+	 *
+	 * @dev:	Device to read from
+	 * @reqs:	Block ranges, buffers are cache aligned
+	 * @count:	Number of ranges
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*cqe_read)(struct udevice *dev, struct mmc_cqe_req *reqs,
+			int count);
+#endif
 };
 
 #define mmc_get_ops(dev)        ((struct dm_mmc_ops *)(dev)->driver->ops)
 
 int dm_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 		    struct mmc_data *data);
+#ifdef CONFIG_BLK_ASYNC
+int dm_mmc_send_cmd_async(struct udevice *dev, struct mmc_cmd *cmd,
+			  struct mmc_data *data);
+int dm_mmc_poll_data(struct udevice *dev);
+#endif
 int dm_mmc_set_ios(struct udevice *dev);
 int dm_mmc_get_cd(struct udevice *dev);
 int dm_mmc_get_wp(struct udevice *dev);
@@ -606,6 +671,20 @@ struct mmc {
 	struct udevice *dev;	/* Device for this MMC controller */
 #endif
 	u8 raw_driver_strength;
+#ifdef CONFIG_BLK_ASYNC
+	/* Read in flight by mmc_bread_submit(), b_max blocks per command */
+	struct {
+		lbaint_t start;		/* first block of the current command */
+		lbaint_t cur;		/* blocks in the current command */
+		lbaint_t todo;		/* blocks left, including cur */
+		lbaint_t total;
+		void *dst;
+	} async_read;
+#endif
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	u8 cmdq_depth;		/* card queue depth, 0 if unsupported */
+	struct mmc_cqe_stats cqe_stats;
+#endif
 };
 
 struct mmc_hwpart_conf {
@@ -735,6 +814,20 @@ int mmc_rpmb_write(struct mmc *mmc, void *addr, unsigned short blk,
 int mmc_set_bkops_enable(struct mmc *mmc);
 #endif
 
+/**
+ * mmc_cqe_read() - Read independent block ranges at once
+ *
+ * With an eMMC 5.1 card and a host command queue engine the ranges are
+ * queued to the card together, otherwise they are read one by one. The
+ * currently selected hardware partition is used.
+ *
+ * @mmc:	MMC device
+ * @reqs:	Block ranges to read
+ * @count:	Number of ranges
+ * @return 0 if OK, -ve on error
+ */
+int mmc_cqe_read(struct mmc *mmc, struct mmc_cqe_req *reqs, int count);
+
 /**
  * Start device initialization and return immediately; it does not block on
  * polling OCR (operation condition register) status.  Then you should call
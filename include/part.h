@@ -208,6 +208,19 @@ int part_get_info_by_name(struct blk_desc *dev_desc,
  */
 int part_get_info_by_name_strict(struct blk_desc *dev_desc, const char *name,
 				 disk_partition_t *info);
+
+/**
+ * part_get_info_by_uuid() - Search for a partition by its unique UUID
+ *
+ * @param dev_desc - block device descriptor
+ * @param uuid - partition UUID string, case is ignored
+ * @param info - returns the disk partition info
+ *
+ * @return - the partition number on match (starting on 1), -1 on no match,
+ * otherwise error
+ */
+int part_get_info_by_uuid(struct blk_desc *dev_desc, const char *uuid,
+			  disk_partition_t *info);
 /**
  * part_set_generic_name() - create generic partition like hda1 or sdb2
  *
@@ -276,6 +289,30 @@ struct part_driver {
 	int (*get_info)(struct blk_desc *dev_desc, int part,
 			disk_partition_t *info);
 
+	/**
+	 * get_info_by_name() - Look a partition up by name (optional)
+	 *
+	 * Without it the partitions are walked with get_info().
+	 *
+	 * @dev_desc:	Block device descriptor
+	 * @name:	Partition name
+	 * @info:	Returns partition information
+	 * @return partition number (1 = first), -1 if not found
+	 */
+	int (*get_info_by_name)(struct blk_desc *dev_desc, const char *name,
+				disk_partition_t *info);
+
+	/**
+	 * get_info_by_uuid() - Look a partition up by unique UUID (optional)
+	 *
+	 * @dev_desc:	Block device descriptor
+	 * @uuid:	Partition UUID string
+	 * @info:	Returns partition information
+	 * @return partition number (1 = first), -1 if not found
+	 */
+	int (*get_info_by_uuid)(struct blk_desc *dev_desc, const char *uuid,
+				disk_partition_t *info);
+
 	/**
 	 * print() - Print partition information
 	 *
@@ -313,6 +350,19 @@ struct part_driver {
 int write_gpt_table(struct blk_desc *dev_desc,
 		  gpt_header *gpt_h, gpt_entry *gpt_e);
 
+/**
+ * gpt_cache_invalidate() - Drop the parsed GPT of a device if it changes
+ *
+ * Called for each write to the device, the cached table is only dropped if
+ * the write touches the MBR or either GPT.
+ *
+ * @param dev_desc - block device descriptor
+ * @param start - first block written
+ * @param blkcnt - number of blocks written, 0 to drop the table anyway
+ */
+void gpt_cache_invalidate(struct blk_desc *dev_desc, lbaint_t start,
+			  lbaint_t blkcnt);
+
 /**
  * gpt_fill_pte(): Fill the GPT partition table entry
  *
@@ -423,6 +473,9 @@ int gpt_verify_partitions(struct blk_desc *dev_desc,
  */
 int get_disk_guid(struct blk_desc *dev_desc, char *guid);
 
+#else
+static inline void gpt_cache_invalidate(struct blk_desc *dev_desc,
+					lbaint_t start, lbaint_t blkcnt) {}
 #endif
 
 #if CONFIG_IS_ENABLED(DOS_PARTITION)
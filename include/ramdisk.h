@@ -43,6 +43,17 @@ struct ramdisk_ops {
 	 * @return blkcnt is OK, otherwise is error.
 	 */
 	ulong (*erase)(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt);
+
+	/*
+	 * map() - get the memory holding a range of blocks
+	 *
+	 * @desc:	Block descriptor
+	 * @start:	Start block number to map
+	 * @blkcnt:	Number of blocks to map
+	 *
+	 * @return pointer to block @start, or NULL if not mapped.
+	 */
+	void *(*map)(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt);
 };
 
 int dm_ramdisk_is_enabled(void);
@@ -121,6 +121,7 @@
 #define  SDHCI_INT_CARD_INSERT	BIT(6)
 #define  SDHCI_INT_CARD_REMOVE	BIT(7)
 #define  SDHCI_INT_CARD_INT	BIT(8)
+#define  SDHCI_INT_CQE		BIT(14)
 #define  SDHCI_INT_ERROR	BIT(15)
 #define  SDHCI_INT_TIMEOUT	BIT(16)
 #define  SDHCI_INT_CRC		BIT(17)
@@ -144,6 +145,12 @@
 		SDHCI_INT_DATA_END_BIT | SDHCI_INT_ADMA_ERROR)
 #define SDHCI_INT_ALL_MASK	((unsigned int)-1)
 
+#define  SDHCI_CQE_INT_ERR_MASK	(SDHCI_INT_ADMA_ERROR | SDHCI_INT_BUS_POWER | \
+		SDHCI_INT_DATA_END_BIT | SDHCI_INT_DATA_CRC | \
+		SDHCI_INT_DATA_TIMEOUT | SDHCI_INT_INDEX | \
+		SDHCI_INT_END_BIT | SDHCI_INT_CRC | SDHCI_INT_TIMEOUT)
+#define  SDHCI_CQE_INT_MASK	(SDHCI_CQE_INT_ERR_MASK | SDHCI_INT_CQE)
+
 #define SDHCI_ACMD12_ERR	0x3C
 
 /* 3E-3F reserved */
@@ -163,6 +170,8 @@
 #define SDHCI_CTRL_DRV_TYPE_D		0x0030
 #define SDHCI_CTRL_EXEC_TUNING		0x0040
 #define SDHCI_CTRL_TUNED_CLK		0x0080
+#define SDHCI_CTRL_V4_MODE		0x1000
+#define SDHCI_CTRL_64BIT_ADDR		0x2000
 #define SDHCI_CTRL_PRESET_VAL_ENABLE	0x8000
 
 #define SDHCI_CAPABILITIES	0x40
@@ -200,6 +209,7 @@
 /* 55-57 reserved */
 
 #define SDHCI_ADMA_ADDRESS	0x58
+#define SDHCI_ADMA_ADDRESS_HI	0x5C
 
 /* 60-FB reserved */
 
@@ -233,6 +243,8 @@
 #define SDHCI_QUIRK_BROKEN_VOLTAGE	(1 << 4)
 #define SDHCI_QUIRK_WAIT_SEND_CMD	(1 << 6)
 #define SDHCI_QUIRK_USE_WIDE8		(1 << 8)
+/* ADMA descriptor buffer must not cross 128MiB boundary */
+#define SDHCI_QUIRK_ADMA_BOUNDARY_128M	(1 << 9)
 
 /* to make gcc happy */
 struct sdhci_host;
@@ -242,6 +254,41 @@ struct sdhci_host;
  */
 #define SDHCI_DEFAULT_BOUNDARY_SIZE	(512 * 1024)
 #define SDHCI_DEFAULT_BOUNDARY_ARG	(7)
+
+/*
+ * ADMA2 descriptor, 96-bit with 64-bit address when dma_addr_t is 64-bit.
+ */
+#define ADMA_MAX_LEN		65532
+#define ADMA_BOUNDARY_128M	(128 * 1024 * 1024)
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+#define ADMA_DESC_LEN		12
+#else
+#define ADMA_DESC_LEN		8
+#endif
+/* One more entry for a buffer split by the 128MiB boundary */
+#define ADMA_TABLE_NO_ENTRIES	\
+	(DIV_ROUND_UP(CONFIG_SYS_MMC_MAX_BLK_COUNT * 512, ADMA_MAX_LEN) + 1)
+#define ADMA_TABLE_SZ		(ADMA_TABLE_NO_ENTRIES * ADMA_DESC_LEN)
+
+/* Descriptor table defines */
+#define ADMA_DESC_ATTR_VALID		BIT(0)
+#define ADMA_DESC_ATTR_END		BIT(1)
+#define ADMA_DESC_ATTR_INT		BIT(2)
+#define ADMA_DESC_ATTR_ACT1		BIT(4)
+#define ADMA_DESC_ATTR_ACT2		BIT(5)
+
+#define ADMA_DESC_TRANSFER_DATA		ADMA_DESC_ATTR_ACT2
+
+struct sdhci_adma_desc {
+	u8 attr;
+	u8 reserved;
+	u16 len;
+	u32 addr_lo;
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+	u32 addr_hi;
+#endif
+} __packed;
+
 struct sdhci_ops {
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
 	u32	(*read_l)(struct sdhci_host *host, int reg);
@@ -270,6 +317,13 @@ struct sdhci_ops {
 	int	(*set_enhanced_strobe)(struct sdhci_host *host);
 };
 
+/* How data is moved, the best the build and the controller both support */
+enum sdhci_dma_mode {
+	SDHCI_DMA_NONE,		/* PIO */
+	SDHCI_DMA_SDMA,
+	SDHCI_DMA_ADMA,
+};
+
 struct sdhci_host {
 	const char *name;
 	void *ioaddr;
@@ -290,6 +344,19 @@ struct sdhci_host {
 	uint	voltages;
 
 	struct mmc_config cfg;
+	enum sdhci_dma_mode dma_mode;	/* picked by sdhci_setup_cfg() */
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	struct sdhci_adma_desc *adma_desc_table;
+#endif
+#if CONFIG_IS_ENABLED(MMC_CQHCI)
+	struct cqhci_host *cq_host;	/* set up by the host driver */
+#endif
+#ifdef CONFIG_BLK_ASYNC
+	/* Data phase left running by sdhci_send_command_async() */
+	struct mmc_data async_data;
+	dma_addr_t async_addr;
+	ulong async_start;
+#endif
 };
 
 void sdhci_enable_clk(struct sdhci_host *host, u16 clk);
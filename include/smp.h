@@ -8,16 +8,16 @@
 #define _SMP_H_
 
 enum {
-	SEVT_0 = 0,
-	SEVT_1,
-	SEVT_2,
-	SEVT_3,
+	SEVT_0 = 0,	/* arg0: 0 bring up secondary cpus, -1 park them */
+	SEVT_1,		/* arg0: tid, submit task */
+	SEVT_2,		/* arg0: tid, wait task done and return its result */
+	SEVT_3,		/* arg0: tid, query whether task is owned by smp */
 };
 
 enum {
-	STID_16 = 16,
-	STID_17,
-	STID_18,
+	STID_16 = 16,	/* show boot logo */
+	STID_17,	/* verify fit image hashes */
+	STID_18,	/* enable boot-on regulators */
 };
 
 struct taskdata {
@@ -27,13 +27,132 @@ struct taskdata {
 	ulong arg3;
 };
 
+enum smp_job_state {
+	SMP_JOB_IDLE = 0,
+	SMP_JOB_QUEUED,
+	SMP_JOB_RUNNING,
+	SMP_JOB_DONE,
+};
+
+typedef int (*smp_fn_t)(struct taskdata *td);
+
+/*
+ * struct smp_job - a work item and its completion future.
+ *
+ * The job memory is owned by the submitter and must stay valid until
+ * smp_job_wait() returns or smp_job_done() reports true.
+ */
+struct smp_job {
+	smp_fn_t fn;
+	struct taskdata td;
+	volatile u32 state;
+	int ret;
+	int cpu;	/* cpu index that ran the job, 0 is the boot cpu */
+	ulong us;	/* time spent in fn */
+};
+
 #if CONFIG_IS_ENABLED(SMP)
 int smp_event1(int evt, ulong arg0);
 int smp_event2(int evt, ulong arg0, ulong arg1);
+
+/*
+ * smp_init() - wake up the secondary cpus listed in /cpus by PSCI.
+ *
+ * @return number of secondary cpus online, 0 means all jobs run in place.
+ */
+int smp_init(void);
+
+/*
+ * smp_exit() - drain the queue and hand the secondary cpus back to PSCI,
+ * must be called before jumping to the next stage.
+ */
+void smp_exit(void);
+
+/*
+ * smp_online_cpus() - number of secondary cpus that are pulling jobs.
+ */
+int smp_online_cpus(void);
+
+/*
+ * smp_job_submit() - queue @fn to be run on a secondary cpu.
+ *
+ * @job:	caller owned job/future
+ * @fn:		job function, its return value is stored in job->ret
+ * @td:		arguments for @fn, copied into @job, NULL means all zero
+ *
+ * The job runs in place on the caller if no secondary cpu is online or
+ * the queue is full, so callers never need a serial fallback path.
+ *
+ * @return 0 on success, otherwise failed.
+ */
+int smp_job_submit(struct smp_job *job, smp_fn_t fn, struct taskdata *td);
+
+/*
+ * smp_job_done() - poll the future without blocking.
+ */
+bool smp_job_done(struct smp_job *job);
+
+/*
+ * smp_job_wait() - wait the job done, the caller helps to run the queued
+ * jobs while waiting.
+ *
+ * @return the job's return value.
+ */
+int smp_job_wait(struct smp_job *job);
+
+/* Common job helpers, they return as smp_job_submit() */
+int smp_memset(struct smp_job *job, void *s, int c, size_t n);
+int smp_memcpy(struct smp_job *job, void *dst, const void *src, size_t n);
 #else
 static inline int smp_event1(int evt, ulong arg0) { return 0; }
 static inline int smp_event2(int evt, ulong arg0, ulong arg1) { return 0; }
-#endif
+static inline int smp_init(void) { return 0; }
+static inline void smp_exit(void) {}
+static inline int smp_online_cpus(void) { return 0; }
 
+static inline int smp_job_submit(struct smp_job *job, smp_fn_t fn,
+				 struct taskdata *td)
+{
+	struct taskdata zero = { 0 };
+
+	job->fn = fn;
+	job->td = td ? *td : zero;
+	job->cpu = 0;
+	job->us = 0;
+	job->ret = fn(&job->td);
+	job->state = SMP_JOB_DONE;
+
+	return 0;
+}
+
+static inline bool smp_job_done(struct smp_job *job) { return true; }
+static inline int smp_job_wait(struct smp_job *job) { return job->ret; }
+
+static inline int smp_memset(struct smp_job *job, void *s, int c, size_t n)
+{
+	memset(s, c, n);
+	job->ret = 0;
+	job->state = SMP_JOB_DONE;
+
+	return 0;
+}
+
+static inline int smp_memcpy(struct smp_job *job, void *dst,
+			     const void *src, size_t n)
+{
+	memcpy(dst, src, n);
+	job->ret = 0;
+	job->state = SMP_JOB_DONE;
+
+	return 0;
+}
 #endif
 
+/*
+ * smp_hash() - hash @len bytes at @data with @algo into @output, returns
+ * as smp_job_submit(). It is done in place without CONFIG_SMP.
+ */
+int smp_hash(struct smp_job *job, const char *algo,
+	     const void *data, size_t len, u8 *output);
+
+#endif
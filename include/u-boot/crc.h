@@ -16,6 +16,8 @@ unsigned int crc8(unsigned int crc_start, const unsigned char *vptr, int len);
 uint32_t crc32 (uint32_t, const unsigned char *, uint);
 uint32_t crc32_wd (uint32_t, const unsigned char *, uint, uint);
 uint32_t crc32_no_comp (uint32_t, const unsigned char *, uint);
+/* Table driven crc32_no_comp(), which may use CPU instructions instead */
+uint32_t crc32_no_comp_base(uint32_t, const unsigned char *, uint);
 
 /**
  * crc32_wd_buf - Perform CRC32 on a buffer and return result in buffer
@@ -29,7 +31,11 @@ void crc32_wd_buf(const unsigned char *input, uint ilen,
 		    unsigned char *output, uint chunk_sz);
 
 /* lib/crc32c.c */
+#define CRC32C_POLY_LE	0x82f63b78	/* Bit-reflected Castagnoli polynomial */
+
 void crc32c_init(uint32_t *, uint32_t);
 uint32_t crc32c_cal(uint32_t, const char *, int, uint32_t *);
+/* Table driven crc32c_cal(), which may use CPU instructions instead */
+uint32_t crc32c_cal_base(uint32_t, const char *, int, uint32_t *);
 
 #endif /* _UBOOT_CRC_H */
@@ -62,4 +62,20 @@ bool lz4_is_valid_header(const unsigned char *h);
  */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
+/**
+ * ulz4fn_head() - Decompress the start of LZ4 data
+ *
+ * This only decodes the first block, as far as needed to return @want
+ * bytes, which is enough to read a header at the start of the data.
+ *
+ * @src: Source data to decompress
+ * @srcn: Length of source data
+ * @dst: Destination for uncompressed data
+ * @dstn: Size of @dst, decoding may write this far even for fewer bytes
+ * @want: Number of bytes wanted
+ * @return number of bytes decompressed, or a negative error as for ulz4fn()
+ */
+int ulz4fn_head(const void *src, size_t srcn, void *dst, size_t dstn,
+		size_t want);
+
 #endif
@@ -31,6 +31,9 @@
 extern "C" {
 #endif
 
+#define SHA512_SUM_LEN	64
+#define CHUNKSZ_SHA512	(64 * 1024)
+
 /**
  * \brief          The SHA-512 context structure.
  *
@@ -91,6 +94,36 @@ int sha512_finish(sha512_context *ctx, unsigned char output[64]);
 void sha512_csum(const unsigned char *input, unsigned int ilen,
 		 unsigned char output[64]);
 
+/**
+ * \brief          This function starts SHA-512 checksum for the input data,
+ *                 triggering the watchdog every \p chunk_sz bytes.
+ *
+ * \param input    The buffer holding the input data.
+ * \param ilen     The length of the input data.
+ * \param output   The SHA-512 checksum result.
+ * \param chunk_sz The watchdog is triggered after each chunk of this size.
+ */
+void sha512_csum_wd(const unsigned char *input, unsigned int ilen,
+		    unsigned char *output, unsigned int chunk_sz);
+
+/**
+ * \brief          This function hashes whole 128-byte blocks. It is weak so
+ *                 that architectures can provide an accelerated version.
+ *
+ * \param ctx      The SHA-512 context.
+ * \param data     The blocks to hash.
+ * \param blocks   The number of blocks.
+ */
+void sha512_process(sha512_context *ctx, const unsigned char *data,
+		    unsigned int blocks);
+
+/**
+ * \brief          The generic C sha512_process(), for accelerated versions
+ *                 that have to fall back at run time.
+ */
+void sha512_base_process(sha512_context *ctx, const unsigned char *data,
+			 unsigned int blocks);
+
 #ifdef __cplusplus
 }
 #endif
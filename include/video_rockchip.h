@@ -26,4 +26,19 @@ int rockchip_show_bmp(const char *bmp);
 int rockchip_show_logo(void);
 void rockchip_display_fixup(void *blob);
 
+/*
+ * rockchip_rotate_image() - rotate an image clockwise by 90, 180 or 270
+ * degrees.
+ *
+ * @dst:	output, @height pixels wide for 90/270, else @width
+ * @src:	input, @width x @height pixels with no padding
+ * @dst_stride:	bytes per output row
+ * @bpp:	16, 24 or 32
+ * @rotate:	angle in degrees
+ *
+ * @return 0 on success, -EINVAL for other angles or depths.
+ */
+int rockchip_rotate_image(void *dst, const void *src, int width, int height,
+			  int dst_stride, int bpp, int rotate);
+
 #endif
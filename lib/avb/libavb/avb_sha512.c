@@ -92,6 +92,7 @@
     wv[h] = t1 + t2;                                                        \
   }
 
+#ifndef CONFIG_SHA512
 static const uint64_t sha512_h0[8] = {0x6a09e667f3bcc908ULL,
                                       0xbb67ae8584caa73bULL,
                                       0x3c6ef372fe94f82bULL,
@@ -129,6 +130,7 @@ static const uint64_t sha512_k[80] = {
     0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
     0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
     0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL};
+#endif /* !CONFIG_SHA512 */
 
 /* SHA-512 implementation */
 
@@ -146,6 +148,10 @@ void avb_sha512_init(AvbSHA512Ctx* ctx) {
     return;
   }
 #endif
+#ifdef CONFIG_SHA512
+  /* lib/sha512.c, with the ARMv8.2 SHA-512 instructions if available */
+  sha512_starts(&ctx->sha512ctx);
+#else
 #ifdef UNROLL_LOOPS_SHA512
   ctx->h[0] = sha512_h0[0];
   ctx->h[1] = sha512_h0[1];
@@ -164,8 +170,10 @@ void avb_sha512_init(AvbSHA512Ctx* ctx) {
 
   ctx->len = 0;
   ctx->tot_len = 0;
+#endif /* CONFIG_SHA512 */
 }
 
+#ifndef CONFIG_SHA512
 static void SHA512_transform(AvbSHA512Ctx* ctx,
                              const uint8_t* message,
                              size_t block_nb) {
@@ -331,6 +339,7 @@ static void SHA512_transform(AvbSHA512Ctx* ctx,
 #endif /* UNROLL_LOOPS_SHA512 */
   }
 }
+#endif /* !CONFIG_SHA512 */
 
 void avb_sha512_update(AvbSHA512Ctx* ctx, const uint8_t* data, size_t len) {
 /* Crypto-v1 is not support sha512 */
@@ -342,6 +351,9 @@ void avb_sha512_update(AvbSHA512Ctx* ctx, const uint8_t* data, size_t len) {
   }
 #endif
 
+#ifdef CONFIG_SHA512
+  sha512_update(&ctx->sha512ctx, data, len);
+#else
   size_t block_nb;
   size_t new_len, rem_len, tmp_len;
   const uint8_t* shifted_data;
@@ -370,6 +382,7 @@ void avb_sha512_update(AvbSHA512Ctx* ctx, const uint8_t* data, size_t len) {
 
   ctx->len = rem_len;
   ctx->tot_len += (block_nb + 1) << 7;
+#endif /* CONFIG_SHA512 */
 }
 
 uint8_t* avb_sha512_final(AvbSHA512Ctx* ctx) {
@@ -382,6 +395,9 @@ uint8_t* avb_sha512_final(AvbSHA512Ctx* ctx) {
   }
 #endif
 
+#ifdef CONFIG_SHA512
+  sha512_finish(&ctx->sha512ctx, ctx->buf);
+#else
   size_t block_nb;
   size_t pm_len;
   uint64_t len_b;
@@ -415,6 +431,7 @@ uint8_t* avb_sha512_final(AvbSHA512Ctx* ctx) {
   for (i = 0; i < 8; i++)
     UNPACK64(ctx->h[i], &ctx->buf[i << 3]);
 #endif /* UNROLL_LOOPS_SHA512 */
+#endif /* CONFIG_SHA512 */
 
   return ctx->buf;
 }
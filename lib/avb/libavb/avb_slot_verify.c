@@ -35,6 +35,7 @@
 #include <android_avb/avb_util.h>
 #include <android_avb/avb_vbmeta_image.h>
 #include <android_avb/avb_version.h>
+#include <smp.h>
 
 /* Maximum number of partitions that can be loaded with avb_slot_verify(). */
 #define MAX_NUMBER_OF_LOADED_PARTITIONS 32
@@ -145,6 +146,92 @@ static AvbSlotVerifyResult load_full_partition(AvbOps* ops,
   return AVB_SLOT_VERIFY_RESULT_OK;
 }
 
+#ifdef CONFIG_AVB_READ_HASH
+/* Hash of a partition that is fed by read_from_partition() while it is
+ * loaded, see AvbOps.read_hash. Updates run as an SMP job, so hashing a
+ * piece overlaps reading the next one. They still have to be applied in
+ * order, so there is at most one job in flight.
+ */
+struct AvbReadHash {
+  const char* partition;
+  AvbSHA256Ctx* sha256_ctx;
+  AvbSHA512Ctx* sha512_ctx;
+  uint64_t offset; /* Bytes hashed, or queued to be. */
+  uint64_t size;   /* Bytes to hash. */
+  struct smp_job job;
+  bool pending;
+};
+
+static int read_hash_fn(struct taskdata* td) {
+  struct AvbReadHash* rh = (struct AvbReadHash*)td->arg0;
+  const uint8_t* data = (const uint8_t*)td->arg1;
+
+  if (rh->sha256_ctx != NULL) {
+    avb_sha256_update(rh->sha256_ctx, data, td->arg2);
+  } else {
+    avb_sha512_update(rh->sha512_ctx, data, td->arg2);
+  }
+  return 0;
+}
+
+/* Hardware hashes go through the crypto uclass, which only the boot cpu
+ * may use, so they are updated in place.
+ */
+static bool read_hash_in_place(struct AvbReadHash* rh) {
+#if !CONFIG_IS_ENABLED(ARMV8_CE_SHA256) && CONFIG_IS_ENABLED(DM_CRYPTO)
+  if (rh->sha256_ctx != NULL && rh->sha256_ctx->sha256ctx.cdev != NULL) {
+    return true;
+  }
+#endif
+#ifdef CONFIG_ROCKCHIP_CRYPTO_V2
+  if (rh->sha512_ctx != NULL && rh->sha512_ctx->crypto_dev != NULL) {
+    return true;
+  }
+#endif
+  return smp_online_cpus() == 0;
+}
+
+static void read_hash_wait(struct AvbReadHash* rh) {
+  if (rh->pending) {
+    smp_job_wait(&rh->job);
+    rh->pending = false;
+  }
+}
+
+void avb_read_hash_update(AvbOps* ops,
+                          const char* partition,
+                          int64_t offset,
+                          const uint8_t* buffer,
+                          size_t num_bytes) {
+  struct AvbReadHash* rh = ops->read_hash;
+  struct taskdata td;
+
+  if (rh == NULL || (uint64_t)offset != rh->offset ||
+      avb_strcmp(partition, rh->partition) != 0) {
+    return;
+  }
+  if (num_bytes > rh->size - rh->offset) {
+    num_bytes = rh->size - rh->offset;
+  }
+  if (num_bytes == 0) {
+    return;
+  }
+
+  read_hash_wait(rh);
+  td.arg0 = (ulong)rh;
+  td.arg1 = (ulong)buffer;
+  td.arg2 = num_bytes;
+  td.arg3 = 0;
+  if (read_hash_in_place(rh)) {
+    read_hash_fn(&td);
+    rh->offset += num_bytes;
+  } else if (smp_job_submit(&rh->job, read_hash_fn, &td) == 0) {
+    rh->pending = true;
+    rh->offset += num_bytes;
+  }
+}
+#endif
+
 /* Reads a persistent digest stored as a named persistent value corresponding to
  * the given |part_name|. The value is returned in |out_digest| which must point
  * to |expected_digest_size| bytes. If there is no digest stored for |part_name|
@@ -384,6 +471,7 @@ static AvbSlotVerifyResult load_and_verify_hash_partition(
     avb_debugv(part_name, ": Loading entire partition.\n", NULL);
   }
 
+#ifndef CONFIG_AVB_READ_HASH
   ret = load_full_partition(
       ops, part_name, image_size, &image_buf, &image_preloaded,
       allow_verification_error);
@@ -392,6 +480,18 @@ static AvbSlotVerifyResult load_and_verify_hash_partition(
   } else if (allow_verification_error) {
     goto out;
   }
+#else
+  /* Start hashing before the load so that read_from_partition() can feed
+   * the hash as it reads, whatever it did not hash is done from the loaded
+   * image below.
+   */
+  if (allow_verification_error) {
+    ret = load_full_partition(
+        ops, part_name, image_size, &image_buf, &image_preloaded,
+        allow_verification_error);
+    goto out;
+  }
+#endif
 
   // Although only one of the type might be used, we have to defined the
   // structure here so that they would live outside the 'if/else' scope to be
@@ -399,31 +499,66 @@ static AvbSlotVerifyResult load_and_verify_hash_partition(
   AvbSHA256Ctx sha256_ctx;
   AvbSHA512Ctx sha512_ctx;
   size_t image_size_to_hash = hash_desc.image_size;
+  size_t image_hashed = 0;
   // If we allow verification error and the whole partition is smaller than
   // image size in hash descriptor, we just hash the whole partition.
   if (image_size_to_hash > image_size) {
     image_size_to_hash = image_size;
   }
-  if (avb_strcmp((const char*)hash_desc.hash_algorithm, "sha256") == 0) {
+  bool is_sha256 =
+      avb_strcmp((const char*)hash_desc.hash_algorithm, "sha256") == 0;
+  if (is_sha256) {
     sha256_ctx.tot_len = hash_desc.salt_len + image_size_to_hash;
     avb_sha256_init(&sha256_ctx);
     avb_sha256_update(&sha256_ctx, desc_salt, hash_desc.salt_len);
-    avb_sha256_update(&sha256_ctx, image_buf, image_size_to_hash);
-    digest = avb_sha256_final(&sha256_ctx);
-    digest_len = AVB_SHA256_DIGEST_SIZE;
   } else if (avb_strcmp((const char*)hash_desc.hash_algorithm, "sha512") == 0) {
     sha512_ctx.tot_len = hash_desc.salt_len + image_size_to_hash;
     avb_sha512_init(&sha512_ctx);
     avb_sha512_update(&sha512_ctx, desc_salt, hash_desc.salt_len);
-    avb_sha512_update(&sha512_ctx, image_buf, image_size_to_hash);
-    digest = avb_sha512_final(&sha512_ctx);
-    digest_len = AVB_SHA512_DIGEST_SIZE;
   } else {
     avb_errorv(part_name, ": Unsupported hash algorithm.\n", NULL);
     ret = AVB_SLOT_VERIFY_RESULT_ERROR_INVALID_METADATA;
     goto out;
   }
 
+#ifdef CONFIG_AVB_READ_HASH
+  struct AvbReadHash read_hash = {
+      .partition = part_name,
+      .sha256_ctx = is_sha256 ? &sha256_ctx : NULL,
+      .sha512_ctx = is_sha256 ? NULL : &sha512_ctx,
+      .size = image_size_to_hash,
+  };
+
+  ops->read_hash = &read_hash;
+  ret = load_full_partition(
+      ops, part_name, image_size, &image_buf, &image_preloaded,
+      allow_verification_error);
+  ops->read_hash = NULL;
+  read_hash_wait(&read_hash);
+  if (ret != AVB_SLOT_VERIFY_RESULT_OK) {
+    goto out;
+  }
+  image_hashed = read_hash.offset;
+#endif
+
+  if (is_sha256) {
+    if (image_hashed < image_size_to_hash) {
+      avb_sha256_update(&sha256_ctx,
+                        image_buf + image_hashed,
+                        image_size_to_hash - image_hashed);
+    }
+    digest = avb_sha256_final(&sha256_ctx);
+    digest_len = AVB_SHA256_DIGEST_SIZE;
+  } else {
+    if (image_hashed < image_size_to_hash) {
+      avb_sha512_update(&sha512_ctx,
+                        image_buf + image_hashed,
+                        image_size_to_hash - image_hashed);
+    }
+    digest = avb_sha512_final(&sha512_ctx);
+    digest_len = AVB_SHA512_DIGEST_SIZE;
+  }
+
   if (hash_desc.digest_len == 0) {
     /* Expect a match to a persistent digest. */
     avb_debugv(part_name, ": No digest, using persistent digest.\n", NULL);
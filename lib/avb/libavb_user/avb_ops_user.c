@@ -88,12 +88,12 @@ static AvbIOResult get_size_of_partition(AvbOps *ops,
 	return AVB_IO_RESULT_OK;
 }
 
-static AvbIOResult read_from_partition(AvbOps *ops,
-				       const char *partition,
-				       int64_t offset,
-				       size_t num_bytes,
-				       void *buffer,
-				       size_t *out_num_read)
+static AvbIOResult read_partition(AvbOps *ops,
+				  const char *partition,
+				  int64_t offset,
+				  size_t num_bytes,
+				  void *buffer,
+				  size_t *out_num_read)
 {
 	struct blk_desc *dev_desc;
 	lbaint_t offset_blk, blkcnt;
@@ -144,6 +144,45 @@ static AvbIOResult read_from_partition(AvbOps *ops,
 	return AVB_IO_RESULT_OK;
 }
 
+static AvbIOResult read_from_partition(AvbOps *ops,
+				       const char *partition,
+				       int64_t offset,
+				       size_t num_bytes,
+				       void *buffer,
+				       size_t *out_num_read)
+{
+#ifdef CONFIG_AVB_READ_HASH
+	size_t chunk, num_read, total = 0;
+	AvbIOResult ret;
+
+	if (!ops->read_hash || offset < 0)
+		return read_partition(ops, partition, offset, num_bytes,
+				      buffer, out_num_read);
+
+	/* Hand each chunk to the hash while the next one is read */
+	while (total < num_bytes) {
+		chunk = min_t(size_t, num_bytes - total,
+			      CONFIG_AVB_READ_HASH_CHUNK_SIZE);
+		ret = read_partition(ops, partition, offset + total, chunk,
+				     (u8 *)buffer + total, &num_read);
+		if (ret != AVB_IO_RESULT_OK)
+			return ret;
+
+		avb_read_hash_update(ops, partition, offset + total,
+				     (u8 *)buffer + total, num_read);
+		total += num_read;
+		if (num_read < chunk)
+			break;
+	}
+	*out_num_read = total;
+
+	return AVB_IO_RESULT_OK;
+#else
+	return read_partition(ops, partition, offset, num_bytes,
+			      buffer, out_num_read);
+#endif
+}
+
 static AvbIOResult write_to_partition(AvbOps *ops,
 				      const char *partition,
 				      int64_t offset,
@@ -20,6 +20,9 @@
 #include <watchdog.h>
 #endif
 #include "u-boot/zlib.h"
+#if !defined(USE_HOSTCC) && defined(CONFIG_ARM64_CRC32)
+#include <asm/crc32.h>
+#endif
 
 #define local static
 #define ZEXPORT	/* empty */
@@ -176,7 +179,7 @@ const uint32_t * ZEXPORT get_crc_table()
 /* No ones complement version. JFFS2 (and other things ?)
  * don't use ones compliment in their CRC calculations.
  */
-uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
+uint32_t ZEXPORT crc32_no_comp_base(uint32_t crc, const Bytef *buf, uInt len)
 {
     const uint32_t *tab = crc_table;
     const uint32_t *b =(const uint32_t *)buf;
@@ -218,6 +221,15 @@ uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 }
 #undef DO_CRC
 
+uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
+{
+#if !defined(USE_HOSTCC) && defined(CONFIG_ARM64_CRC32)
+    if (arm64_has_crc32())
+	 return crc32_le_arm64(crc, buf, len);
+#endif
+    return crc32_no_comp_base(crc, buf, len);
+}
+
 uint32_t ZEXPORT crc32 (uint32_t crc, const Bytef *p, uInt len)
 {
      return crc32_no_comp(crc ^ 0xffffffffL, p, len) ^ 0xffffffffL;
@@ -12,9 +12,13 @@
 
 #include <common.h>
 #include <compiler.h>
+#include <u-boot/crc.h>
+#ifdef CONFIG_ARM64_CRC32
+#include <asm/crc32.h>
+#endif
 
-uint32_t crc32c_cal(uint32_t crc, const char *data, int length,
-		    uint32_t *crc32c_table)
+uint32_t crc32c_cal_base(uint32_t crc, const char *data, int length,
+			 uint32_t *crc32c_table)
 {
 	while (length--)
 		crc = crc32c_table[(u8)(crc ^ *data++)] ^ (crc >> 8);
@@ -22,6 +26,21 @@ uint32_t crc32c_cal(uint32_t crc, const char *data, int length,
 	return crc;
 }
 
+uint32_t crc32c_cal(uint32_t crc, const char *data, int length,
+		    uint32_t *crc32c_table)
+{
+#ifdef CONFIG_ARM64_CRC32
+	/*
+	 * The entry for 0x80 is the polynomial itself, only the Castagnoli
+	 * one (CRC32C_POLY_LE) is in hardware.
+	 */
+	if (crc32c_table[0x80] == CRC32C_POLY_LE && length > 0 &&
+	    arm64_has_crc32())
+		return crc32c_le_arm64(crc, (const u8 *)data, length);
+#endif
+	return crc32c_cal_base(crc, data, length, crc32c_table);
+}
+
 void crc32c_init(uint32_t *crc32c_table, uint32_t pol)
 {
 	int i, j;
@@ -317,3 +317,39 @@ int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 
 	return err;
 }
+
+/*
+ * Decompress only the start of gzip data, e.g. to look at the header of
+ * what it holds. Returns the number of bytes decompressed into dst.
+ */
+int gunzip_head(void *dst, int dstlen, unsigned char *src, unsigned long len)
+{
+	int offset = gzip_parse_header(src, len);
+	z_stream s;
+	int r;
+
+	if (offset < 0)
+		return offset;
+
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+
+	r = inflateInit2(&s, -MAX_WBITS);
+	if (r != Z_OK)
+		return -1;
+
+	s.next_in = src + offset;
+	s.avail_in = len - offset;
+	s.next_out = dst;
+	s.avail_out = dstlen;
+	do {
+		r = inflate(&s, Z_SYNC_FLUSH);
+	} while (r == Z_OK && s.avail_out);
+	len = s.next_out - (unsigned char *)dst;
+	inflateEnd(&s);
+
+	if (r != Z_OK && r != Z_STREAM_END && r != Z_BUF_ERROR)
+		return -1;
+
+	return len;
+}
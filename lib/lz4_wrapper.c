@@ -136,3 +136,37 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 	*dstn = out - dst;
 	return ret;
 }
+
+int ulz4fn_head(const void *src, size_t srcn, void *dst, size_t dstn,
+		size_t want)
+{
+	const struct lz4_frame_header *h = src;
+	const void *in = src + sizeof(*h);
+	struct lz4_block_header b;
+	int ret;
+
+	if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8) + sizeof(b))
+		return -EINVAL;
+	if (!lz4_is_valid_header(src))
+		return -EPROTONOSUPPORT;
+	if (h->has_content_size)
+		in += sizeof(u64);
+	in += sizeof(u8);
+
+	b.raw = le32_to_cpu(*(u32 *)in);
+	in += sizeof(struct lz4_block_header);
+	if (in - src + b.size > srcn)
+		return -EINVAL;
+
+	want = min(want, dstn);
+	if (b.not_compressed) {
+		ret = min((size_t)b.size, want);
+		memcpy(dst, in, ret);
+		return ret;
+	}
+
+	ret = LZ4_decompress_generic(in, dst, b.size, dstn, endOnInputSize,
+				     partial, want, noDict, dst, NULL, 0);
+
+	return ret < 0 ? -EPROTO : ret;
+}
@@ -30,8 +30,16 @@
 #else
 #include <string.h>
 #endif /* USE_HOSTCC */
+#include <watchdog.h>
 #include <u-boot/sha512.h>
 
+#include <linux/compiler.h>
+
+#ifdef USE_HOSTCC
+#undef __weak
+#define __weak
+#endif
+
 #if defined(_MSC_VER) || defined(__WATCOMC__)
 #define UL64(x) x##ui64
 #else
@@ -155,7 +163,8 @@ static const uint64_t K[80] = {
 	UL64(0x5FCB6FAB3AD6FAEC),  UL64(0x6C44198C4A475817)
 };
 
-static int sha512_process(sha512_context *ctx, const unsigned char data[128])
+static void sha512_process_one(sha512_context *ctx,
+			       const unsigned char data[128])
 {
 	int i;
 	uint64_t temp1, temp2, W[80];
@@ -226,8 +235,24 @@ static int sha512_process(sha512_context *ctx, const unsigned char data[128])
 	ctx->state[5] += F;
 	ctx->state[6] += G;
 	ctx->state[7] += H;
+}
 
-	return(0);
+void sha512_base_process(sha512_context *ctx, const unsigned char *data,
+			 unsigned int blocks)
+{
+	while (blocks--) {
+		sha512_process_one(ctx, data);
+		data += 128;
+	}
+}
+
+__weak void sha512_process(sha512_context *ctx, const unsigned char *data,
+			   unsigned int blocks)
+{
+	if (!blocks)
+		return;
+
+	sha512_base_process(ctx, data, blocks);
 }
 
 /*
@@ -235,7 +260,6 @@ static int sha512_process(sha512_context *ctx, const unsigned char data[128])
  */
 int sha512_update(sha512_context *ctx, const unsigned char *input, size_t ilen)
 {
-	int ret;
 	size_t fill;
 	unsigned int left;
 
@@ -252,22 +276,16 @@ int sha512_update(sha512_context *ctx, const unsigned char *input, size_t ilen)
 
 	if (left && ilen >= fill) {
 		memcpy((void *)(ctx->buffer + left), input, fill);
-
-		if ((ret = sha512_process(ctx, ctx->buffer)) != 0)
-			return(ret);
+		sha512_process(ctx, ctx->buffer, 1);
 
 		input += fill;
 		ilen  -= fill;
 		left = 0;
 	}
 
-	while (ilen >= 128) {
-		if ((ret = sha512_process(ctx, input)) != 0)
-			return(ret);
-
-		input += 128;
-		ilen  -= 128;
-	}
+	sha512_process(ctx, input, ilen / 128);
+	input += ilen / 128 * 128;
+	ilen %= 128;
 
 	if (ilen > 0)
 		memcpy((void *)(ctx->buffer + left), input, ilen);
@@ -280,7 +298,6 @@ int sha512_update(sha512_context *ctx, const unsigned char *input, size_t ilen)
  */
 int sha512_finish(sha512_context *ctx, unsigned char output[64])
 {
-	int ret;
 	unsigned used;
 	uint64_t high, low;
 
@@ -297,9 +314,7 @@ int sha512_finish(sha512_context *ctx, unsigned char output[64])
 	} else {
 		/* We'll need an extra block */
 		memset(ctx->buffer + used, 0, 128 - used);
-
-		if ((ret = sha512_process(ctx, ctx->buffer)) != 0)
-			return(ret);
+		sha512_process(ctx, ctx->buffer, 1);
 
 		memset(ctx->buffer, 0, 112);
 	}
@@ -313,9 +328,7 @@ int sha512_finish(sha512_context *ctx, unsigned char output[64])
 
 	PUT_UINT64_BE(high, ctx->buffer, 112);
 	PUT_UINT64_BE(low,  ctx->buffer, 120);
-
-	if ((ret = sha512_process(ctx, ctx->buffer)) != 0)
-		return(ret);
+	sha512_process(ctx, ctx->buffer, 1);
 
 	/*
 	 * Output final state
@@ -344,3 +357,37 @@ void sha512_csum(const unsigned char *input, unsigned int ilen,
 	sha512_update(&ctx, input, ilen);
 	sha512_finish(&ctx, output);
 }
+
+/*
+ * Output = SHA-512( input buffer ). Trigger the watchdog every 'chunk_sz'
+ * bytes of input processed.
+ */
+void sha512_csum_wd(const unsigned char *input, unsigned int ilen,
+		    unsigned char *output, unsigned int chunk_sz)
+{
+	sha512_context ctx;
+#if defined(CONFIG_HW_WATCHDOG) || defined(CONFIG_WATCHDOG)
+	const unsigned char *end;
+	unsigned char *curr;
+	int chunk;
+#endif
+
+	sha512_starts(&ctx);
+
+#if defined(CONFIG_HW_WATCHDOG) || defined(CONFIG_WATCHDOG)
+	curr = (unsigned char *)input;
+	end = input + ilen;
+	while (curr < end) {
+		chunk = end - curr;
+		if (chunk > chunk_sz)
+			chunk = chunk_sz;
+		sha512_update(&ctx, curr, chunk);
+		curr += chunk;
+		WATCHDOG_RESET();
+	}
+#else
+	sha512_update(&ctx, input, ilen);
+#endif
+
+	sha512_finish(&ctx, output);
+}
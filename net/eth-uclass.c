@@ -397,7 +397,10 @@ int eth_initialize(void)
 	 * This is accomplished by attempting to probe each device and calling
 	 * their write_hwaddr() operation.
 	 */
-	uclass_first_device(UCLASS_ETH, &dev);
+	/* Devices that allow it are probed only once they are used */
+	uclass_find_first_device(UCLASS_ETH, &dev);
+	if (dev && device_probe_defer(dev))
+		dev = NULL;
 	if (!dev) {
 		printf("No ethernet found.\n");
 		bootstage_error(BOOTSTAGE_ID_NET_ETH_START);
@@ -419,14 +422,20 @@ int eth_initialize(void)
 			if (num_devices)
 				printf(", ");
 
-			printf("eth%d: %s", dev->seq, dev->name);
+			if (device_active(dev))
+				printf("eth%d: %s", dev->seq, dev->name);
+			else
+				printf("%s [DEFERRED]", dev->name);
 
 			if (ethprime && dev == prime_dev)
 				printf(" [PRIME]");
 
-			eth_write_hwaddr(dev);
+			if (device_active(dev))
+				eth_write_hwaddr(dev);
 
-			uclass_next_device(&dev);
+			uclass_find_next_device(&dev);
+			if (dev && device_probe_defer(dev))
+				dev = NULL;
 			num_devices++;
 		} while (dev);
 
@@ -531,6 +540,10 @@ static int eth_post_probe(struct udevice *dev)
 #endif
 	}
 
+	/* Skipped by eth_initialize(), Linux needs it all the same */
+	if (dev->flags & DM_FLAG_DEFERRED)
+		eth_write_hwaddr(dev);
+
 	return 0;
 }
 
@@ -127,6 +127,12 @@ static char tftp_filename[MAX_LEN];
  */
 #ifdef CONFIG_TFTP_BLOCKSIZE
 #define TFTP_MTU_BLOCKSIZE CONFIG_TFTP_BLOCKSIZE
+#elif defined(CONFIG_IP_DEFRAG)
+/* Largest block whose datagram can still be reassembled */
+#ifndef CONFIG_NET_MAXDEFRAG
+#define CONFIG_NET_MAXDEFRAG 16384
+#endif
+#define TFTP_MTU_BLOCKSIZE (CONFIG_NET_MAXDEFRAG - IP_UDP_HDR_SIZE - 4)
 #else
 #define TFTP_MTU_BLOCKSIZE 1468
 #endif
@@ -134,6 +140,30 @@ static char tftp_filename[MAX_LEN];
 static unsigned short tftp_block_size = TFTP_BLOCK_SIZE;
 static unsigned short tftp_block_size_option = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440: the server sends up to tftp_windowsize blocks before it waits
+ * for an ACK. Blocks after a lost one are stored right away and noted in
+ * tftp_window_map, the server resends from the last ACK and the gap is
+ * then filled in.
+ */
+#define TFTP_WINDOWSIZE_MAX	64
+
+static unsigned short tftp_windowsize = 1;
+static unsigned short tftp_windowsize_option = CONFIG_TFTP_WINDOWSIZE;
+/* last block acknowledged, the current window follows it */
+static ulong	tftp_last_ack;
+/* bit n: block tftp_prev_block + 2 + n is already stored */
+static u64	tftp_window_map;
+/* the final (short) block, once received */
+static ulong	tftp_final_block;
+static int	tftp_final_received;
+
+static struct {
+	ulong	retransmits;	/* blocks received again */
+	ulong	out_of_order;	/* blocks stored ahead of a lost one */
+	ulong	timeouts;
+} tftp_stats;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -211,6 +241,9 @@ static void new_transfer(void)
 	tftp_prev_block = 0;
 	tftp_block_wrap = 0;
 	tftp_block_wrap_offset = 0;
+	tftp_last_ack = 0;
+	tftp_window_map = 0;
+	tftp_final_received = 0;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_final_block_sent = 0;
 #endif
@@ -321,6 +354,9 @@ static void tftp_complete(void)
 		print_size(net_boot_file_size /
 			time_start * 1000, "/s");
 	}
+	printf("\n\t blksize %d, windowsize %d: %lu retransmitted, %lu out of order, %lu timeouts",
+	       tftp_block_size, tftp_windowsize, tftp_stats.retransmits,
+	       tftp_stats.out_of_order, tftp_stats.timeouts);
 	puts("\ndone\n");
 	net_set_state(NETLOOP_SUCCESS);
 }
@@ -372,6 +408,9 @@ static void tftp_send(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, tftp_block_size_option, 0);
+		if (tftp_state == STATE_SEND_RRQ && tftp_windowsize_option > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, tftp_windowsize_option, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!tftp_mcast_disabled) {
@@ -457,6 +496,74 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/* Acknowledge everything up to the first missing block */
+static void tftp_window_ack(void)
+{
+	tftp_cur_block = tftp_prev_block;
+	tftp_last_ack = tftp_prev_block;
+	tftp_send();
+}
+
+/* A data block of a download with a window of more than one block */
+static void tftp_window_data(unsigned src, uchar *pkt, unsigned len)
+{
+	ushort block = ntohs(*(__be16 *)pkt);
+	ushort ahead;
+	int more;
+
+	if (tftp_state != STATE_DATA) {
+		/* first block received, not necessarily block 1 */
+		tftp_state = STATE_DATA;
+		tftp_remote_port = src;
+		new_transfer();
+	}
+
+	ahead = block - (ushort)(tftp_prev_block + 1);
+	if (ahead >= tftp_windowsize ||
+	    (ahead && (tftp_window_map & (1ULL << (ahead - 1))))) {
+		/* Already stored, the server went back to our last ACK */
+		tftp_stats.retransmits++;
+		return;
+	}
+
+	timeout_count_max = tftp_timeout_count_max;
+	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
+
+	/* Block n goes to offset n - 1, the next one is tftp_prev_block */
+	store_block(tftp_prev_block + ahead, pkt + 2, len);
+	if (len < tftp_block_size) {
+		tftp_final_block = block;
+		tftp_final_received = 1;
+	}
+
+	if (ahead) {
+		tftp_window_map |= 1ULL << (ahead - 1);
+		tftp_stats.out_of_order++;
+		/* The server waits for an ACK after this one */
+		if (len < tftp_block_size ||
+		    block == (ushort)(tftp_last_ack + tftp_windowsize))
+			tftp_window_ack();
+		return;
+	}
+
+	/* Move past this block and the ones stored after it */
+	do {
+		tftp_cur_block = (ushort)(tftp_prev_block + 1);
+		update_block_number();
+		tftp_prev_block = tftp_cur_block;
+		more = tftp_window_map & 1;
+		tftp_window_map >>= 1;
+	} while (more);
+
+	if (tftp_final_received && tftp_prev_block == tftp_final_block) {
+		tftp_window_ack();
+		tftp_complete();
+	} else if ((ushort)(tftp_prev_block - tftp_last_ack) >=
+		   tftp_windowsize) {
+		tftp_window_ack();
+	}
+}
+
 static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 unsigned src, unsigned len)
 {
@@ -540,6 +647,16 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				debug("Blocksize ack: %s, %d\n",
 				      (char *)pkt + i + 8, tftp_block_size);
 			}
+			if (strcmp((char *)pkt + i, "windowsize") == 0) {
+				tftp_windowsize = simple_strtoul((char *)pkt +
+								 i + 11,
+								 NULL, 10);
+				tftp_windowsize = clamp(tftp_windowsize,
+							(ushort)1,
+							tftp_windowsize_option);
+				debug("Windowsize ack: %s, %d\n",
+				      (char *)pkt + i + 11, tftp_windowsize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				tftp_tsize = simple_strtoul((char *)pkt + i + 6,
@@ -551,6 +668,8 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		}
 #ifdef CONFIG_MCAST_TFTP
 		parse_multicast_oack((char *)pkt, len - 1);
+		if (tftp_mcast_active)
+			tftp_windowsize = 1;
 		if ((tftp_mcast_active) && (!tftp_mcast_master_client))
 			tftp_state = STATE_DATA;	/* passive.. */
 		else
@@ -568,6 +687,13 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		if (len < 2)
 			return;
 		len -= 2;
+
+		/* Only negotiated for downloads */
+		if (tftp_windowsize > 1) {
+			tftp_window_data(src, pkt, len);
+			break;
+		}
+
 		tftp_cur_block = ntohs(*(__be16 *)pkt);
 
 		update_block_number();
@@ -599,6 +725,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 		if (tftp_cur_block == tftp_prev_block) {
 			/* Same block again; ignore it. */
+			tftp_stats.retransmits++;
 			break;
 		}
 
@@ -689,8 +816,11 @@ static void tftp_timeout_handler(void)
 		restart("Retry count exceeded");
 	} else {
 		puts("T ");
+		tftp_stats.timeouts++;
 		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
-		if (tftp_state != STATE_RECV_WRQ)
+		if (tftp_windowsize > 1 && tftp_state == STATE_DATA)
+			tftp_window_ack();
+		else if (tftp_state != STATE_RECV_WRQ)
 			tftp_send();
 	}
 }
@@ -710,6 +840,11 @@ void tftp_start(enum proto_t protocol)
 	if (ep != NULL)
 		tftp_block_size_option = simple_strtol(ep, NULL, 10);
 
+	ep = env_get("tftpwindowsize");
+	if (ep != NULL)
+		tftp_windowsize_option = clamp(simple_strtol(ep, NULL, 10),
+					       1L, (long)TFTP_WINDOWSIZE_MAX);
+
 	ep = env_get("tftptimeout");
 	if (ep != NULL)
 		timeout_ms = simple_strtol(ep, NULL, 10);
@@ -731,8 +866,8 @@ void tftp_start(enum proto_t protocol)
 	}
 #endif
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-	      tftp_block_size_option, timeout_ms);
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+	      tftp_block_size_option, tftp_windowsize_option, timeout_ms);
 
 	tftp_remote_ip = net_server_ip;
 	if (net_boot_file_name[0] == '\0') {
@@ -837,6 +972,8 @@ void tftp_start(enum proto_t protocol)
 	memset(net_server_ethaddr, 0, 6);
 	/* Revert tftp_block_size to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
+	memset(&tftp_stats, 0, sizeof(tftp_stats));
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -866,6 +1003,8 @@ void tftp_start_server(void)
 
 	/* Revert tftp_block_size to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
+	memset(&tftp_stats, 0, sizeof(tftp_stats));
 	tftp_cur_block = 0;
 	tftp_our_port = WELL_KNOWN_PORT;
 
@@ -25,6 +25,9 @@ static cmd_tbl_t cmd_ut_sub[] = {
 #ifdef CONFIG_UT_TIME
 	U_BOOT_CMD_MKENT(time, CONFIG_SYS_MAXARGS, 1, do_ut_time, "", ""),
 #endif
+#ifdef CONFIG_UT_CRC32
+	U_BOOT_CMD_MKENT(crc32, CONFIG_SYS_MAXARGS, 1, do_ut_crc32, "", ""),
+#endif
 };
 
 static int do_ut_all(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
@@ -76,6 +79,9 @@ static char ut_help_text[] =
 #endif
 #ifdef CONFIG_UT_TIME
 	"ut time - Very basic test of time functions\n"
+#endif
+#ifdef CONFIG_UT_CRC32
+	"ut crc32 - Check crc32/crc32c results and throughput\n"
 #endif
 	;
 #endif
@@ -0,0 +1,154 @@
+/*
+ * (C) Copyright 2025 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <errno.h>
+#include <malloc.h>
+#include <u-boot/crc.h>
+
+#define CRC32_UT_MAX_LEN	300
+#define CRC32_UT_SPEED_LEN	(4 << 20)
+
+static const char crc32_ut_check[] = "123456789";
+
+/* Bit by bit, the reference for both the tables and the instructions */
+static uint32_t crc32_ut_bitwise(uint32_t crc, const u8 *p, int len,
+				 uint32_t poly)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *p++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ ((crc & 1) ? poly : 0);
+	}
+
+	return crc;
+}
+
+static int test_crc32_check(uint32_t *crc32c_table)
+{
+	uint32_t crc;
+
+	crc = crc32(0, (const u8 *)crc32_ut_check, 9);
+	if (crc != 0xcbf43926) {
+		printf("%s: crc32 is 0x%08x, expected 0xcbf43926\n",
+		       __func__, crc);
+		return -EINVAL;
+	}
+
+	crc = ~crc32c_cal(~0, crc32_ut_check, 9, crc32c_table);
+	if (crc != 0xe3069283) {
+		printf("%s: crc32c is 0x%08x, expected 0xe3069283\n",
+		       __func__, crc);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Every length up to CRC32_UT_MAX_LEN at every offset in a 64-bit word */
+static int test_crc32_lengths(u8 *buf, uint32_t *crc32c_table)
+{
+	uint32_t crc, ref;
+	int off, len;
+
+	for (off = 0; off < 8; off++) {
+		for (len = 0; len <= CRC32_UT_MAX_LEN; len++) {
+			ref = crc32_ut_bitwise(len, buf + off, len,
+					       0xedb88320);
+			crc = crc32_no_comp(len, buf + off, len);
+			if (crc != ref) {
+				printf("%s: crc32 off %d len %d: 0x%08x, expected 0x%08x\n",
+				       __func__, off, len, crc, ref);
+				return -EINVAL;
+			}
+
+			ref = crc32_ut_bitwise(len, buf + off, len,
+					       CRC32C_POLY_LE);
+			crc = crc32c_cal(len, (const char *)buf + off, len,
+					 crc32c_table);
+			if (crc != ref) {
+				printf("%s: crc32c off %d len %d: 0x%08x, expected 0x%08x\n",
+				       __func__, off, len, crc, ref);
+				return -EINVAL;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static ulong test_crc32_mbps(ulong len, ulong us)
+{
+	return us ? len / us : 0;
+}
+
+static int test_crc32_speed(u8 *buf, uint32_t *crc32c_table)
+{
+	uint32_t crc, ref;
+	ulong start, us, base_us;
+
+	start = timer_get_us();
+	ref = crc32_no_comp_base(0, buf, CRC32_UT_SPEED_LEN);
+	base_us = timer_get_us() - start;
+	start = timer_get_us();
+	crc = crc32_no_comp(0, buf, CRC32_UT_SPEED_LEN);
+	us = timer_get_us() - start;
+	printf("%s: crc32  %lu MB/s, table %lu MB/s\n", __func__,
+	       test_crc32_mbps(CRC32_UT_SPEED_LEN, us),
+	       test_crc32_mbps(CRC32_UT_SPEED_LEN, base_us));
+	if (crc != ref) {
+		printf("%s: crc32 mismatch\n", __func__);
+		return -EINVAL;
+	}
+
+	start = timer_get_us();
+	ref = crc32c_cal_base(0, (const char *)buf, CRC32_UT_SPEED_LEN,
+			      crc32c_table);
+	base_us = timer_get_us() - start;
+	start = timer_get_us();
+	crc = crc32c_cal(0, (const char *)buf, CRC32_UT_SPEED_LEN,
+			 crc32c_table);
+	us = timer_get_us() - start;
+	printf("%s: crc32c %lu MB/s, table %lu MB/s\n", __func__,
+	       test_crc32_mbps(CRC32_UT_SPEED_LEN, us),
+	       test_crc32_mbps(CRC32_UT_SPEED_LEN, base_us));
+	if (crc != ref) {
+		printf("%s: crc32c mismatch\n", __func__);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int do_ut_crc32(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	uint32_t crc32c_table[256];
+	int i, ret = 0;
+	u8 *buf;
+
+	buf = malloc(CRC32_UT_SPEED_LEN);
+	if (!buf) {
+		printf("%s: failed to alloc %d bytes\n", __func__,
+		       CRC32_UT_SPEED_LEN);
+		return CMD_RET_FAILURE;
+	}
+
+	for (i = 0; i < CRC32_UT_SPEED_LEN; i++)
+		buf[i] = i * 131 + (i >> 9);
+	crc32c_init(crc32c_table, CRC32C_POLY_LE);
+
+	ret |= test_crc32_check(crc32c_table);
+	ret |= test_crc32_lengths(buf, crc32c_table);
+	ret |= test_crc32_speed(buf, crc32c_table);
+
+	free(buf);
+	printf("Test %s\n", ret ? "failed" : "passed");
+
+	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
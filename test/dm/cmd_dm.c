@@ -42,6 +42,22 @@ static int do_dm_dump_devres(cmd_tbl_t *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_dm_dump_lookup_stats(cmd_tbl_t *cmdtp, int flag, int argc,
+				   char * const argv[])
+{
+	dm_dump_lookup_stats();
+
+	return 0;
+}
+
+static int do_dm_dump_deferred(cmd_tbl_t *cmdtp, int flag, int argc,
+			       char * const argv[])
+{
+	dm_dump_deferred();
+
+	return 0;
+}
+
 static int do_dm_dump_aliases(cmd_tbl_t *cmdtp, int flag, int argc,
 			      char * const argv[])
 {
@@ -56,6 +72,8 @@ static cmd_tbl_t test_commands[] = {
 	U_BOOT_CMD_MKENT(uclass, 1, 1, do_dm_dump_uclass, "", ""),
 	U_BOOT_CMD_MKENT(devres, 1, 1, do_dm_dump_devres, "", ""),
 	U_BOOT_CMD_MKENT(aliases, 0, 1, do_dm_dump_aliases, "", ""),
+	U_BOOT_CMD_MKENT(stats, 0, 1, do_dm_dump_lookup_stats, "", ""),
+	U_BOOT_CMD_MKENT(deferred, 0, 1, do_dm_dump_deferred, "", ""),
 };
 
 static __maybe_unused void dm_reloc(void)
@@ -97,5 +115,7 @@ U_BOOT_CMD(
 	"tree         Dump driver model tree ('*' = activated)\n"
 	"dm uclass        Dump list of instances for each uclass\n"
 	"dm devres        Dump list of device resources for each device\n"
-	"dm aliases       Dump list of aliases"
+	"dm aliases       Dump list of aliases\n"
+	"dm stats         Dump device lookup statistics\n"
+	"dm deferred      Dump devices whose probe was deferred"
 );
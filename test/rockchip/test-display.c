@@ -5,10 +5,96 @@
  */
 
 #include <common.h>
+#include <malloc.h>
+#include <memalign.h>
 #include <video_rockchip.h>
 #include "test-rockchip.h"
 
 #ifdef CONFIG_DRM_ROCKCHIP
+/* One memcpy() per pixel, as the logo used to be rotated */
+static void rotate_ref(u8 *dst, const u8 *src, int width, int height,
+		       int dst_stride, int bytes, int rotate)
+{
+	int i, j;
+	u8 *d;
+
+	for (i = 0; i < height; i++) {
+		for (j = 0; j < width; j++) {
+			if (rotate == 90)
+				d = dst + j * dst_stride +
+				    (height - i - 1) * bytes;
+			else if (rotate == 270)
+				d = dst + (width - j - 1) * dst_stride +
+				    i * bytes;
+			else
+				d = dst + (height - i - 1) * dst_stride +
+				    (width - j - 1) * bytes;
+			memcpy(d, src + (i * width + j) * bytes, bytes);
+		}
+	}
+}
+
+static int do_test_logo_rotate(cmd_tbl_t *cmdtp, int flag,
+			       int argc, char *const argv[])
+{
+	static const int angles[] = { 90, 180, 270 };
+	static const int depths[] = { 16, 24, 32 };
+	/* Small enough for 'rktest all', a panel size is given to time it */
+	int width = argc < 3 ? 100 : simple_strtoul(argv[1], NULL, 0);
+	int height = argc < 3 ? 60 : simple_strtoul(argv[2], NULL, 0);
+	ulong size = width * height * 4, ref_us, us;
+	int a, b, i, stride, ret = -ENOMEM;
+	u8 *src, *dst, *ref;
+
+	src = memalign(ARCH_DMA_MINALIGN, size);
+	dst = memalign(ARCH_DMA_MINALIGN, size);
+	ref = memalign(ARCH_DMA_MINALIGN, size);
+	if (!src || !dst || !ref) {
+		ut_err("logo_rotate: failed to alloc %lu bytes\n", size);
+		goto out;
+	}
+
+	for (i = 0; i < size; i++)
+		src[i] = i * 7 + (i >> 12);
+
+	printf("Logo rotation, %dx%d, reference is a memcpy() per pixel:\n",
+	       width, height);
+	for (b = 0; b < ARRAY_SIZE(depths); b++) {
+		for (a = 0; a < ARRAY_SIZE(angles); a++) {
+			stride = (angles[a] == 180 ? width : height) *
+				 (depths[b] >> 3);
+
+			ref_us = timer_get_us();
+			rotate_ref(ref, src, width, height, stride,
+				   depths[b] >> 3, angles[a]);
+			ref_us = timer_get_us() - ref_us;
+
+			us = timer_get_us();
+			ret = rockchip_rotate_image(dst, src, width, height,
+						    stride, depths[b],
+						    angles[a]);
+			us = timer_get_us() - us;
+
+			printf("    %2dbpp %3d: %6lu us, reference %6lu us\n",
+			       depths[b], angles[a], us, ref_us);
+			if (ret || memcmp(dst, ref, stride *
+					  (angles[a] == 180 ? height : width))) {
+				ut_err("logo_rotate: %dbpp %d data mismatch\n",
+				       depths[b], angles[a]);
+				ret = -EINVAL;
+				goto out;
+			}
+		}
+	}
+
+out:
+	free(src);
+	free(dst);
+	free(ref);
+
+	return ret;
+}
+
 int do_test_display(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
 	int ret = 0;
@@ -27,10 +113,12 @@ int do_test_display(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 
 static cmd_tbl_t sub_cmd[] = {
 	UNIT_CMD_DEFINE(display, 0),
+	UNIT_CMD_DEFINE(logo_rotate, 0),
 };
 
 static const char sub_cmd_help[] =
 "    [.] rktest display                     - test display\n"
+"    [.] rktest logo_rotate [width height]  - test logo rotation, timed if sized\n"
 ;
 
 const struct cmd_group cmd_grp_display = {
@@ -9,6 +9,8 @@
 #include <console.h>
 #include <dm.h>
 #include <key.h>
+#include <malloc.h>
+#include <memalign.h>
 #include <misc.h>
 #include <rc.h>
 #ifdef CONFIG_IRQ
@@ -17,6 +19,7 @@
 #endif
 #include <asm/io.h>
 #include <linux/input.h>
+#include <linux/sizes.h>
 #include "test-rockchip.h"
 
 #ifdef CONFIG_IRQ
@@ -211,6 +214,141 @@ static int do_test_adc(cmd_tbl_t *cmdtp, int flag,
 }
 #endif
 
+/* Byte loops as in lib/string.c, the baseline for the arch versions */
+static void *string_c_memcpy(void *dest, const void *src, size_t count)
+{
+	char *tmp = (char *)dest, *s = (char *)src;
+
+	while (count--)
+		*tmp++ = *s++;
+
+	return dest;
+}
+
+static void *string_c_memmove(void *dest, const void *src, size_t count)
+{
+	char *tmp, *s;
+
+	if (dest <= src) {
+		tmp = (char *)dest;
+		s = (char *)src;
+		while (count--)
+			*tmp++ = *s++;
+	} else {
+		tmp = (char *)dest + count;
+		s = (char *)src + count;
+		while (count--)
+			*--tmp = *--s;
+	}
+
+	return dest;
+}
+
+static void *string_c_memset(void *s, int c, size_t count)
+{
+	char *xs = (char *)s;
+
+	while (count--)
+		*xs++ = c;
+
+	return s;
+}
+
+static ulong string_mbps(ulong size, u64 ticks)
+{
+	u64 us = ticks / (gd->arch.timer_rate_hz / 1000000);
+
+	return us ? (ulong)(size / us) : 0;
+}
+
+static int string_test_one(const char *name, u8 *dst, u8 *src, u8 *ref,
+			   ulong size)
+{
+	ulong c_mbps, arch_mbps;
+	u64 start;
+	int i;
+
+	for (i = 0; i < size; i++)
+		src[i] = i * 7 + (i >> 12);
+
+	if (!strcmp(name, "memset")) {
+		start = get_ticks();
+		string_c_memset(ref, 0x5a, size);
+		c_mbps = string_mbps(size, get_ticks() - start);
+		start = get_ticks();
+		memset(dst, 0x5a, size);
+		arch_mbps = string_mbps(size, get_ticks() - start);
+	} else if (!strcmp(name, "memmove")) {
+		/* Overlapping, 4KB forward */
+		string_c_memcpy(ref, src, size);
+		start = get_ticks();
+		string_c_memmove(ref + SZ_4K, ref, size - SZ_4K);
+		c_mbps = string_mbps(size - SZ_4K, get_ticks() - start);
+		string_c_memcpy(dst, src, size);
+		start = get_ticks();
+		memmove(dst + SZ_4K, dst, size - SZ_4K);
+		arch_mbps = string_mbps(size - SZ_4K, get_ticks() - start);
+	} else {
+		start = get_ticks();
+		string_c_memcpy(ref, src, size);
+		c_mbps = string_mbps(size, get_ticks() - start);
+		start = get_ticks();
+		memcpy(dst, src, size);
+		arch_mbps = string_mbps(size, get_ticks() - start);
+	}
+
+	printf("    %-8s %s: %5lu MB/s, lib/string.c %5lu MB/s\n", name,
+	       ((ulong)dst & 7) ? "unaligned" : "aligned  ", arch_mbps, c_mbps);
+
+	if (memcmp(dst, ref, size)) {
+		ut_err("%s: data mismatch\n", name);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int do_test_string(cmd_tbl_t *cmdtp, int flag,
+			  int argc, char *const argv[])
+{
+	static const char * const names[] = { "memcpy", "memmove", "memset" };
+	ulong size = argc < 2 ? SZ_8M : simple_strtoul(argv[1], NULL, 0);
+	u8 *dst, *src, *ref;
+	int i, ret = -ENOMEM;
+
+	if (size < SZ_8K) {
+		ut_err("string: size must be at least 8KB\n");
+		return -EINVAL;
+	}
+
+	/* One spare cache line for the unaligned run */
+	dst = memalign(ARCH_DMA_MINALIGN, size + ARCH_DMA_MINALIGN);
+	src = memalign(ARCH_DMA_MINALIGN, size + ARCH_DMA_MINALIGN);
+	ref = memalign(ARCH_DMA_MINALIGN, size + ARCH_DMA_MINALIGN);
+	if (!dst || !src || !ref) {
+		ut_err("string: failed to alloc %lu bytes\n", size);
+		goto out;
+	}
+
+	printf("String functions, %lu bytes:\n", size);
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		ret = string_test_one(names[i], dst, src, ref, size);
+		if (ret)
+			goto out;
+		ret = string_test_one(names[i], dst + 3, src + 1, ref + 3,
+				      size);
+		if (ret)
+			goto out;
+	}
+
+out:
+	free(dst);
+	free(src);
+	free(ref);
+
+	return ret;
+}
+
 static cmd_tbl_t sub_cmd[] = {
 #ifdef CONFIG_DM_CRYPTO
 	UNIT_CMD_DEFINE(crypto, 0),
@@ -227,6 +365,7 @@ static cmd_tbl_t sub_cmd[] = {
 #ifdef CONFIG_IRQ
 	UNIT_CMD_DEFINE(timer, 0),
 #endif
+	UNIT_CMD_DEFINE(string, 0),
 };
 
 static const char sub_cmd_help[] =
@@ -245,6 +384,7 @@ static const char sub_cmd_help[] =
 #ifdef CONFIG_IRQ
 "    [.] rktest timer                       - test timer and interrupt\n"
 #endif
+"    [.] rktest string [size]               - test memcpy/memmove/memset speed\n"
 ;
 
 const struct cmd_group cmd_grp_misc = {